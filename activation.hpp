@@ -0,0 +1,156 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+#include "batch.hpp"
+#include "exp.hpp"
+#include "instrument.hpp"
+#include "simd.hpp"
+
+// Activation functions for small neural nets, built on the exp kernels the
+// same way tanh.hpp builds tanh:
+//   sigmoid(x) = 1 / (1 + e^-x)
+//   silu(x)    = x sigmoid(x)
+//   gelu(x)    = x sigmoid(2 sqrt(2/pi) (x + 0.044715 x^3)), the tanh form,
+//                as 0.5 (1 + tanh(y)) = sigmoid(2y)
+// and softmax over whole arrays. The table kernels take simd::f32 too.
+
+namespace fast {
+namespace sigmoid {
+
+template<typename T>
+constexpr T stl(T x) noexcept { FASTMATHS_PROBE(x); return 1 / (1 + std::exp(-x)); }
+
+// The bit trick exps overflow their int past |x| ~ 88. Out there the sigmoid
+// is 0 or 1 to float precision anyway
+constexpr float __clamp(float x) noexcept { return simd::min(simd::max(x, -80.0f), 80.0f); }
+
+constexpr float exp_ekmett_ub (float x) noexcept { FASTMATHS_PROBE(x); return 1 / (1 + exp::ekmett_ub(-__clamp(x))); }
+constexpr float exp_ekmett_lb (float x) noexcept { FASTMATHS_PROBE(x); return 1 / (1 + exp::ekmett_lb(-__clamp(x))); }
+constexpr float exp_schraudolph (float x) noexcept { FASTMATHS_PROBE(x); return 1 / (1 + exp::schraudolph(-__clamp(x))); }
+constexpr float exp_mineiro (float x) noexcept { FASTMATHS_PROBE(x); return 1 / (1 + exp::mineiro(-__clamp(x))); }
+constexpr float exp_mineiro_faster (float x) noexcept { FASTMATHS_PROBE(x); return 1 / (1 + exp::mineiro_faster(-__clamp(x))); }
+
+// exp::table saturates by itself, so needs no clamp
+template <int TableBits = 5, int Degree = 3, typename T = float>
+constexpr T table(T x) noexcept {
+    FASTMATHS_PROBE(x);
+    return T(1.0f) / (T(1.0f) + exp::table<TableBits, Degree>(-x));
+}
+
+} // namespace sigmoid
+
+// also known as swish
+namespace silu {
+
+template<typename T>
+constexpr T stl(T x) noexcept { FASTMATHS_PROBE(x); return x / (1 + std::exp(-x)); }
+
+constexpr float exp_ekmett_ub (float x) noexcept { FASTMATHS_PROBE(x); return x * sigmoid::exp_ekmett_ub(x); }
+constexpr float exp_ekmett_lb (float x) noexcept { FASTMATHS_PROBE(x); return x * sigmoid::exp_ekmett_lb(x); }
+constexpr float exp_schraudolph (float x) noexcept { FASTMATHS_PROBE(x); return x * sigmoid::exp_schraudolph(x); }
+constexpr float exp_mineiro (float x) noexcept { FASTMATHS_PROBE(x); return x * sigmoid::exp_mineiro(x); }
+constexpr float exp_mineiro_faster (float x) noexcept { FASTMATHS_PROBE(x); return x * sigmoid::exp_mineiro_faster(x); }
+
+template <int TableBits = 5, int Degree = 3, typename T = float>
+constexpr T table(T x) noexcept {
+    FASTMATHS_PROBE(x);
+    return x * sigmoid::table<TableBits, Degree>(x);
+}
+
+} // namespace silu
+
+// https://arxiv.org/abs/1606.08415
+namespace gelu {
+
+template<typename T>
+constexpr T stl(T x) noexcept { FASTMATHS_PROBE(x); return 0.5f * x * (1 + std::tanh(0.797884561f * (x + 0.044715f * x * x * x))); }
+
+// 2 sqrt(2/pi) (x + 0.044715 x^3)
+template <typename T>
+constexpr T __arg(T x) noexcept {
+    return x * (T(1.59576912f) + T(0.0713548163f) * x * x);
+}
+
+constexpr float exp_ekmett_ub (float x) noexcept { FASTMATHS_PROBE(x); return x * sigmoid::exp_ekmett_ub(__arg(x)); }
+constexpr float exp_ekmett_lb (float x) noexcept { FASTMATHS_PROBE(x); return x * sigmoid::exp_ekmett_lb(__arg(x)); }
+constexpr float exp_schraudolph (float x) noexcept { FASTMATHS_PROBE(x); return x * sigmoid::exp_schraudolph(__arg(x)); }
+constexpr float exp_mineiro (float x) noexcept { FASTMATHS_PROBE(x); return x * sigmoid::exp_mineiro(__arg(x)); }
+constexpr float exp_mineiro_faster (float x) noexcept { FASTMATHS_PROBE(x); return x * sigmoid::exp_mineiro_faster(__arg(x)); }
+
+template <int TableBits = 5, int Degree = 3, typename T = float>
+constexpr T table(T x) noexcept {
+    FASTMATHS_PROBE(x);
+    return x * sigmoid::table<TableBits, Degree>(__arg(x));
+}
+
+} // namespace gelu
+
+namespace softmax {
+
+inline constexpr auto __exp_table = [](auto x) { return exp::table(x); };
+
+// out[i] = e^(in[i] - max) / sum(e^(in[j] - max)). in and out may be the same
+// buffer. Subtracting the max keeps every exp in (0, 1], so nothing overflows
+// however large the logits. Arguments are also kept above -87, past which
+// e^x is below FLT_MIN and the bit trick exps wrap around.
+// Exp is any exp approximation. Kernels that take simd::f32, like the default
+// exp::table, run a vector at a time, others an element at a time and are
+// left to the auto-vectoriser.
+template <auto Exp = __exp_table>
+inline void apply(const float* in, float* out, std::size_t n) noexcept {
+    if (n == 0)
+        return;
+    constexpr std::size_t W = simd::f32::size;
+
+    std::size_t i = 0;
+    float max = in[0];
+    if (n >= W) {
+        simd::f32 m = simd::f32::load(in);
+        for (i = W; i + W <= n; i += W)
+            m = simd::max(m, simd::f32::load(in + i));
+        max = simd::reduce_max(m);
+    }
+    for (; i < n; i++)
+        max = std::max(max, in[i]);
+
+    auto e = [=](auto x) {
+        using T = decltype(x);
+        return Exp(simd::max(x - T(max), T(-87.0f)));
+    };
+    if constexpr (std::is_invocable_r_v<simd::f32, decltype(Exp), simd::f32>)
+        batch::transform(in, out, n, e);
+    else
+        for (i = 0; i < n; i++)
+            out[i] = e(in[i]);
+
+    // summed as W partial sums, which the scalar loop can't be without
+    // -ffast-math
+    simd::f32 s(0.0f);
+    for (i = 0; i + W <= n; i += W)
+        s = s + simd::f32::load(out + i);
+    float sum = simd::reduce_add(s);
+    for (; i < n; i++)
+        sum += out[i];
+
+    const float scale = 1.0f / sum;
+    batch::transform(out, out, n, [=](auto x) { return x * decltype(x)(scale); });
+}
+
+// two passes of std::exp, for comparison
+inline void stl(const float* in, float* out, std::size_t n) noexcept {
+    if (n == 0)
+        return;
+    const float max = *std::max_element(in, in + n);
+    float sum = 0.0f;
+    for (std::size_t i = 0; i < n; i++) {
+        out[i] = std::exp(in[i] - max);
+        sum += out[i];
+    }
+    for (std::size_t i = 0; i < n; i++)
+        out[i] /= sum;
+}
+
+} // namespace softmax
+} // namespace fast
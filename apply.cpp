@@ -0,0 +1,178 @@
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "catalogue.hpp"
+#include "parallel.hpp"
+
+// Applies any function of the catalogue to a raw file of floats, eg.
+//   apply gain_to_db/table\ 16/4\ simd levels.f32 levels_db.f32
+// Input & output are memory mapped and the function runs on the mapping in
+// L2 sized chunks on a thread pool, so float32 files are never copied.
+// float64 files go through a float buffer per chunk, there being no double
+// kernels. The output has the input's type and length, & may be the input.
+
+static void usage() {
+    std::cout <<
+        "usage: apply [options] FAMILY/NAME IN OUT\n"
+        "  FAMILY/NAME     a function as listed by --list, eg. hz_to_midi/mineiro\n"
+        "  IN, OUT         raw native endian floats, OUT is created or replaced. The\n"
+        "                  same file for both transforms it in place\n"
+        "  --f64           the files hold doubles instead of floats\n"
+        "  --threads N     worker threads, counting the caller (default every core)\n"
+        "  --list          list the functions\n";
+}
+
+namespace {
+
+// A read only or read write mapping of a whole file, unmapped on destruction
+struct mapping {
+    void* data = MAP_FAILED;
+    std::size_t bytes = 0;
+
+    mapping() = default;
+    mapping(const mapping&) = delete;
+    mapping& operator=(const mapping&) = delete;
+    ~mapping() {
+        if (data != MAP_FAILED)
+            munmap(data, bytes);
+    }
+
+    bool map(int fd, std::size_t size, bool writable) {
+        bytes = size;
+        if (size == 0)
+            return true;
+        data = mmap(nullptr, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+        if (data == MAP_FAILED)
+            return false;
+        madvise(data, size, MADV_SEQUENTIAL);
+        return true;
+    }
+};
+
+// closes on destruction
+struct file {
+    int fd = -1;
+    ~file() {
+        if (fd >= 0)
+            close(fd);
+    }
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bool f64 = false;
+    bool list = false;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<const char*> positional;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (!std::strcmp(arg, "--f64")) f64 = true;
+        else if (!std::strcmp(arg, "--threads") && has_value) threads = unsigned(std::max(1, std::atoi(argv[++i])));
+        else if (!std::strcmp(arg, "--list")) list = true;
+        else if (arg[0] == '-' && arg[1] == '-') {
+            usage();
+            return 2;
+        }
+        else positional.push_back(arg);
+    }
+
+    const std::vector<fast::bench::entry> entries = fast::bench::catalogue();
+    if (list) {
+        for (const auto& e : entries)
+            std::cout << e.family << '/' << e.name << std::endl;
+        return 0;
+    }
+    if (positional.size() != 3) {
+        usage();
+        return 2;
+    }
+
+    const fast::bench::entry* fn = nullptr;
+    for (const auto& e : entries)
+        if (std::string(e.family) + '/' + e.name == positional[0])
+            fn = &e;
+    if (!fn) {
+        std::cerr << "no function " << positional[0] << ", see --list" << std::endl;
+        return 2;
+    }
+
+    file in_file, out_file;
+    in_file.fd = open(positional[1], O_RDONLY);
+    struct stat st;
+    if (in_file.fd < 0 || fstat(in_file.fd, &st) != 0) {
+        std::cerr << "could not open " << positional[1] << ": " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+    const std::size_t element = f64 ? sizeof(double) : sizeof(float);
+    const std::size_t bytes = static_cast<std::size_t>(st.st_size);
+    if (bytes % element != 0)
+        std::cerr << "ignoring the last " << bytes % element << " bytes of " << positional[1] << std::endl;
+    const std::size_t n = bytes / element;
+
+    // Not O_TRUNC, as OUT may be IN under another name, which is then
+    // transformed in place. Otherwise every element of OUT is written, so
+    // sizing it is enough
+    out_file.fd = open(positional[2], O_RDWR | O_CREAT, 0644);
+    struct stat out_st;
+    if (out_file.fd < 0 || fstat(out_file.fd, &out_st) != 0) {
+        std::cerr << "could not create " << positional[2] << ": " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+    const bool in_place = out_st.st_dev == st.st_dev && out_st.st_ino == st.st_ino;
+    if (!in_place && ftruncate(out_file.fd, static_cast<off_t>(n * element)) != 0) {
+        std::cerr << "could not create " << positional[2] << ": " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+
+    mapping in, out;
+    if ((!in_place && !in.map(in_file.fd, n * element, false)) || !out.map(out_file.fd, n * element, true)) {
+        std::cerr << "could not map the files: " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+    const void* source = in_place ? out.data : in.data;
+
+    fast::parallel::thread_pool pool(threads);
+    const auto start = std::chrono::steady_clock::now();
+    if (n > 0) {
+        if (f64) {
+            const double* src = static_cast<const double*>(source);
+            double* dst = static_cast<double*>(out.data);
+            const std::size_t chunk = fast::parallel::chunk_elements(2 * sizeof(double) + sizeof(float));
+            pool.for_chunks(n, chunk, [&](std::size_t b, std::size_t e) {
+                thread_local std::vector<float> buffer;
+                buffer.resize(e - b);
+                for (std::size_t i = b; i < e; i++)
+                    buffer[i - b] = static_cast<float>(src[i]);
+                fn->run(buffer.data(), buffer.data(), e - b);
+                for (std::size_t i = b; i < e; i++)
+                    dst[i] = buffer[i - b];
+            });
+        } else {
+            fast::parallel::run(pool, static_cast<const float*>(source), static_cast<float*>(out.data), n, fn->run);
+        }
+    }
+    const std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+
+    // page faults & reading the input from disk are part of the time, but
+    // not writing the output back, which the kernel does when it likes
+    const double moved = 2.0 * double(n * element);
+    std::cerr << fn->family << '/' << fn->name << ": " << n << " elements in "
+              << std::fixed << std::setprecision(3) << seconds.count() << "s on " << pool.concurrency()
+              << " threads, " << std::setprecision(2) << moved / seconds.count() * 1e-9 << " GB/s" << std::endl;
+    return 0;
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+#include "buffer.hpp"
+#include "simd.hpp"
+
+// Runs a kernel over whole buffers, a simd::f32 at a time.
+// The kernel is called with simd::f32 for full vectors and with float for the
+// remaining tail, so it wants to be a generic lambda around a kernel templated
+// on T, eg.
+//   batch::transform(in, out, n, [](auto x) { return sin::wildmagic1<decltype(x)>(x); });
+// Over buffer::padded_span the tail runs as a whole vector into the padding
+// instead, & the loads & stores are aligned.
+
+namespace fast {
+namespace batch {
+
+// out[i] = kernel(in[i]). in and out may be the same buffer
+template <typename Kernel>
+inline void transform(const float* in, float* out, std::size_t n, Kernel&& kernel) noexcept {
+    std::size_t i = 0;
+    for (; i + simd::f32::size <= n; i += simd::f32::size)
+        kernel(simd::f32::load(in + i)).store(out + i);
+    for (; i < n; i++)
+        out[i] = kernel(in[i]);
+}
+
+// out[i] = kernel(in[i]) for every vector covering in.size, padding included.
+// The kernel only ever sees simd::f32. out must be at least as large as in,
+// & may be the same buffer
+template <typename Kernel>
+inline void transform(buffer::padded_span<const float> in, buffer::padded_span<float> out, Kernel&& kernel) noexcept {
+    for (std::size_t i = 0; i < in.size; i += simd::f32::size)
+        kernel(simd::f32::load_aligned(in.data + i)).store_aligned(out.data + i);
+}
+
+} // namespace batch
+} // namespace fast
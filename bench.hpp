@@ -0,0 +1,1006 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "batch.hpp"
+#include "buffer.hpp"
+#include "half.hpp"
+#include "parallel.hpp"
+#include "perf.hpp"
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+// Benchmark harness used by main.cpp
+// Every approximation is registered once in catalogue.hpp as an entry, which
+// is then timed over a block of random inputs and swept against a double
+// precision reference for its error.
+
+namespace fast {
+namespace bench {
+
+using run_fn = void (*)(const float* in, float* out, std::size_t n);
+using chain_fn = float (*)(const float* in, std::size_t n, float y, std::uint32_t zero);
+using ref_fn = double (*)(double);
+
+struct entry {
+    const char* family;
+    const char* name;
+    run_fn run;       // out[i] = f(in[i])
+    chain_fn chain;   // same, but each call waits on the previous one
+    ref_fn reference; // exact version of f, evaluated in double
+    float lo, hi;     // input domain used for both timing & error sweeps
+};
+
+// Instantiated per function so that the kernel gets inlined into the loop.
+// Only the call to the block is indirect
+template <auto F>
+void apply(const float* in, float* out, std::size_t n) noexcept {
+    for (std::size_t i = 0; i < n; i++)
+        out[i] = static_cast<float>(F(in[i]));
+}
+
+// Same, for kernels that take both float and simd::f32
+template <auto K>
+void apply_batch(const float* in, float* out, std::size_t n) noexcept {
+    batch::transform(in, out, n, K);
+}
+
+// Latency rather than throughput: every input depends on the previous result.
+// zero is always 0 but only known at runtime, so y & zero adds nothing to x
+// yet can't be folded away, not even by -ffast-math
+template <auto F>
+float chain(const float* in, std::size_t n, float y, std::uint32_t zero) noexcept {
+    for (std::size_t i = 0; i < n; i++) {
+        const float x = in[i] + std::bit_cast<float>(std::bit_cast<std::uint32_t>(y) & zero);
+        y = static_cast<float>(F(x));
+    }
+    return y;
+}
+
+struct options {
+    int repetitions = 11;
+    int warmup = 2;                 // untimed repetitions before the first timed one
+    double min_rep_seconds = 0.005; // each repetition runs the block at least this long
+    std::size_t block = 4096;       // 16kb of inputs, stays in L1
+    std::size_t sweep = 1 << 16;    // points in the error sweep
+    int bootstrap = 2000;           // resamples for the confidence interval
+    double confidence = 0.95;
+    bool latency = false;           // also time the dependent chain
+    bool exhaustive = false;        // errors over every float in the domain instead of the sweep
+    std::uint32_t exhaustive_step = 1; // or every nth float, to keep it quick
+    std::vector<std::size_t> block_sizes = { 4096, 8192, 16384, 32768, 65536 }; // outputs per block entry run
+    std::size_t scaling_size = std::size_t(1) << 26; // elements per scaling run, 256mb each way
+    std::vector<unsigned> scaling_threads;           // empty for 1, 2, 4.. up to every core
+    std::vector<std::size_t> layout_sizes = { 7, 33, 100, 1000, 4093 }; // mostly not whole vectors, for the tail
+    std::size_t io_size = std::size_t(1) << 24;      // elements per io run, well past the caches
+    std::vector<std::size_t> bank_partials = { 16, 64, 256, 1024, 4096 }; // partials per oscillator bank run
+    std::size_t bank_samples = 8192;                 // samples rendered per bank run
+    std::size_t bank_block = 64;                     // samples per process call, like an audio callback
+    std::vector<std::size_t> voice_counts = { 1, 16, 64 }; // voices per voice run, of bank_samples in bank_block blocks
+};
+
+struct timing {
+    double median = 0;
+    double lo = 0; // confidence interval of the median
+    double hi = 0;
+};
+
+struct error_stats {
+    double max_abs = 0;
+    double max_rel = 0;
+    double rms_abs = 0;
+    double max_ulp = 0; // against the reference rounded to float
+};
+
+struct result {
+    const entry* e;
+    timing ns;      // nanoseconds per element
+    timing latency; // nanoseconds per dependent call, if measured
+    error_stats err;
+    std::vector<double> events; // per element, in the order of counters::opened()
+    int rank = 0;               // within the family, 1 is fastest
+    bool tie = false;           // within noise of another entry of the same rank
+};
+
+inline volatile float sink{}; // ensures a side effect
+inline volatile std::uint32_t chain_zero{}; // see chain()
+
+static inline double median(std::vector<double> v) noexcept {
+    std::sort(v.begin(), v.end());
+    const std::size_t n = v.size();
+    return (n & 1) ? v[n / 2] : 0.5 * (v[n / 2 - 1] + v[n / 2]);
+}
+
+static inline std::vector<float> random_inputs(const entry& e, std::size_t n, std::uint32_t seed = 1) {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<float> dis(e.lo, e.hi);
+    std::vector<float> v(n);
+    for (auto& x : v) x = dis(gen);
+    return v;
+}
+
+// Times one entry, one repetition at a time, so that main can interleave the
+// repetitions of all entries in a random order. Slow drifts like frequency
+// scaling or a noisy neighbour then spread over every entry instead of
+// penalising whichever ran at the wrong moment.
+class timer {
+public:
+    // Generates the inputs and calibrates how many blocks make up one
+    // repetition. The calibration doubles as the first warmup
+    timer(const entry& e, const options& opt)
+        : e_(e), opt_(opt), in_(random_inputs(e, opt.block)), out_(opt.block) {
+        while (run_blocks() * 1e-9 < opt.min_rep_seconds)
+            iters_ *= 2;
+        if (opt.latency)
+            while (run_chains() * 1e-9 < opt.min_rep_seconds)
+                chain_iters_ *= 2;
+    }
+
+    // One untimed repetition
+    void warmup() noexcept {
+        run_blocks();
+        if (opt_.latency) run_chains();
+    }
+
+    // One timed repetition. When pmu is given its counters are accumulated
+    void sample(counters* pmu = nullptr) {
+        if (pmu) pmu->start();
+        const double ns = run_blocks();
+        if (pmu) {
+            const std::vector<double> counts = pmu->stop();
+            events_.resize(counts.size(), 0.0);
+            for (std::size_t i = 0; i < counts.size(); i++)
+                events_[i] += counts[i];
+        }
+        samples_.push_back(ns / double(iters_ * opt_.block));
+        if (opt_.latency)
+            chain_samples_.push_back(run_chains() / double(chain_iters_ * opt_.block));
+    }
+
+    // Median with a bootstrap confidence interval
+    timing summary() const;
+    timing latency() const;
+
+    // Counter totals per element
+    std::vector<double> events() const {
+        std::vector<double> v = events_;
+        const double elements = double(iters_ * opt_.block) * double(samples_.size());
+        for (double& c : v) c /= elements;
+        return v;
+    }
+
+    const entry& e() const noexcept { return e_; }
+
+private:
+    double run_blocks() noexcept {
+        using clock = std::chrono::steady_clock;
+        const auto start = clock::now();
+        for (std::size_t i = 0; i < iters_; i++)
+            e_.run(in_.data(), out_.data(), opt_.block);
+        const std::chrono::duration<double, std::nano> diff = clock::now() - start;
+        sink = out_[samples_.size() % opt_.block];
+        return diff.count();
+    }
+
+    double run_chains() noexcept {
+        using clock = std::chrono::steady_clock;
+        const std::uint32_t zero = chain_zero;
+        float y = 0;
+        const auto start = clock::now();
+        for (std::size_t i = 0; i < chain_iters_; i++)
+            y = e_.chain(in_.data(), opt_.block, y, zero);
+        const std::chrono::duration<double, std::nano> diff = clock::now() - start;
+        sink = y;
+        return diff.count();
+    }
+
+    const entry& e_;
+    const options& opt_;
+    std::vector<float> in_, out_;
+    std::size_t iters_ = 1;
+    std::size_t chain_iters_ = 1;
+    std::vector<double> samples_;
+    std::vector<double> chain_samples_;
+    std::vector<double> events_;
+};
+
+// Percentile bootstrap of the median. Resampling is seeded, so the same
+// samples always give the same interval
+static inline timing bootstrap(const std::vector<double>& samples, int resamples, double confidence) {
+    timing t;
+    if (samples.empty())
+        return t;
+    t.median = median(samples);
+    if (samples.size() < 3) {
+        t.lo = *std::min_element(samples.begin(), samples.end());
+        t.hi = *std::max_element(samples.begin(), samples.end());
+        return t;
+    }
+
+    std::mt19937 gen(12345);
+    std::uniform_int_distribution<std::size_t> pick(0, samples.size() - 1);
+    std::vector<double> medians(resamples);
+    std::vector<double> resample(samples.size());
+    for (double& m : medians) {
+        for (double& x : resample) x = samples[pick(gen)];
+        m = median(resample);
+    }
+    std::sort(medians.begin(), medians.end());
+    const double tail = 0.5 * (1.0 - confidence);
+    t.lo = medians[std::size_t(tail * (resamples - 1))];
+    t.hi = medians[std::size_t((1.0 - tail) * (resamples - 1))];
+    return t;
+}
+
+inline timing timer::summary() const {
+    return bootstrap(samples_, opt_.bootstrap, opt_.confidence);
+}
+
+inline timing timer::latency() const {
+    return bootstrap(chain_samples_, opt_.bootstrap, opt_.confidence);
+}
+
+// Restricts the process to one core so the scheduler can't migrate it
+// between repetitions. Linux only
+static inline bool pin_to_cpu(int cpu) noexcept {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+// Ranks every result within its family by median time. An entry whose
+// interval overlaps the fastest entry of the current rank is within noise of
+// it, so it shares that rank and both are marked as a tie
+static inline void rank(std::vector<result>& results) {
+    std::vector<result*> sorted;
+    for (result& r : results) sorted.push_back(&r);
+    std::stable_sort(sorted.begin(), sorted.end(), [](const result* a, const result* b) {
+        const int f = std::strcmp(a->e->family, b->e->family);
+        return f != 0 ? f < 0 : a->ns.median < b->ns.median;
+    });
+
+    result* leader = nullptr;
+    int position = 0;
+    for (result* r : sorted) {
+        if (!leader || std::strcmp(leader->e->family, r->e->family) != 0) {
+            leader = r;
+            position = 0;
+        }
+        position++;
+        if (r != leader && r->ns.lo <= leader->ns.hi) {
+            r->rank = leader->rank;
+            r->tie = true;
+            leader->tie = true;
+        } else {
+            leader = r;
+            r->rank = position;
+        }
+    }
+}
+
+// Maps floats onto integers in the same order, so neighbouring floats are
+// neighbouring integers. -0 and +0 get different keys
+static inline std::uint32_t ordered_key(float f) noexcept {
+    const std::uint32_t u = std::bit_cast<std::uint32_t>(f);
+    return (u & 0x80000000u) ? ~u : (u | 0x80000000u);
+}
+static inline float from_ordered_key(std::uint32_t k) noexcept {
+    return std::bit_cast<float>((k & 0x80000000u) ? (k & 0x7fffffffu) : ~k);
+}
+
+// distance in representable floats, -0 and +0 count as the same
+static inline double ulp_distance(float a, float b) noexcept {
+    const std::int64_t ka = ordered_key(a == 0.0f ? 0.0f : a);
+    const std::int64_t kb = ordered_key(b == 0.0f ? 0.0f : b);
+    return double(ka > kb ? ka - kb : kb - ka);
+}
+
+// The inputs the errors are measured over. Either an evenly spaced sweep of
+// opt.sweep points, or with opt.exhaustive every float from lo to hi.
+// Both are deterministic, so errors are directly comparable between runs
+class error_inputs {
+public:
+    error_inputs(const entry& e, const options& opt) : e_(e), opt_(opt) {
+        if (opt.exhaustive) {
+            key_ = ordered_key(e.lo);
+            last_ = ordered_key(e.hi);
+        }
+    }
+
+    // fills the next chunk, returns how many inputs were written
+    std::size_t next(float* in, std::size_t max) noexcept {
+        std::size_t n = 0;
+        if (opt_.exhaustive) {
+            const std::uint64_t step = std::max<std::uint32_t>(opt_.exhaustive_step, 1);
+            for (; n < max && key_ <= last_; n++, key_ += step)
+                in[n] = from_ordered_key(std::uint32_t(key_));
+        } else {
+            const std::size_t total = opt_.sweep;
+            for (; n < max && i_ < total; n++, i_++)
+                in[n] = e_.lo + (e_.hi - e_.lo) * static_cast<float>(double(i_) / double(total - 1));
+        }
+        return n;
+    }
+
+private:
+    const entry& e_;
+    const options& opt_;
+    std::size_t i_ = 0;
+    std::uint64_t key_ = 1, last_ = 0;
+};
+
+// Measures the error of every result. Results that share a reference and a
+// domain are measured together, so the double precision reference is only
+// evaluated once per input, which is most of the cost of an exhaustive run
+static inline void measure_errors(std::vector<result>& results, const options& opt) {
+    constexpr std::size_t chunk = 1 << 16;
+    std::vector<float> in(chunk), out(chunk);
+    std::vector<double> ref(chunk);
+    std::vector<bool> done(results.size(), false);
+
+    for (std::size_t first = 0; first < results.size(); first++) {
+        if (done[first])
+            continue;
+        const entry& e = *results[first].e;
+        std::vector<result*> group;
+        std::vector<double> sum_sq;
+        for (std::size_t j = first; j < results.size(); j++) {
+            const entry& o = *results[j].e;
+            if (o.reference == e.reference && o.lo == e.lo && o.hi == e.hi) {
+                done[j] = true;
+                group.push_back(&results[j]);
+                results[j].err = {};
+                sum_sq.push_back(0.0);
+            }
+        }
+
+        error_inputs inputs(e, opt);
+        std::size_t total = 0;
+        while (const std::size_t n = inputs.next(in.data(), chunk)) {
+            total += n;
+            for (std::size_t i = 0; i < n; i++)
+                ref[i] = e.reference(in[i]);
+            for (std::size_t g = 0; g < group.size(); g++) {
+                error_stats& s = group[g]->err;
+                group[g]->e->run(in.data(), out.data(), n);
+                for (std::size_t i = 0; i < n; i++) {
+                    if (!std::isfinite(ref[i]))
+                        continue;
+                    const double err = std::fabs(double(out[i]) - ref[i]);
+                    if (!std::isfinite(err)) {
+                        s.max_abs = s.max_rel = s.max_ulp = INFINITY;
+                        continue;
+                    }
+                    s.max_abs = std::max(s.max_abs, err);
+                    if (std::fabs(ref[i]) > 1.17549435e-38) // FLT_MIN
+                        s.max_rel = std::max(s.max_rel, err / std::fabs(ref[i]));
+                    const float rounded = static_cast<float>(ref[i]);
+                    if (std::isfinite(rounded))
+                        s.max_ulp = std::max(s.max_ulp, ulp_distance(out[i], rounded));
+                    sum_sq[g] += err * err;
+                }
+            }
+        }
+        for (std::size_t g = 0; g < group.size(); g++)
+            group[g]->err.rms_abs = total ? std::sqrt(sum_sq[g] / double(total)) : 0.0;
+    }
+}
+
+// instructions per cycle, if both were counted
+static inline double ipc(const counters* pmu, const std::vector<double>& events) noexcept {
+    if (!pmu || events.empty()) return 0;
+    double cycles = 0, instructions = 0;
+    for (std::size_t i = 0; i < pmu->opened().size(); i++) {
+        if (pmu->opened()[i].name == "cycles") cycles = events[i];
+        if (pmu->opened()[i].name == "instructions") instructions = events[i];
+    }
+    return cycles > 0 ? instructions / cycles : 0;
+}
+
+static inline void print_header(const options& opt, const counters* pmu = nullptr) {
+    std::cout << std::left << std::setw(12) << "FAMILY" << std::setw(34) << "NAME"
+              << std::right << std::setw(10) << "NS/ELEM" << std::setw(10) << "CI LO"
+              << std::setw(10) << "CI HI" << std::setw(6) << "RANK" << std::setw(14) << "MAX ABS ERR"
+              << std::setw(14) << "MAX REL ERR";
+    if (opt.latency)
+        std::cout << std::setw(10) << "LAT NS";
+    if (pmu) {
+        // counters are per element
+        for (const counter_spec& c : pmu->opened())
+            std::cout << std::setw(16) << c.name;
+        std::cout << std::setw(8) << "ipc";
+    }
+    std::cout << std::endl;
+}
+
+static inline void print_result(const result& r, const options& opt, const counters* pmu = nullptr) {
+    std::cout << std::left << std::setw(12) << r.e->family << std::setw(34) << r.e->name
+              << std::right << std::fixed << std::setprecision(3)
+              << std::setw(10) << r.ns.median << std::setw(10) << r.ns.lo << std::setw(10) << r.ns.hi
+              << std::setw(6) << ((r.tie ? "=" : "") + std::to_string(r.rank))
+              << std::scientific << std::setprecision(3)
+              << std::setw(14) << r.err.max_abs << std::setw(14) << r.err.max_rel;
+    if (opt.latency)
+        std::cout << std::fixed << std::setprecision(3) << std::setw(10) << r.latency.median;
+    if (pmu) {
+        std::cout << std::fixed << std::setprecision(3);
+        for (double v : r.events)
+            std::cout << std::setw(16) << v;
+        std::cout << std::setw(8) << std::setprecision(2) << ipc(pmu, r.events);
+    }
+    std::cout << std::defaultfloat << std::endl;
+}
+
+// Read by bench/compare.py, bench/matrix.py & bench/pareto.py, keep the columns in sync
+// lo, hi & ref say what the errors were measured against: results of the
+// same family with the same ref number share a reference function.
+// Latency & counter columns are only written when they were measured
+static inline bool write_csv(const std::string& path, const std::vector<result>& results,
+                             const options& opt, const counters* pmu = nullptr) {
+    std::ofstream f(path);
+    if (!f)
+        return false;
+    f << "family,name,ns_median,ns_lo,ns_hi,rank,tie,max_abs_err,max_rel_err,rms_abs_err,max_ulp_err,lo,hi,ref";
+    if (opt.latency)
+        f << ",lat_median,lat_lo,lat_hi";
+    if (pmu) {
+        for (const counter_spec& c : pmu->opened())
+            f << ',' << c.name;
+        f << ",ipc";
+    }
+    f << '\n' << std::setprecision(9);
+    for (const result& r : results) {
+        int ref = 0;
+        std::vector<ref_fn> seen;
+        for (const result& o : results) {
+            if (std::strcmp(o.e->family, r.e->family) != 0) continue;
+            if (o.e->reference == r.e->reference) break;
+            if (std::find(seen.begin(), seen.end(), o.e->reference) == seen.end()) {
+                seen.push_back(o.e->reference);
+                ref++;
+            }
+        }
+        f << r.e->family << ',' << r.e->name << ','
+          << r.ns.median << ',' << r.ns.lo << ',' << r.ns.hi << ','
+          << r.rank << ',' << int(r.tie) << ','
+          << r.err.max_abs << ',' << r.err.max_rel << ',' << r.err.rms_abs << ',' << r.err.max_ulp << ','
+          << r.e->lo << ',' << r.e->hi << ',' << ref;
+        if (opt.latency)
+            f << ',' << r.latency.median << ',' << r.latency.lo << ',' << r.latency.hi;
+        if (pmu) {
+            for (double v : r.events)
+                f << ',' << v;
+            f << ',' << ipc(pmu, r.events);
+        }
+        f << '\n';
+    }
+    return bool(f);
+}
+
+/** BLOCKS */
+// Whole pipelines rather than single approximations, eg. a spectrum in dB
+// from interleaved FFT bins. They are timed per output at each of
+// options::block_sizes, since how the stages share the cache depends on
+// the size, and checked against a double precision version of the pipeline.
+// Registered in catalogue.hpp
+
+using block_ref_fn = void (*)(const float* in, double* out, std::size_t n);
+
+struct block_entry {
+    const char* group;
+    const char* name;
+    run_fn run;             // n outputs from stride * n inputs
+    block_ref_fn reference; // same, exact
+    std::size_t stride;     // inputs per output, 2 for complex bins
+    float lo, hi;           // input domain
+};
+
+struct block_result {
+    const block_entry* e;
+    std::size_t n;
+    timing ns;      // nanoseconds per output
+    double max_abs; // against the reference
+};
+
+// Every entry at every size. Within a size the repetitions go round robin
+// over the entries, for the same reason main shuffles them
+static inline std::vector<block_result> run_blocks(const std::vector<const block_entry*>& entries, const options& opt) {
+    using clock = std::chrono::steady_clock;
+    std::vector<block_result> results;
+    for (std::size_t n : opt.block_sizes) {
+        struct state {
+            std::vector<float> in, out;
+            std::size_t iters = 1;
+            std::vector<double> samples;
+        };
+        std::vector<state> states(entries.size());
+        auto run = [&](std::size_t k) {
+            const auto start = clock::now();
+            for (std::size_t i = 0; i < states[k].iters; i++)
+                entries[k]->run(states[k].in.data(), states[k].out.data(), n);
+            const std::chrono::duration<double, std::nano> diff = clock::now() - start;
+            sink = states[k].out[n / 2];
+            return diff.count();
+        };
+
+        for (std::size_t k = 0; k < entries.size(); k++) {
+            std::mt19937 gen(1);
+            std::uniform_real_distribution<float> dis(entries[k]->lo, entries[k]->hi);
+            states[k].in.resize(entries[k]->stride * n);
+            states[k].out.resize(n);
+            for (float& x : states[k].in) x = dis(gen);
+            while (run(k) * 1e-9 < opt.min_rep_seconds)
+                states[k].iters *= 2;
+            for (int w = 0; w < opt.warmup; w++)
+                run(k);
+        }
+        for (int rep = 0; rep < opt.repetitions; rep++)
+            for (std::size_t k = 0; k < entries.size(); k++)
+                states[k].samples.push_back(run(k) / double(states[k].iters * n));
+
+        for (std::size_t k = 0; k < entries.size(); k++) {
+            std::vector<double> exact(n);
+            entries[k]->reference(states[k].in.data(), exact.data(), n);
+            entries[k]->run(states[k].in.data(), states[k].out.data(), n);
+            double max_abs = 0;
+            for (std::size_t i = 0; i < n; i++)
+                max_abs = std::max(max_abs, std::abs(double(states[k].out[i]) - exact[i]));
+            results.push_back({ entries[k], n, bootstrap(states[k].samples, opt.bootstrap, opt.confidence), max_abs });
+        }
+    }
+    return results;
+}
+
+static inline void print_block_header() {
+    std::cout << std::left << std::setw(12) << "GROUP" << std::setw(34) << "NAME"
+              << std::right << std::setw(8) << "N" << std::setw(10) << "NS/ELEM" << std::setw(10) << "CI LO"
+              << std::setw(10) << "CI HI" << std::setw(14) << "MAX ABS ERR" << std::endl;
+}
+
+static inline void print_block_result(const block_result& r) {
+    std::cout << std::left << std::setw(12) << r.e->group << std::setw(34) << r.e->name
+              << std::right << std::setw(8) << r.n << std::fixed << std::setprecision(3)
+              << std::setw(10) << r.ns.median << std::setw(10) << r.ns.lo << std::setw(10) << r.ns.hi
+              << std::scientific << std::setprecision(3) << std::setw(14) << r.max_abs
+              << std::defaultfloat << std::endl;
+}
+
+/** SCALING */
+// One entry over an array far larger than the caches, split over 1 to N
+// threads by parallel::thread_pool, and once by parallel::par_unseq where
+// there is one. GB/s counts the 8 bytes read & written per element. A copy
+// of the same array runs first, as the bandwidth that cheap kernels end up
+// limited by
+
+struct scaling_result {
+    const char* family;
+    const char* name;
+    const char* executor;
+    unsigned threads;
+    timing ns;      // nanoseconds per element, all threads together
+    double speedup; // over one thread of the same entry
+};
+
+static inline void copy_block(const float* in, float* out, std::size_t n) noexcept {
+    std::memcpy(out, in, n * sizeof(float));
+}
+
+template <typename Executor>
+static inline timing time_scaling(Executor& ex, run_fn run, const float* in, float* out, std::size_t n, const options& opt) {
+    using clock = std::chrono::steady_clock;
+    for (int w = 0; w < opt.warmup; w++)
+        parallel::run(ex, in, out, n, run);
+    std::vector<double> samples;
+    for (int rep = 0; rep < opt.repetitions; rep++) {
+        const auto start = clock::now();
+        parallel::run(ex, in, out, n, run);
+        const std::chrono::duration<double, std::nano> diff = clock::now() - start;
+        samples.push_back(diff.count() / double(n));
+    }
+    sink = out[n / 2];
+    return bootstrap(samples, opt.bootstrap, opt.confidence);
+}
+
+static inline std::vector<unsigned> scaling_threads(const options& opt) {
+    if (!opt.scaling_threads.empty())
+        return opt.scaling_threads;
+    const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<unsigned> threads;
+    for (unsigned t = 1; t < cores; t *= 2)
+        threads.push_back(t);
+    threads.push_back(cores);
+    return threads;
+}
+
+static inline std::vector<scaling_result> run_scaling(const std::vector<const entry*>& entries, const options& opt) {
+    const std::size_t n = opt.scaling_size;
+    std::vector<float> in(n), out(n);
+    std::vector<scaling_result> results;
+
+    auto measure = [&](const char* family, const char* name, run_fn run) {
+        double one = 0;
+        for (unsigned t : scaling_threads(opt)) {
+            parallel::thread_pool pool(t);
+            const timing ns = time_scaling(pool, run, in.data(), out.data(), n, opt);
+            if (t == 1)
+                one = ns.median;
+            results.push_back({ family, name, "pool", t, ns, one > 0 ? one / ns.median : 0 });
+        }
+#if defined(__cpp_lib_parallel_algorithm)
+        parallel::par_unseq par;
+        const timing ns = time_scaling(par, run, in.data(), out.data(), n, opt);
+        results.push_back({ family, name, "par_unseq", par.concurrency(), ns, one > 0 ? one / ns.median : 0 });
+#endif
+    };
+
+    std::mt19937 gen(1);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    for (float& x : in) x = unit(gen);
+    measure("memory", "copy", &copy_block);
+
+    for (const entry* e : entries) {
+        std::mt19937 g(1);
+        std::uniform_real_distribution<float> dis(e->lo, e->hi);
+        for (float& x : in) x = dis(g);
+        measure(e->family, e->name, e->run);
+    }
+    return results;
+}
+
+static inline void print_scaling_header() {
+    std::cout << std::left << std::setw(12) << "FAMILY" << std::setw(34) << "NAME" << std::setw(11) << "EXECUTOR"
+              << std::right << std::setw(8) << "THREADS" << std::setw(10) << "NS/ELEM" << std::setw(10) << "CI LO"
+              << std::setw(10) << "CI HI" << std::setw(9) << "GB/S" << std::setw(9) << "SPEEDUP" << std::endl;
+}
+
+static inline void print_scaling_result(const scaling_result& r) {
+    std::cout << std::left << std::setw(12) << r.family << std::setw(34) << r.name << std::setw(11) << r.executor
+              << std::right << std::setw(8) << r.threads << std::fixed << std::setprecision(3)
+              << std::setw(10) << r.ns.median << std::setw(10) << r.ns.lo << std::setw(10) << r.ns.hi
+              << std::setprecision(2) << std::setw(9) << 2 * sizeof(float) / r.ns.median
+              << std::setw(9) << r.speedup << std::defaultfloat << std::endl;
+}
+
+/** LAYOUT */
+// What alignment & the scalar tail cost a batch kernel. Each is timed three
+// ways over the same data:
+//   padded     batch::transform over buffer::padded_span, aligned & no tail
+//   aligned    over pointers to the same aligned memory, with the scalar tail
+//   unaligned  over pointers one float past it
+// at sizes that are mostly not a whole number of vectors. Registered in
+// catalogue.hpp
+
+using padded_fn = void (*)(buffer::padded_span<const float> in, buffer::padded_span<float> out);
+
+struct layout_entry {
+    const char* name;
+    run_fn pointer;
+    padded_fn padded;
+    float lo, hi;
+};
+
+struct layout_result {
+    const layout_entry* e;
+    std::size_t n;
+    double padded, aligned, unaligned; // median nanoseconds per element
+};
+
+static inline std::vector<layout_result> run_layout(const std::vector<layout_entry>& entries, const options& opt) {
+    using clock = std::chrono::steady_clock;
+    std::vector<layout_result> results;
+    for (const layout_entry& e : entries) {
+        for (std::size_t n : opt.layout_sizes) {
+            // one more float than needed, for the unaligned pointers
+            buffer::aligned in(n + 1), out(n + 1);
+            std::mt19937 gen(1);
+            std::uniform_real_distribution<float> dis(e.lo, e.hi);
+            for (float& x : in) x = dis(gen);
+            in.resize(n);
+            out.resize(n);
+
+            std::size_t iters = 1;
+            auto run = [&](int variant) {
+                const auto start = clock::now();
+                for (std::size_t i = 0; i < iters; i++) {
+                    if (variant == 0) e.padded(in.span(), out.span());
+                    else if (variant == 1) e.pointer(in.data(), out.data(), n);
+                    else e.pointer(in.data() + 1, out.data() + 1, n);
+                }
+                const std::chrono::duration<double, std::nano> diff = clock::now() - start;
+                sink = out[n / 2];
+                return diff.count() / double(iters * n);
+            };
+            while (run(2) * double(iters * n) * 1e-9 < opt.min_rep_seconds)
+                iters *= 2;
+            for (int w = 0; w < opt.warmup; w++)
+                for (int v = 0; v < 3; v++)
+                    run(v);
+            std::vector<double> samples[3];
+            for (int rep = 0; rep < opt.repetitions; rep++)
+                for (int v = 0; v < 3; v++)
+                    samples[v].push_back(run(v));
+            results.push_back({ &e, n, median(samples[0]), median(samples[1]), median(samples[2]) });
+        }
+    }
+    return results;
+}
+
+static inline void print_layout_header() {
+    std::cout << std::left << std::setw(34) << "NAME" << std::right << std::setw(8) << "N"
+              << std::setw(10) << "PADDED" << std::setw(10) << "ALIGNED" << std::setw(11) << "UNALIGNED" << std::endl;
+}
+
+static inline void print_layout_result(const layout_result& r) {
+    std::cout << std::left << std::setw(34) << r.e->name << std::right << std::setw(8) << r.n
+              << std::fixed << std::setprecision(3) << std::setw(10) << r.padded << std::setw(10) << r.aligned
+              << std::setw(11) << r.unaligned << std::defaultfloat << std::endl;
+}
+
+/** IO */
+// Batch kernels reading & writing float, half::f16 & half::bf16 arrays of
+// options::io_size elements, too large for the caches, so that the bytes per
+// element show. The error is the combined one, of rounding the input, the
+// kernel & rounding the output, against the reference of the float input.
+// Registered in catalogue.hpp
+
+template <typename T>
+using io_fn = void (*)(const T* in, T* out, std::size_t n);
+
+struct io_entry {
+    const char* name;
+    ref_fn reference;
+    float lo, hi;
+    io_fn<float> f32;
+    io_fn<half::f16> f16;
+    io_fn<half::bf16> bf16;
+};
+
+struct io_result {
+    const io_entry* e;
+    const char* type;
+    std::size_t bytes; // per element, in & out
+    timing ns;         // nanoseconds per element
+    double max_abs, max_rel;
+};
+
+static inline std::vector<io_result> run_io(const std::vector<io_entry>& entries, const options& opt) {
+    using clock = std::chrono::steady_clock;
+    const std::size_t n = opt.io_size;
+    std::vector<io_result> results;
+    for (const io_entry& e : entries) {
+        std::vector<float> in32(n), out32(n);
+        std::vector<half::f16> in16(n), out16(n);
+        std::vector<half::bf16> inb(n), outb(n);
+        std::mt19937 gen(1);
+        std::uniform_real_distribution<float> dis(e.lo, e.hi);
+        for (std::size_t i = 0; i < n; i++) {
+            in32[i] = dis(gen);
+            in16[i] = half::to_f16(in32[i]);
+            inb[i] = half::to_bf16(in32[i]);
+        }
+
+        auto time = [&](int type) {
+            const auto start = clock::now();
+            if (type == 0) e.f32(in32.data(), out32.data(), n);
+            else if (type == 1) e.f16(in16.data(), out16.data(), n);
+            else e.bf16(inb.data(), outb.data(), n);
+            const std::chrono::duration<double, std::nano> diff = clock::now() - start;
+            return diff.count() / double(n);
+        };
+        for (int w = 0; w < opt.warmup; w++)
+            for (int t = 0; t < 3; t++)
+                time(t);
+        std::vector<double> samples[3];
+        for (int rep = 0; rep < opt.repetitions; rep++)
+            for (int t = 0; t < 3; t++)
+                samples[t].push_back(time(t));
+
+        auto errors = [&](const char* type, std::size_t bytes, const std::vector<double>& s, auto&& out) {
+            io_result r{ &e, type, bytes, bootstrap(s, opt.bootstrap, opt.confidence), 0, 0 };
+            for (std::size_t i = 0; i < n; i++) {
+                const double exact = e.reference(in32[i]);
+                const double err = std::abs(double(half::to_f32(out[i])) - exact);
+                r.max_abs = std::max(r.max_abs, err);
+                if (exact != 0)
+                    r.max_rel = std::max(r.max_rel, err / std::abs(exact));
+            }
+            results.push_back(r);
+        };
+        errors("float", 2 * sizeof(float), samples[0], out32);
+        errors("f16", 2 * sizeof(half::f16), samples[1], out16);
+        errors("bf16", 2 * sizeof(half::bf16), samples[2], outb);
+    }
+    return results;
+}
+
+static inline void print_io_header() {
+    std::cout << std::left << std::setw(34) << "NAME" << std::setw(7) << "TYPE"
+              << std::right << std::setw(10) << "NS/ELEM" << std::setw(10) << "CI LO" << std::setw(10) << "CI HI"
+              << std::setw(9) << "GB/S" << std::setw(14) << "MAX ABS ERR" << std::setw(14) << "MAX REL ERR" << std::endl;
+}
+
+static inline void print_io_result(const io_result& r) {
+    std::cout << std::left << std::setw(34) << r.e->name << std::setw(7) << r.type
+              << std::right << std::fixed << std::setprecision(3)
+              << std::setw(10) << r.ns.median << std::setw(10) << r.ns.lo << std::setw(10) << r.ns.hi
+              << std::setprecision(2) << std::setw(9) << double(r.bytes) / r.ns.median
+              << std::scientific << std::setprecision(3) << std::setw(14) << r.max_abs << std::setw(14) << r.max_rel
+              << std::defaultfloat << std::endl;
+}
+
+/** BANKS */
+// Additive synthesis, see oscillator.hpp: options::bank_samples samples of
+// each of options::bank_partials partials, rendered options::bank_block
+// samples at a time. M/S is millions of partials times samples a second. The
+// partials have random frequencies between 20Hz & 20kHz at 48kHz & amplitudes
+// adding up to at most 1, & the error is the largest difference from a double
+// precision sum of sines over the whole render. Registered in catalogue.hpp
+
+// Renders samples of partials into out, which starts zeroed, & returns the
+// nanoseconds spent rendering, leaving out setting up the bank
+using bank_fn = double (*)(const float* frequency, const float* amplitude, std::size_t partials, float* out,
+                           std::size_t samples, std::size_t block);
+
+struct bank_entry {
+    const char* name;
+    bank_fn run;
+};
+
+struct bank_result {
+    const bank_entry* e;
+    std::size_t partials;
+    timing ns; // nanoseconds per partial & sample
+    double max_abs;
+};
+
+static inline std::vector<bank_result> run_banks(const std::vector<bank_entry>& entries, const options& opt) {
+    const std::size_t samples = opt.bank_samples;
+    std::vector<bank_result> results;
+    for (std::size_t partials : opt.bank_partials) {
+        std::vector<float> frequency(partials), amplitude(partials), out(samples);
+        std::mt19937 gen(1);
+        std::uniform_real_distribution<float> hz(20.0f, 20000.0f), unit(0.0f, 1.0f);
+        for (std::size_t k = 0; k < partials; k++) {
+            frequency[k] = hz(gen) / 48000.0f;
+            amplitude[k] = unit(gen) / float(partials);
+        }
+        std::vector<double> exact(samples, 0.0);
+        for (std::size_t k = 0; k < partials; k++)
+            for (std::size_t t = 0; t < samples; t++)
+                exact[t] += amplitude[k] * std::sin(6.283185307179586 * std::fmod(double(frequency[k]) * double(t), 1.0));
+
+        for (const bank_entry& e : entries) {
+            auto render = [&] {
+                std::fill(out.begin(), out.end(), 0.0f);
+                const double ns = e.run(frequency.data(), amplitude.data(), partials, out.data(), samples, opt.bank_block);
+                sink = out[samples / 2];
+                return ns / double(partials * samples);
+            };
+            for (int w = 0; w < opt.warmup; w++)
+                render();
+            std::vector<double> s;
+            for (int rep = 0; rep < opt.repetitions; rep++)
+                s.push_back(render());
+            double max_abs = 0;
+            for (std::size_t t = 0; t < samples; t++)
+                max_abs = std::max(max_abs, std::abs(double(out[t]) - exact[t]));
+            results.push_back({ &e, partials, bootstrap(s, opt.bootstrap, opt.confidence), max_abs });
+        }
+    }
+    return results;
+}
+
+static inline void print_bank_header() {
+    std::cout << std::left << std::setw(34) << "NAME" << std::right << std::setw(9) << "PARTIALS"
+              << std::setw(10) << "NS/PS" << std::setw(10) << "CI LO" << std::setw(10) << "CI HI"
+              << std::setw(10) << "M/S" << std::setw(14) << "MAX ABS ERR" << std::endl;
+}
+
+static inline void print_bank_result(const bank_result& r) {
+    std::cout << std::left << std::setw(34) << r.e->name << std::right << std::setw(9) << r.partials
+              << std::fixed << std::setprecision(3)
+              << std::setw(10) << r.ns.median << std::setw(10) << r.ns.lo << std::setw(10) << r.ns.hi
+              << std::setprecision(0) << std::setw(10) << 1e3 / r.ns.median
+              << std::scientific << std::setprecision(3) << std::setw(14) << r.max_abs
+              << std::defaultfloat << std::endl;
+}
+
+/** VOICES */
+// Oscillators with harmonics, see wavetable.hpp: options::voice_counts voices
+// mixed for options::bank_samples samples, options::bank_block at a time.
+// PER CORE is how many of them one core renders in real time at 48kHz. They
+// have random pitches between midi notes 36 & 96, & amplitudes adding up to
+// 1, & the error is the largest difference from the double precision mix.
+// Registered in catalogue.hpp
+
+// Renders samples of the voices into out, which starts zeroed, & returns the
+// nanoseconds spent rendering, leaving out setting up the voices
+using voice_fn = double (*)(const float* frequency, std::size_t voices, float* out, std::size_t samples,
+                            std::size_t block);
+using voice_ref_fn = void (*)(const float* frequency, std::size_t voices, double* out, std::size_t samples);
+
+struct voice_entry {
+    const char* name;
+    voice_fn run;
+    voice_ref_fn reference;
+};
+
+struct voice_result {
+    const voice_entry* e;
+    std::size_t voices;
+    timing ns; // nanoseconds per voice & sample
+    double max_abs;
+};
+
+static inline std::vector<voice_result> run_voices(const std::vector<voice_entry>& entries, const options& opt) {
+    const std::size_t samples = opt.bank_samples;
+    std::vector<voice_result> results;
+    for (std::size_t voices : opt.voice_counts) {
+        std::vector<float> frequency(voices), out(samples);
+        std::mt19937 gen(1);
+        std::uniform_real_distribution<float> note(36.0f, 96.0f);
+        for (float& f : frequency)
+            f = 440.0f * std::exp2((note(gen) - 69.0f) / 12.0f) / 48000.0f;
+
+        voice_ref_fn last = nullptr; // the entries mostly share one, which is slow
+        std::vector<double> exact(samples);
+        for (const voice_entry& e : entries) {
+            if (e.reference != last) {
+                e.reference(frequency.data(), voices, exact.data(), samples);
+                last = e.reference;
+            }
+            auto render = [&] {
+                std::fill(out.begin(), out.end(), 0.0f);
+                const double ns = e.run(frequency.data(), voices, out.data(), samples, opt.bank_block);
+                sink = out[samples / 2];
+                return ns / double(voices * samples);
+            };
+            for (int w = 0; w < opt.warmup; w++)
+                render();
+            std::vector<double> s;
+            for (int rep = 0; rep < opt.repetitions; rep++)
+                s.push_back(render());
+            double max_abs = 0;
+            for (std::size_t t = 0; t < samples; t++)
+                max_abs = std::max(max_abs, std::abs(double(out[t]) - exact[t]));
+            results.push_back({ &e, voices, bootstrap(s, opt.bootstrap, opt.confidence), max_abs });
+        }
+    }
+    return results;
+}
+
+static inline void print_voice_header() {
+    std::cout << std::left << std::setw(34) << "NAME" << std::right << std::setw(9) << "VOICES"
+              << std::setw(10) << "NS/VS" << std::setw(10) << "CI LO" << std::setw(10) << "CI HI"
+              << std::setw(10) << "PER CORE" << std::setw(14) << "MAX ABS ERR" << std::endl;
+}
+
+static inline void print_voice_result(const voice_result& r) {
+    std::cout << std::left << std::setw(34) << r.e->name << std::right << std::setw(9) << r.voices
+              << std::fixed << std::setprecision(3)
+              << std::setw(10) << r.ns.median << std::setw(10) << r.ns.lo << std::setw(10) << r.ns.hi
+              << std::setprecision(0) << std::setw(10) << 1e9 / (r.ns.median * 48000.0)
+              << std::scientific << std::setprecision(3) << std::setw(14) << r.max_abs
+              << std::defaultfloat << std::endl;
+}
+
+} // namespace bench
+} // namespace fast
@@ -0,0 +1,108 @@
+"""
+Compares a benchmark run against a stored baseline and exits non-zero when
+any function got slower or less accurate than its threshold allows.
+
+    python bench/compare.py baseline.csv current.csv [--thresholds bench/thresholds.csv] [--allow-missing]
+
+Both files are written by `main --csv`. A slowdown only counts as a
+regression when it is both larger than the function's time_pct threshold
+and outside the noise of the two runs, ie. the bootstrap confidence interval
+of the current median (ns_lo..ns_hi) no longer overlaps the baseline's.
+Errors are deterministic, so any growth beyond error_pct is a regression.
+A function of the baseline that the current run lacks, eg. a dropped or
+renamed registration, is a regression too, unless --allow-missing is given
+for comparing a partial run such as `main --family sin`.
+
+The `bench_baseline` and `bench_regress` CMake targets wrap this script.
+"""
+
+import argparse
+import csv
+import fnmatch
+import math
+import sys
+
+
+def read_results(path):
+    with open(path, newline='') as f:
+        rows = {}
+        for row in csv.DictReader(f):
+            key = row['family'] + '/' + row['name']
+            rows[key] = {k: (v if k in ('family', 'name') else float(v)) for k, v in row.items()}
+        return rows
+
+
+def read_thresholds(path):
+    with open(path, newline='') as f:
+        lines = [l for l in f if l.strip() and not l.startswith('#')]
+    return [(r['pattern'], float(r['time_pct']), float(r['error_pct'])) for r in csv.DictReader(lines)]
+
+
+def threshold_for(key, thresholds):
+    for pattern, time_pct, error_pct in thresholds:
+        if fnmatch.fnmatchcase(key, pattern):
+            return time_pct, error_pct
+    return 10.0, 1.0
+
+
+def error_grew(base, cur, pct):
+    if math.isinf(cur) and not math.isinf(base):
+        return True
+    if math.isinf(base):
+        return False
+    # absolute slack so that a baseline of 0 doesn't flag rounding noise
+    return cur > base * (1 + pct / 100) + 1e-12
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('baseline')
+    parser.add_argument('current')
+    parser.add_argument('--thresholds', default=None)
+    parser.add_argument('--allow-missing', action='store_true',
+                        help="don't count functions missing from the current run as regressions")
+    args = parser.parse_args()
+
+    base = read_results(args.baseline)
+    cur = read_results(args.current)
+    thresholds = read_thresholds(args.thresholds) if args.thresholds else []
+
+    regressions = []
+    print(f"{'FUNCTION':44} {'BASE NS':>9} {'NS':>9} {'CHANGE':>8}  STATUS")
+    for key, c in cur.items():
+        b = base.get(key)
+        if b is None:
+            print(f"{key:44} {'':>9} {c['ns_median']:9.3f} {'':>8}  new")
+            continue
+
+        time_pct, error_pct = threshold_for(key, thresholds)
+        change = 100 * (c['ns_median'] / b['ns_median'] - 1) if b['ns_median'] > 0 else 0.0
+
+        status = []
+        if change > time_pct and c['ns_lo'] > b['ns_hi']:
+            status.append(f"SLOWER (>{time_pct:g}%)")
+        elif change < -time_pct and c['ns_hi'] < b['ns_lo']:
+            status.append("faster")
+        for col in ('max_abs_err', 'max_rel_err'):
+            if error_grew(b[col], c[col], error_pct):
+                status.append(f"{col} {b[col]:.3g} -> {c[col]:.3g}")
+
+        regressed = any(s.startswith('SLOWER') or s.startswith('max_') for s in status)
+        if regressed:
+            regressions.append(key)
+        print(f"{key:44} {b['ns_median']:9.3f} {c['ns_median']:9.3f} {change:+7.1f}%  {', '.join(status) or 'ok'}")
+
+    for key in sorted(base.keys() - cur.keys()):
+        print(f"{key:44} {base[key]['ns_median']:9.3f} {'':>9} {'':>8}  MISSING")
+        if not args.allow_missing:
+            regressions.append(key)
+
+    if regressions:
+        print(f"\n{len(regressions)} regression(s): {', '.join(regressions)}")
+        return 1
+    print("\nno regressions")
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
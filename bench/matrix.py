@@ -0,0 +1,150 @@
+"""
+Runs every compiler/flag variant of the benchmark and merges their results
+into one comparison report.
+
+    python bench/matrix.py [--out report.md] [--csv merged.csv] label=path/to/main ... [-- main args]
+
+Each label=path pair is one build of main.cpp, usually gcc-12/O3 style labels
+made by the bench_matrix CMake target. Everything after -- is passed to every
+run, eg. `-- --family exp2 --reps 21 --pin 2`.
+
+The report has one table per family: a row per function and a column per
+variant with its median ns/element. The fastest variant of each row is in
+bold, and variants within its confidence interval are marked as ties.
+A variant whose max relative error differs from the first variant's is
+flagged, since -ffast-math is free to change the results of these bit tricks.
+"""
+
+import argparse
+import csv
+import math
+import os
+import subprocess
+import sys
+import tempfile
+
+
+def read_results(path):
+    with open(path, newline='') as f:
+        return list(csv.DictReader(f))
+
+
+def geomean(values):
+    values = [v for v in values if v > 0]
+    return math.exp(sum(math.log(v) for v in values) / len(values)) if values else float('nan')
+
+
+def main():
+    argv = sys.argv[1:]
+    main_args = []
+    if '--' in argv:
+        main_args = argv[argv.index('--') + 1:]
+        argv = argv[:argv.index('--')]
+
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('variants', nargs='+', help='label=path pairs')
+    parser.add_argument('--out', default='bench_matrix.md')
+    parser.add_argument('--csv', default=None, help='also write every result, with a variant column')
+    args = parser.parse_args(argv)
+
+    variants = []
+    for v in args.variants:
+        label, _, path = v.partition('=')
+        if not path:
+            parser.error(f'expected label=path, got {v}')
+        variants.append((label, path))
+
+    results = {}  # label -> {family/name: row}
+    order = []    # function keys in the order of the first variant
+    with tempfile.TemporaryDirectory() as tmp:
+        for label, path in variants:
+            out = os.path.join(tmp, label.replace('/', '_') + '.csv')
+            print(f'running {label}: {path}', flush=True)
+            proc = subprocess.run([path, *main_args, '--csv', out], stdout=subprocess.DEVNULL)
+            if proc.returncode != 0:
+                print(f'{label} failed with exit code {proc.returncode}', file=sys.stderr)
+                return 1
+            rows = read_results(out)
+            results[label] = {r['family'] + '/' + r['name']: r for r in rows}
+            for r in rows:
+                key = r['family'] + '/' + r['name']
+                if key not in order:
+                    order.append(key)
+
+    labels = [label for label, _ in variants]
+    reference = labels[0]
+
+    if args.csv:
+        with open(args.csv, 'w', newline='') as f:
+            fields = ['variant'] + list(next(iter(results[reference].values())).keys())
+            writer = csv.DictWriter(f, fieldnames=fields, extrasaction='ignore')
+            writer.writeheader()
+            for label in labels:
+                for row in results[label].values():
+                    writer.writerow({'variant': label, **row})
+
+    lines = ['# Benchmark matrix', '']
+    lines.append(f'Median ns/element, relative speeds are against `{reference}`.')
+    lines.append('**bold** is the fastest variant of a row, `=` is within its confidence interval,')
+    lines.append('`err!` means the max relative error differs from the reference variant.')
+    lines.append('')
+
+    # summary: how each variant does over every function
+    lines.append('| variant | geomean speedup | fastest in | error changed in |')
+    lines.append('|---|---:|---:|---:|')
+    wins = {label: 0 for label in labels}
+    err_changes = {label: 0 for label in labels}
+    for key in order:
+        rows = {l: results[l][key] for l in labels if key in results[l]}
+        best = min(rows, key=lambda l: float(rows[l]['ns_median']))
+        wins[best] += 1
+        ref_err = float(rows[reference]['max_rel_err']) if reference in rows else None
+        for l, r in rows.items():
+            if ref_err is not None and not math.isclose(float(r['max_rel_err']), ref_err, rel_tol=0.01, abs_tol=1e-12):
+                err_changes[l] += 1
+    for label in labels:
+        ratios = [float(results[reference][k]['ns_median']) / float(results[label][k]['ns_median'])
+                  for k in order if k in results[label] and k in results[reference]
+                  and float(results[label][k]['ns_median']) > 0]
+        lines.append(f'| {label} | {geomean(ratios):.2f}x | {wins[label]} | {err_changes[label]} |')
+    lines.append('')
+
+    family = None
+    for key in order:
+        fam = key.split('/', 1)[0]
+        if fam != family:
+            family = fam
+            lines.append(f'## {family}')
+            lines.append('')
+            lines.append('| function | ' + ' | '.join(labels) + ' |')
+            lines.append('|---|' + '---:|' * len(labels))
+
+        rows = {l: results[l][key] for l in labels if key in results[l]}
+        best = min(rows, key=lambda l: float(rows[l]['ns_median']))
+        best_hi = float(rows[best]['ns_hi'])
+        ref_err = float(rows[reference]['max_rel_err']) if reference in rows else None
+        cells = []
+        for l in labels:
+            r = rows.get(l)
+            if r is None:
+                cells.append('')
+                continue
+            cell = f"{float(r['ns_median']):.3f}"
+            if l == best:
+                cell = f'**{cell}**'
+            elif float(r['ns_lo']) <= best_hi:
+                cell = f'={cell}'
+            if ref_err is not None and not math.isclose(float(r['max_rel_err']), ref_err, rel_tol=0.01, abs_tol=1e-12):
+                cell += f" err! {float(r['max_rel_err']):.2g}"
+            cells.append(cell)
+        lines.append(f"| {key.split('/', 1)[1]} | " + ' | '.join(cells) + ' |')
+    lines.append('')
+
+    with open(args.out, 'w') as f:
+        f.write('\n'.join(lines))
+    print(f'wrote {args.out}')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
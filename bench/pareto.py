@@ -0,0 +1,215 @@
+"""
+Speed/accuracy report: which approximations are worth keeping.
+
+    python bench/pareto.py results.csv [--out-dir report] [--error max_abs_err] [--speed throughput]
+
+results.csv is written by `main --csv`, ideally with --latency and
+--exhaustive so that every column is filled in. The `bench_report` CMake
+target does all of it.
+
+Writes report.md with a table per family, plus one <family>.svg chart each
+of error against time per element. A function is dominated when another one
+of the same family is at least as accurate and faster, or as fast and more
+accurate. Only functions compared against the same reference can dominate
+each other, and only over a domain at least as wide. Times within each
+other's confidence interval count as equally fast.
+The remaining ones are the Pareto frontier, the only sensible choices.
+
+xSPEED is worked out like the tables in graphs/*.py:
+    (stl - pass) / (function - pass)
+with pass being baseline/pass, ie. the cost of the loop itself.
+"""
+
+import argparse
+import csv
+import math
+import os
+import sys
+
+ERRORS = ('max_abs_err', 'max_rel_err', 'max_ulp_err', 'rms_abs_err')
+
+
+def read_results(path):
+    with open(path, newline='') as f:
+        rows = []
+        for row in csv.DictReader(f):
+            rows.append({k: (v if k in ('family', 'name') else float(v)) for k, v in row.items()})
+        return rows
+
+
+def speed_of(row, speed):
+    if speed == 'latency':
+        return row['lat_median'], row['lat_lo'], row['lat_hi']
+    return row['ns_median'], row['ns_lo'], row['ns_hi']
+
+
+def dominates(b, a, error, speed):
+    if b is a or b.get('ref', 0) != a.get('ref', 0):
+        return False
+    if b.get('lo', 0) > a.get('lo', 0) or b.get('hi', 0) < a.get('hi', 0):
+        return False
+    _, b_lo, b_hi = speed_of(b, speed)
+    _, a_lo, a_hi = speed_of(a, speed)
+    faster = b_hi < a_lo
+    as_fast = faster or b_lo <= a_hi
+    return (faster and b[error] <= a[error]) or (as_fast and b[error] < a[error])
+
+
+def fmt_err(v):
+    return 'inf' if math.isinf(v) else f'{v:.3g}'
+
+
+def svg_chart(family, rows, dominated_by, error, speed):
+    width, height = 760, 500
+    left, right, top, bottom = 70, 190, 30, 50
+
+    xs = [speed_of(r, speed)[0] for r in rows]
+    finite = [r[error] for r in rows if r[error] > 0 and not math.isinf(r[error])]
+    floor = min(finite) / 10 if finite else 1e-9
+    ceil = max(finite) * 10 if finite else 1.0
+
+    def yval(r):
+        e = r[error]
+        return ceil if math.isinf(e) else max(e, floor)
+
+    x0, x1 = math.floor(math.log10(max(min(xs), 1e-3))), math.ceil(math.log10(max(xs)))
+    y0, y1 = math.floor(math.log10(floor)), math.ceil(math.log10(ceil))
+    x1, y1 = max(x1, x0 + 1), max(y1, y0 + 1)
+
+    def px(v):
+        return left + (math.log10(max(v, 10 ** x0)) - x0) / (x1 - x0) * (width - left - right)
+
+    def py(v):
+        return top + (y1 - math.log10(v)) / (y1 - y0) * (height - top - bottom)
+
+    out = [f'<svg xmlns="http://www.w3.org/2000/svg" width="{width}" height="{height}" '
+           f'font-family="sans-serif" font-size="10">',
+           f'<rect width="{width}" height="{height}" fill="white"/>',
+           f'<text x="{width / 2}" y="18" text-anchor="middle" font-size="14">{family}</text>']
+
+    # decade grid
+    for d in range(x0, x1 + 1):
+        x = px(10 ** d)
+        out.append(f'<line x1="{x:.1f}" y1="{top}" x2="{x:.1f}" y2="{height - bottom}" stroke="#ddd"/>')
+        out.append(f'<text x="{x:.1f}" y="{height - bottom + 14}" text-anchor="middle">1e{d}</text>')
+    for d in range(y0, y1 + 1):
+        y = py(10 ** d)
+        out.append(f'<line x1="{left}" y1="{y:.1f}" x2="{width - right}" y2="{y:.1f}" stroke="#ddd"/>')
+        out.append(f'<text x="{left - 6}" y="{y + 3:.1f}" text-anchor="end">1e{d}</text>')
+    axis = 'latency, ns per dependent call' if speed == 'latency' else 'ns per element'
+    out.append(f'<text x="{(left + width - right) / 2}" y="{height - 12}" text-anchor="middle">{axis}</text>')
+    out.append(f'<text transform="translate(16,{(top + height - bottom) / 2}) rotate(-90)" '
+               f'text-anchor="middle">{error}</text>')
+
+    # the frontier of each reference, as a staircase from fast to accurate
+    for ref in sorted({r.get('ref', 0) for r in rows}):
+        front = sorted((r for r in rows if r.get('ref', 0) == ref and id(r) not in dominated_by),
+                       key=lambda r: speed_of(r, speed)[0])
+        points = []
+        for r in front:
+            x, y = px(speed_of(r, speed)[0]), py(yval(r))
+            if points:
+                points.append(f'{x:.1f},{points[-1].split(",")[1]}')
+            points.append(f'{x:.1f},{y:.1f}')
+        if len(points) > 1:
+            out.append(f'<polyline points="{" ".join(points)}" fill="none" stroke="#1f77b4" stroke-width="1.5"/>')
+
+    for r in rows:
+        x, y = px(speed_of(r, speed)[0]), py(yval(r))
+        if id(r) in dominated_by:
+            out.append(f'<circle cx="{x:.1f}" cy="{y:.1f}" r="3.5" fill="none" stroke="#999"/>')
+            colour = '#999'
+        else:
+            out.append(f'<circle cx="{x:.1f}" cy="{y:.1f}" r="4" fill="#1f77b4"/>')
+            colour = '#000'
+        out.append(f'<text x="{x + 6:.1f}" y="{y + 3:.1f}" fill="{colour}">{r["name"]}</text>')
+
+    out.append('</svg>')
+    return '\n'.join(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('results')
+    parser.add_argument('--out-dir', default='report')
+    parser.add_argument('--error', default='max_abs_err', choices=ERRORS, help='error axis of the frontier')
+    parser.add_argument('--speed', default='throughput', choices=('throughput', 'latency'),
+                        help='time axis of the frontier, latency needs main --latency')
+    args = parser.parse_args()
+
+    rows = read_results(args.results)
+    if not rows:
+        print(f'no results in {args.results}', file=sys.stderr)
+        return 1
+    has_latency = 'lat_median' in rows[0]
+    if args.speed == 'latency' and not has_latency:
+        parser.error('no latency columns, run main with --latency')
+
+    passthrough = next((r['ns_median'] for r in rows if r['family'] == 'baseline' and r['name'] == 'pass'), 0.0)
+
+    families = []
+    for r in rows:
+        if r['family'] not in families and r['family'] != 'baseline':
+            families.append(r['family'])
+
+    os.makedirs(args.out_dir, exist_ok=True)
+    lines = ['# Speed/accuracy report', '']
+    lines.append(f'Frontier of `{args.error}` against {args.speed}. '
+                 'Dominated functions are greyed out in the charts and name what beats them.')
+    lines.append('')
+
+    for family in families:
+        fam = [r for r in rows if r['family'] == family]
+        dominated_by = {}
+        for a in fam:
+            for b in fam:
+                if dominates(b, a, args.error, args.speed):
+                    dominated_by[id(a)] = b['name']
+                    break
+
+        stl = next((r['ns_median'] for r in fam if r['name'] == 'stl'), None)
+
+        with open(os.path.join(args.out_dir, f'{family}.svg'), 'w') as f:
+            f.write(svg_chart(family, fam, dominated_by, args.error, args.speed))
+
+        lines.append(f'## {family}')
+        lines.append('')
+        lines.append(f'![{family}]({family}.svg)')
+        lines.append('')
+        header = '| function | ns/elem | xSPEED |'
+        rule = '|---|---:|---:|'
+        if has_latency:
+            header += ' latency ns |'
+            rule += '---:|'
+        header += ' max abs | max rel | max ulp | domain | |'
+        rule += '---:|---:|---:|---|---|'
+        lines.append(header)
+        lines.append(rule)
+
+        keep = sum(1 for r in fam if id(r) not in dominated_by)
+        for r in sorted(fam, key=lambda r: (id(r) in dominated_by, r['ns_median'])):
+            name = r['name'] if id(r) in dominated_by else f"**{r['name']}**"
+            xspeed = ''
+            if stl is not None and r['ns_median'] - passthrough > 0:
+                xspeed = f"{(stl - passthrough) / (r['ns_median'] - passthrough):.2f}"
+            cells = [name, f"{r['ns_median']:.3f}", xspeed]
+            if has_latency:
+                cells.append(f"{r['lat_median']:.2f}")
+            cells += [fmt_err(r['max_abs_err']), fmt_err(r['max_rel_err']),
+                      fmt_err(r.get('max_ulp_err', math.nan)),
+                      f"[{r.get('lo', 0):g}, {r.get('hi', 0):g}]",
+                      f"dominated by {dominated_by[id(r)]}" if id(r) in dominated_by else 'frontier']
+            lines.append('| ' + ' | '.join(cells) + ' |')
+        lines.append('')
+        lines.append(f'{keep} of {len(fam)} on the frontier.')
+        lines.append('')
+
+    path = os.path.join(args.out_dir, 'report.md')
+    with open(path, 'w') as f:
+        f.write('\n'.join(lines))
+    print(f'wrote {path}')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,137 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+#include "simd.hpp"
+
+// Aligned & padded float arrays for the batch kernels.
+// Every array starts on a 64 byte boundary, a cache line & an AVX-512 vector,
+// and is followed by padding up to a multiple of 16 floats, which is a whole
+// number of simd::f32 on every instruction set. A kernel can then run its last
+// partial vector in full, reading & writing the padding, instead of falling
+// back to a scalar loop for the tail. See batch::transform.
+//   buffer::aligned   owns one array, and keeps its memory when resized smaller
+//   buffer::arena     hands out arrays from one block, reset between calls
+//   buffer::padded_span  what both hand out, & what the batch fast paths take
+
+namespace fast {
+namespace buffer {
+
+inline constexpr std::size_t alignment = 64;
+inline constexpr std::size_t lanes = alignment / sizeof(float);
+static_assert(lanes % simd::f32::size == 0, "padding must be whole vectors");
+
+constexpr std::size_t padded_size(std::size_t n) noexcept { return (n + lanes - 1) / lanes * lanes; }
+
+inline bool is_aligned(const void* p) noexcept { return reinterpret_cast<std::uintptr_t>(p) % alignment == 0; }
+
+// size floats at an aligned data, followed by padding up to padded_size(size)
+// that may be read & written. What ends up in the padding is unspecified.
+// T is float or const float
+template <typename T>
+struct padded_span {
+    T* data = nullptr;
+    std::size_t size = 0;
+
+    std::size_t padded() const noexcept { return padded_size(size); }
+    T* begin() const noexcept { return data; }
+    T* end() const noexcept { return data + size; }
+    T& operator[](std::size_t i) const noexcept { return data[i]; }
+
+    operator padded_span<const T>() const noexcept { return { data, size }; }
+};
+
+struct __free {
+    void operator()(float* p) const noexcept { ::operator delete(p, std::align_val_t(alignment)); }
+};
+
+using __memory = std::unique_ptr<float[], __free>;
+
+inline __memory __allocate(std::size_t floats) {
+    return __memory(static_cast<float*>(::operator new(floats * sizeof(float), std::align_val_t(alignment))));
+}
+
+class aligned {
+public:
+    aligned() = default;
+    explicit aligned(std::size_t n) { resize(n); }
+
+    // Reallocates only to grow, so a buffer reused across calls settles on
+    // its largest size. The contents aren't kept when it does. The padding
+    // is zeroed, so that it holds no NaNs or denormals
+    void resize(std::size_t n) {
+        if (padded_size(n) > capacity_) {
+            memory_ = __allocate(padded_size(n));
+            capacity_ = padded_size(n);
+        }
+        size_ = n;
+        std::fill(memory_.get() + n, memory_.get() + padded_size(n), 0.0f);
+    }
+
+    float* data() noexcept { return memory_.get(); }
+    const float* data() const noexcept { return memory_.get(); }
+    std::size_t size() const noexcept { return size_; }
+    std::size_t capacity() const noexcept { return capacity_; }
+    float* begin() noexcept { return data(); }
+    float* end() noexcept { return data() + size_; }
+    float& operator[](std::size_t i) noexcept { return memory_[i]; }
+    float operator[](std::size_t i) const noexcept { return memory_[i]; }
+
+    padded_span<float> span() noexcept { return { data(), size_ }; }
+    padded_span<const float> span() const noexcept { return { data(), size_ }; }
+
+private:
+    __memory memory_;
+    std::size_t size_ = 0, capacity_ = 0;
+};
+
+// Bump allocation from one block, for the scratch arrays of a call. take()
+// never fails: what doesn't fit gets its own allocation, and the next reset()
+// grows the block to hold everything taken since the last one. A call that
+// takes the same arrays every time allocates on its first call only
+class arena {
+public:
+    explicit arena(std::size_t floats = 0) { grow(padded_size(floats)); }
+
+    // valid until reset(), padding zeroed like aligned's
+    padded_span<float> take(std::size_t n) {
+        const std::size_t p = padded_size(n);
+        float* d;
+        if (used_ + p <= capacity_) {
+            d = block_.get() + used_;
+        } else {
+            overflow_.push_back(__allocate(p));
+            d = overflow_.back().get();
+        }
+        used_ += p;
+        std::fill(d + n, d + p, 0.0f);
+        return { d, n };
+    }
+
+    void reset() {
+        if (used_ > capacity_) {
+            overflow_.clear();
+            grow(used_);
+        }
+        used_ = 0;
+    }
+
+    std::size_t capacity() const noexcept { return capacity_; }
+
+private:
+    void grow(std::size_t floats) {
+        block_ = floats ? __allocate(floats) : __memory();
+        capacity_ = floats;
+    }
+
+    __memory block_;
+    std::vector<__memory> overflow_;
+    std::size_t capacity_ = 0, used_ = 0;
+};
+
+} // namespace buffer
+} // namespace fast
@@ -0,0 +1,847 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "bench.hpp"
+
+#include "activation.hpp"
+#include "batch.hpp"
+#include "buffer.hpp"
+#include "common.hpp"
+
+#include "cos.hpp"
+#include "exp.hpp"
+#include "exp2.hpp"
+#include "exp10.hpp"
+#include "guarded.hpp"
+#include "half.hpp"
+#include "interleave.hpp"
+#include "log.hpp"
+#include "log2.hpp"
+#include "log10.hpp"
+#include "oscillator.hpp"
+#include "poly.hpp"
+#include "pow.hpp"
+#include "rcp.hpp"
+#include "sin.hpp"
+#include "spectrum.hpp"
+#include "sqrt.hpp"
+#include "tan.hpp"
+#include "tanh.hpp"
+#include "tier.hpp"
+#include "wavetable.hpp"
+
+// Every approximation that gets benchmarked is registered here, once.
+// Each family shares a reference function and a default input domain. The
+// domains follow the ranges the graphs/*.py scripts plot, so the errors here
+// line up with the ones in their docstrings.
+// Kernels that take a poly:: scheme are registered once per scheme, scalar
+// and batched, as "name scheme" and "name scheme simd".
+
+namespace fast {
+namespace bench {
+
+struct family {
+    std::vector<entry>& out;
+    const char* name;
+    ref_fn reference;
+    float lo, hi;
+
+    template <auto F>
+    family& add(const char* fn_name) {
+        out.push_back({ name, fn_name, &apply<F>, &chain<F>, reference, lo, hi });
+        return *this;
+    }
+
+    // for approximations that are only valid on part of the family's domain
+    template <auto F>
+    family& add(const char* fn_name, float fn_lo, float fn_hi) {
+        out.push_back({ name, fn_name, &apply<F>, &chain<F>, reference, fn_lo, fn_hi });
+        return *this;
+    }
+
+    // K is called with simd::f32 as well as float, see batch::transform
+    template <auto K>
+    family& add_batch(const char* fn_name) {
+        out.push_back({ name, fn_name, &apply_batch<K>, &chain<K>, reference, lo, hi });
+        return *this;
+    }
+    template <auto K>
+    family& add_batch(const char* fn_name, float fn_lo, float fn_hi) {
+        out.push_back({ name, fn_name, &apply_batch<K>, &chain<K>, reference, fn_lo, fn_hi });
+        return *this;
+    }
+};
+
+inline std::vector<entry> catalogue() {
+    constexpr float pi = static_cast<float>(M_PI);
+    constexpr float halfpi = static_cast<float>(M_PI_2);
+    constexpr float quarterpi = static_cast<float>(M_PI_4);
+
+    std::vector<entry> c;
+
+    family{ c, "baseline", [](double x) { return x; }, -1.0f, 1.0f }
+        .add<[](float x) { return x; }>("pass");
+    family{ c, "baseline", [](double x) { return x * x; }, -1.0f, 1.0f }
+        .add<[](float x) { return x * x; }>("x^2");
+
+    /** RECIPROCAL */
+    // what a divide costs next to the estimate & its Newton-Raphson steps
+    family{ c, "rcp", [](double x) { return 1.0 / x; }, 0.001f, 1000.0f }
+        .add<[](float x) { return 1.0f / x; }>("div")
+        .add<rcp::approx<12, float>>("approx 12")
+        .add<rcp::approx<22, float>>("approx 22")
+        .add<rcp::approx<24, float>>("approx 24")
+        .add_batch<[](auto x) { return decltype(x)(1.0f) / x; }>("div simd")
+        .add_batch<[](auto x) { return rcp::approx<12>(x); }>("approx 12 simd")
+        .add_batch<[](auto x) { return rcp::approx<22>(x); }>("approx 22 simd")
+        .add_batch<[](auto x) { return rcp::approx<24>(x); }>("approx 24 simd")
+        .add_batch<[](auto x) { return tiered::rcp<tier::coarse>(x); }>("tiered coarse simd")
+        .add_batch<[](auto x) { return tiered::rcp<tier::medium>(x); }>("tiered medium simd")
+        .add_batch<[](auto x) { return tiered::rcp<tier::precise>(x); }>("tiered precise simd");
+
+    /** SINE */
+    family{ c, "sin", [](double x) { return std::sin(x); }, -pi, pi }
+        .add<sin::stl>("stl")
+        .add<sin::taylor<float, 5>>("taylor 5")
+        .add<sin::taylor<float, 9>>("taylor 9")
+        .add<sin::taylorN<float, 1>>("taylorN 1")
+        .add<sin::taylorN<float, 3>>("taylorN 3")
+        .add<sin::bhaskara_radians<float>>("bhaskara_radians", 0.0f, pi)
+        .add<sin::pade<float>>("pade")
+        .add<sin::pade_rcp<float, 12>>("pade rcp12")
+        .add<sin::pade_rcp<float, 22>>("pade rcp22")
+        .add<sin::pade_rcp<float, 24>>("pade rcp24")
+        .add_batch<[](auto x) { return sin::pade(x); }>("pade simd")
+        .add_batch<[](auto x) { return sin::pade_rcp<decltype(x), 22>(x); }>("pade rcp22 simd")
+        .add<sin::sin_approx<float>>("sin_approx")
+        .add<sin::slaru<float>>("slaru")
+        .add<sin::juha<float>>("juha")
+        .add<sin::juha_fmod>("juha_fmod")
+        .add<sin::mineiro>("mineiro")
+        .add<sin::mineiro_faster>("mineiro_faster")
+        .add<sin::mineiro_full>("mineiro_full")
+        .add<sin::mineiro_full_faster>("mineiro_full_faster")
+        .add<sin::njuffa<float>>("njuffa")
+        .add<sin::njuffa<float, poly::horner>>("njuffa horner")
+        .add<sin::njuffa<float, poly::estrin_fma>>("njuffa estrin_fma")
+        .add<sin::wildmagic0<float>>("wildmagic0", -halfpi, halfpi)
+        .add<sin::wildmagic1<float>>("wildmagic1", -halfpi, halfpi)
+        .add<sin::wildmagic1<float, poly::horner_fma>>("wildmagic1 horner_fma", -halfpi, halfpi)
+        .add<sin::wildmagic1<float, poly::estrin>>("wildmagic1 estrin", -halfpi, halfpi)
+        .add<sin::wildmagic1<float, poly::estrin_fma>>("wildmagic1 estrin_fma", -halfpi, halfpi)
+        .add<sin::wildmagic1<float, poly::even_odd>>("wildmagic1 even_odd", -halfpi, halfpi)
+        .add<sin::wildmagic1<float, poly::even_odd_fma>>("wildmagic1 even_odd_fma", -halfpi, halfpi)
+        .add_batch<[](auto x) { return sin::wildmagic1<decltype(x), poly::horner>(x); }>("wildmagic1 horner simd", -halfpi, halfpi)
+        .add_batch<[](auto x) { return sin::wildmagic1<decltype(x), poly::horner_fma>(x); }>("wildmagic1 horner_fma simd", -halfpi, halfpi)
+        .add_batch<[](auto x) { return sin::wildmagic1<decltype(x), poly::estrin>(x); }>("wildmagic1 estrin simd", -halfpi, halfpi)
+        .add_batch<[](auto x) { return sin::wildmagic1<decltype(x), poly::estrin_fma>(x); }>("wildmagic1 estrin_fma simd", -halfpi, halfpi)
+        .add<sin::bluemangoo>("bluemangoo")
+        .add<sin::lanceputnam_gamma>("lanceputnam_gamma")
+        .add_batch<[](auto x) { return tiered::sin<tier::coarse>(x); }>("tiered coarse simd")
+        .add_batch<[](auto x) { return tiered::sin<tier::medium>(x); }>("tiered medium simd")
+        .add_batch<[](auto x) { return tiered::sin<tier::precise>(x); }>("tiered precise simd");
+
+    /** COS */
+    family{ c, "cos", [](double x) { return std::cos(x); }, -pi, pi }
+        .add<cos::stl<float>>("stl")
+        .add<cos::pade<float>>("pade")
+        .add<cos::pade_rcp<float, 12>>("pade rcp12")
+        .add<cos::pade_rcp<float, 22>>("pade rcp22")
+        .add<cos::pade_rcp<float, 24>>("pade rcp24")
+        .add_batch<[](auto x) { return cos::pade(x); }>("pade simd")
+        .add_batch<[](auto x) { return cos::pade_rcp<decltype(x), 22>(x); }>("pade rcp22 simd")
+        .add<cos::milianw>("milianw")
+        .add<cos::milianw_precise>("milianw_precise")
+        .add<cos::juha>("juha", 0.0f, pi)
+        .add<cos::mineiro>("mineiro")
+        .add<cos::mineiro_faster>("mineiro_faster")
+        .add<cos::wildmagic0<float>>("wildmagic0", -halfpi, halfpi)
+        .add<cos::wildmagic1<float>>("wildmagic1", -halfpi, halfpi)
+        .add<cos::wildmagic1<float, poly::horner_fma>>("wildmagic1 horner_fma", -halfpi, halfpi)
+        .add<cos::wildmagic1<float, poly::estrin>>("wildmagic1 estrin", -halfpi, halfpi)
+        .add<cos::wildmagic1<float, poly::estrin_fma>>("wildmagic1 estrin_fma", -halfpi, halfpi)
+        .add<cos::wildmagic1<float, poly::even_odd>>("wildmagic1 even_odd", -halfpi, halfpi)
+        .add<cos::wildmagic1<float, poly::even_odd_fma>>("wildmagic1 even_odd_fma", -halfpi, halfpi)
+        .add_batch<[](auto x) { return cos::wildmagic1<decltype(x), poly::horner>(x); }>("wildmagic1 horner simd", -halfpi, halfpi)
+        .add_batch<[](auto x) { return cos::wildmagic1<decltype(x), poly::horner_fma>(x); }>("wildmagic1 horner_fma simd", -halfpi, halfpi)
+        .add_batch<[](auto x) { return cos::wildmagic1<decltype(x), poly::estrin>(x); }>("wildmagic1 estrin simd", -halfpi, halfpi)
+        .add_batch<[](auto x) { return cos::wildmagic1<decltype(x), poly::estrin_fma>(x); }>("wildmagic1 estrin_fma simd", -halfpi, halfpi)
+        .add_batch<[](auto x) { return tiered::cos<tier::coarse>(x); }>("tiered coarse simd")
+        .add_batch<[](auto x) { return tiered::cos<tier::medium>(x); }>("tiered medium simd")
+        .add_batch<[](auto x) { return tiered::cos<tier::precise>(x); }>("tiered precise simd");
+
+    /** TAN */
+    // tan(pi * fc / fs) for fc up to 20kHz at 44.1kHz
+    family{ c, "tan", [](double x) { return std::tan(x); }, 0.0f, 1.42f }
+        .add<tan::stl>("stl")
+        .add<tan::pade>("pade")
+        .add<tan::pade_rcp<float, 12>>("pade rcp12")
+        .add<tan::pade_rcp<float, 22>>("pade rcp22")
+        .add<tan::pade_rcp<float, 24>>("pade rcp24")
+        .add_batch<[](auto x) { return tan::pade_rcp<decltype(x), 22>(x); }>("pade rcp22 simd")
+        .add<tan::wildmagic0<float>>("wildmagic0", 0.0f, quarterpi)
+        .add<tan::wildmagic1<float>>("wildmagic1", 0.0f, quarterpi)
+        .add<tan::wildmagic1<float, poly::horner_fma>>("wildmagic1 horner_fma", 0.0f, quarterpi)
+        .add<tan::wildmagic1<float, poly::estrin>>("wildmagic1 estrin", 0.0f, quarterpi)
+        .add<tan::wildmagic1<float, poly::estrin_fma>>("wildmagic1 estrin_fma", 0.0f, quarterpi)
+        .add<tan::wildmagic1<float, poly::even_odd>>("wildmagic1 even_odd", 0.0f, quarterpi)
+        .add<tan::wildmagic1<float, poly::even_odd_fma>>("wildmagic1 even_odd_fma", 0.0f, quarterpi)
+        .add_batch<[](auto x) { return tan::wildmagic1<decltype(x), poly::horner>(x); }>("wildmagic1 horner simd", 0.0f, quarterpi)
+        .add_batch<[](auto x) { return tan::wildmagic1<decltype(x), poly::horner_fma>(x); }>("wildmagic1 horner_fma simd", 0.0f, quarterpi)
+        .add_batch<[](auto x) { return tan::wildmagic1<decltype(x), poly::estrin>(x); }>("wildmagic1 estrin simd", 0.0f, quarterpi)
+        .add_batch<[](auto x) { return tan::wildmagic1<decltype(x), poly::estrin_fma>(x); }>("wildmagic1 estrin_fma simd", 0.0f, quarterpi)
+        .add<tan::jrus_alt_denorm>("jrus_alt_denorm")
+        .add<tan::jrus_alt_denorm_rcp<float, 12>>("jrus_alt_denorm rcp12")
+        .add<tan::jrus_alt_denorm_rcp<float, 22>>("jrus_alt_denorm rcp22")
+        .add<tan::jrus_denorm>("jrus_denorm")
+        .add<tan::jrus_denorm_rcp<float, 12>>("jrus_denorm rcp12")
+        .add<tan::jrus_denorm_rcp<float, 22>>("jrus_denorm rcp22")
+        .add<tan::jrus_denorm_rcp<float, 24>>("jrus_denorm rcp24")
+        .add_batch<[](auto x) { return tan::jrus_denorm_rcp<decltype(x), 22>(x); }>("jrus_denorm rcp22 simd")
+        .add<tan::jrus_full_denorm>("jrus_full_denorm")
+        .add<tan::jrus_full_denorm_rcp<22>>("jrus_full_denorm rcp22")
+        .add<tan::kay>("kay")
+        .add<tan::kay_rcp<float, 12>>("kay rcp12")
+        .add<tan::kay_rcp<float, 22>>("kay rcp22")
+        .add<tan::kay_precise>("kay_precise")
+        .add<tan::kay_precise_rcp<float, 12>>("kay_precise rcp12")
+        .add<tan::kay_precise_rcp<float, 22>>("kay_precise rcp22")
+        .add_batch<[](auto x) { return tan::kay_precise_rcp<decltype(x), 22>(x); }>("kay_precise rcp22 simd");
+    family{ c, "tan", [](double x) { return std::tan(x * M_PI_2); }, 0.0f, 0.9f }
+        .add<tan::jrus_alt>("jrus_alt")
+        .add<tan::jrus_alt_rcp<float, 12>>("jrus_alt rcp12")
+        .add<tan::jrus_alt_rcp<float, 22>>("jrus_alt rcp22");
+
+    /** TANH */
+    family{ c, "tanh", [](double x) { return std::tanh(x); }, -4.0f, 4.0f }
+        .add<tanh::stl<float>>("stl")
+        .add<tanh::pade<float>>("pade")
+        .add<tanh::pade_rcp<float, 12>>("pade rcp12")
+        .add<tanh::pade_rcp<float, 22>>("pade rcp22")
+        .add<tanh::pade_rcp<float, 24>>("pade rcp24")
+        .add_batch<[](auto x) { return tanh::pade(x); }>("pade simd")
+        .add_batch<[](auto x) { return tanh::pade_rcp<decltype(x), 22>(x); }>("pade rcp22 simd")
+        .add<tanh::c3>("c3")
+        .add<tanh::exp_ekmett_ub>("exp_ekmett_ub")
+        .add<tanh::exp_ekmett_lb>("exp_ekmett_lb")
+        .add<tanh::exp_schraudolph>("exp_schraudolph")
+        .add<tanh::exp_mineiro>("exp_mineiro")
+        .add<tanh::exp_mineiro_faster>("exp_mineiro_faster")
+        .add_batch<[](auto x) { return tiered::tanh<tier::coarse>(x); }>("tiered coarse simd")
+        .add_batch<[](auto x) { return tiered::tanh<tier::medium>(x); }>("tiered medium simd")
+        .add_batch<[](auto x) { return tiered::tanh<tier::precise>(x); }>("tiered precise simd");
+
+    /** ACTIVATIONS */
+    family{ c, "sigmoid", [](double x) { return 1 / (1 + std::exp(-x)); }, -8.0f, 8.0f }
+        .add<sigmoid::stl<float>>("stl")
+        .add<sigmoid::exp_ekmett_ub>("exp_ekmett_ub")
+        .add<sigmoid::exp_ekmett_lb>("exp_ekmett_lb")
+        .add<sigmoid::exp_schraudolph>("exp_schraudolph")
+        .add<sigmoid::exp_mineiro>("exp_mineiro")
+        .add<sigmoid::exp_mineiro_faster>("exp_mineiro_faster")
+        .add<sigmoid::table<5, 3>>("table 32/3")
+        .add_batch<[](auto x) { return sigmoid::table<5, 3>(x); }>("table 32/3 simd");
+    family{ c, "silu", [](double x) { return x / (1 + std::exp(-x)); }, -8.0f, 8.0f }
+        .add<silu::stl<float>>("stl")
+        .add<silu::exp_ekmett_ub>("exp_ekmett_ub")
+        .add<silu::exp_ekmett_lb>("exp_ekmett_lb")
+        .add<silu::exp_schraudolph>("exp_schraudolph")
+        .add<silu::exp_mineiro>("exp_mineiro")
+        .add<silu::exp_mineiro_faster>("exp_mineiro_faster")
+        .add<silu::table<5, 3>>("table 32/3")
+        .add_batch<[](auto x) { return silu::table<5, 3>(x); }>("table 32/3 simd");
+    family{ c, "gelu", [](double x) { return 0.5 * x * (1 + std::tanh(0.7978845608028654 * (x + 0.044715 * x * x * x))); }, -5.0f, 5.0f }
+        .add<gelu::stl<float>>("stl")
+        .add<gelu::exp_ekmett_ub>("exp_ekmett_ub")
+        .add<gelu::exp_ekmett_lb>("exp_ekmett_lb")
+        .add<gelu::exp_schraudolph>("exp_schraudolph")
+        .add<gelu::exp_mineiro>("exp_mineiro")
+        .add<gelu::exp_mineiro_faster>("exp_mineiro_faster")
+        .add<gelu::table<5, 3>>("table 32/3")
+        .add_batch<[](auto x) { return gelu::table<5, 3>(x); }>("table 32/3 simd");
+
+    /** EXP */
+    family{ c, "exp", [](double x) { return std::exp(x); }, -10.0f, 10.0f }
+        .add<exp::stl<float>>("stl")
+        .add<exp::ekmett_ub>("ekmett_ub")
+        .add<exp::ekmett_lb>("ekmett_lb")
+        .add<exp::schraudolph>("schraudolph")
+        .add<exp::mineiro>("mineiro")
+        .add<exp::mineiro_faster>("mineiro_faster")
+        .add<exp::table<5, 3>>("table 32/3")
+        .add<exp::table<6, 2>>("table 64/2")
+        .add_batch<[](auto x) { return exp::table<5, 3>(x); }>("table 32/3 simd")
+        .add_batch<[](auto x) { return tiered::exp<tier::coarse>(x); }>("tiered coarse simd")
+        .add_batch<[](auto x) { return tiered::exp<tier::medium>(x); }>("tiered medium simd")
+        .add_batch<[](auto x) { return tiered::exp<tier::precise>(x); }>("tiered precise simd");
+
+    /** EXP2 */
+    // (midi - 69) / 12 for midi notes between 1Hz and 20kHz
+    family{ c, "exp2", [](double x) { return std::exp2(x); }, -8.8f, 5.6f }
+        .add<exp2::stl>("exp2")
+        .add<exp2::mineiro>("mineiro")
+        .add<exp2::mineiro_faster>("mineiro_faster")
+        .add<exp2::schraudolph>("schraudolph")
+        .add<exp2::desoras>("desoras")
+        .add<exp2::desoras_pos>("desoras_pos", 0.0f, 5.6f)
+        .add<exp2::powx_stl>("powx_stl")
+        .add<exp2::powx_ekmett_fast>("powx_ekmett_fast")
+        .add<exp2::powx_ekmett_fast_lb>("powx_ekmett_fast_lb")
+        .add<exp2::powx_ekmett_fast_ub>("powx_ekmett_fast_ub")
+        .add<exp2::powx_ekmett_fast_precise>("powx_ekmett_fast_precise")
+        .add<exp2::powx_ekmett_fast_better_precise>("powx_ekmett_fast_better_precise")
+        .add_batch<[](auto x) { return pow::const_base<2.0f>::fast(x); }>("powx_ekmett_fast simd")
+        .add_batch<[](auto x) { return pow::const_base<2.0f>::precise(x); }>("powx_ekmett_fast_precise simd")
+        .add_batch<[](auto x) { return pow::const_base<2.0f>::better_precise(x); }>("powx_ekmett_fast_better_precise simd")
+        .add<exp2::exp_stl>("exp_stl")
+        .add<exp2::exp_ekmett_ub>("exp_ekmett_ub")
+        .add<exp2::exp_schraudolph>("exp_schraudolph")
+        .add<exp2::exp_mineiro>("exp_mineiro")
+        .add<exp2::exp_mineiro_faster>("exp_mineiro_faster")
+        .add<exp2::table<5, 2>>("table 32/2")
+        .add<exp2::table<5, 3>>("table 32/3")
+        .add<exp2::table<6, 2>>("table 64/2")
+        .add<exp2::table<6, 3>>("table 64/3")
+        .add<exp2::table<7, 3, float, poly::estrin>>("table 128/3 estrin")
+        .add_batch<[](auto x) { return exp2::table<5, 3>(x); }>("table 32/3 simd")
+        .add_batch<[](auto x) { return exp2::table<6, 2>(x); }>("table 64/2 simd")
+        .add_batch<[](auto x) { return tiered::exp2<tier::coarse>(x); }>("tiered coarse simd")
+        .add_batch<[](auto x) { return tiered::exp2<tier::medium>(x); }>("tiered medium simd")
+        .add_batch<[](auto x) { return tiered::exp2<tier::precise>(x); }>("tiered precise simd");
+
+    /** EXP10 */
+    // dB * 0.05 for -84dB to +12dB
+    family{ c, "exp10", [](double x) { return std::pow(10.0, x); }, -4.2f, 0.6f }
+        .add<exp10::powx_stl>("powx_stl")
+        .add<exp10::powx_ekmett_fast>("powx_ekmett_fast")
+        .add<exp10::powx_ekmett_fast_lb>("powx_ekmett_fast_lb")
+        .add<exp10::powx_ekmett_fast_ub>("powx_ekmett_fast_ub")
+        .add<exp10::powx_ekmett_fast_precise>("powx_ekmett_fast_precise")
+        .add<exp10::powx_ekmett_fast_better_precise>("powx_ekmett_fast_better_precise")
+        .add_batch<[](auto x) { return pow::const_base<10.0f>::fast_lb(x); }>("powx_ekmett_fast_lb simd")
+        .add_batch<[](auto x) { return pow::const_base<10.0f>::precise(x); }>("powx_ekmett_fast_precise simd")
+        .add_batch<[](auto x) { return pow::const_base<10.0f>::better_precise(x); }>("powx_ekmett_fast_better_precise simd")
+        .add<exp10::exp_stl>("exp_stl")
+        .add<exp10::exp_ekmett_lb>("exp_ekmett_lb")
+        .add<exp10::exp_ekmett_ub>("exp_ekmett_ub")
+        .add<exp10::exp_schraudolph>("exp_schraudolph")
+        .add<exp10::exp_mineiro>("exp_mineiro")
+        .add<exp10::exp_mineiro_faster>("exp_mineiro_faster")
+        .add<exp10::table<5, 3>>("table 32/3")
+        .add<exp10::table<6, 2>>("table 64/2")
+        .add_batch<[](auto x) { return exp10::table<5, 3>(x); }>("table 32/3 simd")
+        .add_batch<[](auto x) { return tiered::exp10<tier::coarse>(x); }>("tiered coarse simd")
+        .add_batch<[](auto x) { return tiered::exp10<tier::medium>(x); }>("tiered medium simd")
+        .add_batch<[](auto x) { return tiered::exp10<tier::precise>(x); }>("tiered precise simd");
+
+    /** POW */
+    // x^5 & x^-3 as in waveshaping polynomials & curves
+    family{ c, "pow", [](double x) { return std::pow(x, 5.0); }, -1.5f, 1.5f }
+        .add<[](float x) { return std::pow(x, 5.0f); }>("x^5 stl")
+        .add<[](float x) { return pow::ekmett_fast_precise(x, 5.0f); }>("x^5 ekmett_fast_precise", 0.0f, 1.5f)
+        .add<pow::integer<5, float>>("x^5 integer")
+        .add_batch<[](auto x) { return pow::integer<5>(x); }>("x^5 integer simd");
+    family{ c, "pow", [](double x) { return std::pow(x, -3.0); }, 0.25f, 4.0f }
+        .add<[](float x) { return std::pow(x, -3.0f); }>("x^-3 stl")
+        .add<pow::integer<-3, float>>("x^-3 integer")
+        .add_batch<[](auto x) { return pow::integer<-3>(x); }>("x^-3 integer simd");
+    // a fractional exponent, eg. a response curve over normalised values
+    family{ c, "pow", [](double x) { return std::pow(x, 2.5); }, 0.01f, 4.0f }
+        .add<[](float x) { return std::pow(x, 2.5f); }>("x^2.5 stl")
+        .add<[](float x) { return pow::ekmett_fast_precise(x, 2.5f); }>("x^2.5 ekmett_fast_precise")
+        .add<[](float x) { return pow::ekmett_fast_better_precise(x, 2.5f); }>("x^2.5 ekmett_fast_better_precise")
+        .add<[](float x) { return pow::ladder(x, 2.5f); }>("x^2.5 ladder")
+        .add_batch<[](auto x) { return pow::ladder(x, decltype(x)(2.5f)); }>("x^2.5 ladder simd");
+
+    /** LOG */
+    // normalised frequencies, Hz / 20 for 20Hz to 20kHz
+    family{ c, "log", [](double x) { return std::log(x); }, 1.0f, 1000.0f }
+        .add<log::stl>("stl")
+        .add<log::njuffa<>>("njuffa")
+        .add<log::njuffa<poly::horner_fma>>("njuffa horner_fma")
+        .add<log::njuffa<poly::estrin_fma>>("njuffa estrin_fma")
+        .add<log::njuffa_faster<>>("njuffa_faster")
+        .add<log::njuffa_faster<poly::horner_fma>>("njuffa_faster horner_fma")
+        .add<log::njuffa_faster<poly::even_odd_fma>>("njuffa_faster even_odd_fma")
+        .add<log::ankerl32>("ankerl32")
+        .add<log::ekmett_lb>("ekmett_lb")
+        .add<log::jenkas>("jenkas")
+        .add<log::mineiro>("mineiro")
+        .add<log::mineiro_faster>("mineiro_faster")
+        .add<log::table<4, 4>>("table 16/4")
+        .add<log::table<5, 3>>("table 32/3")
+        .add_batch<[](auto x) { return log::table<4, 4>(x); }>("table 16/4 simd")
+        .add_batch<[](auto x) { return tiered::log<tier::coarse>(x); }>("tiered coarse simd")
+        .add_batch<[](auto x) { return tiered::log<tier::medium>(x); }>("tiered medium simd")
+        .add_batch<[](auto x) { return tiered::log<tier::precise>(x); }>("tiered precise simd");
+    family{ c, "log", [](double x) { return std::log1p(x); }, -0.8f, 5.0f }
+        .add<log::logNPlusOne<float>>("logNPlusOne")
+        .add<log::logNPlusOne_rcp<float, 12>>("logNPlusOne rcp12")
+        .add<log::logNPlusOne_rcp<float, 22>>("logNPlusOne rcp22")
+        .add<log::logNPlusOne_rcp<float, 24>>("logNPlusOne rcp24")
+        .add_batch<[](auto x) { return log::logNPlusOne(x); }>("logNPlusOne simd")
+        .add_batch<[](auto x) { return log::logNPlusOne_rcp<decltype(x), 22>(x); }>("logNPlusOne rcp22 simd");
+
+    /** LOG2 */
+    // Hz / 440 for 1Hz to 20kHz
+    family{ c, "log2", [](double x) { return std::log2(x); }, 0.00227f, 45.5f }
+        .add<log2::stl>("stl")
+        .add<log2::lgeoffroy>("lgeoffroy")
+        .add<log2::lgeoffroy_accurate>("lgeoffroy_accurate")
+        .add<log2::jcook>("jcook")
+        .add<log2::mineiro>("mineiro")
+        .add<log2::mineiro_faster<>>("mineiro_faster")
+        .add<log2::newton>("newton")
+        .add<log2::desoras>("desoras")
+        .add<log2::log1_njuffa>("log1_njuffa")
+        .add<log2::log1_njuffa_faster>("log1_njuffa_faster")
+        .add<log2::log1_ankerl32>("log1_ankerl32")
+        .add<log2::log1_ekmett_lb>("log1_ekmett_lb")
+        .add<log2::log1_jenkas>("log1_jenkas")
+        .add<log2::log1_mineiro_faster>("log1_mineiro_faster")
+        .add<log2::table<4, 3>>("table 16/3")
+        .add<log2::table<4, 4>>("table 16/4")
+        .add<log2::table<5, 3>>("table 32/3")
+        .add<log2::table<6, 2>>("table 64/2")
+        .add<log2::table<6, 3, float, poly::estrin>>("table 64/3 estrin")
+        .add_batch<[](auto x) { return log2::table<4, 4>(x); }>("table 16/4 simd")
+        .add_batch<[](auto x) { return log2::table<6, 3>(x); }>("table 64/3 simd")
+        .add_batch<[](auto x) { return tiered::log2<tier::coarse>(x); }>("tiered coarse simd")
+        .add_batch<[](auto x) { return tiered::log2<tier::medium>(x); }>("tiered medium simd")
+        .add_batch<[](auto x) { return tiered::log2<tier::precise>(x); }>("tiered precise simd");
+
+    /** LOG10 */
+    // gains for -84dB to +12dB
+    family{ c, "log10", [](double x) { return std::log10(x); }, 6.3e-5f, 4.0f }
+        .add<log10::stl>("stl")
+        .add<log10::jcook>("jcook")
+        .add<log10::newton>("newton")
+        .add<log10::log1_njuffa>("log1_njuffa")
+        .add<log10::log1_njuffa_faster>("log1_njuffa_faster")
+        .add<log10::log1_ankerl32>("log1_ankerl32")
+        .add<log10::log1_ekmett_ub>("log1_ekmett_ub")
+        .add<log10::log1_ekmett_lb>("log1_ekmett_lb")
+        .add<log10::log1_jenkas>("log1_jenkas")
+        .add<log10::log2_mineiro>("log2_mineiro")
+        .add<log10::log2_mineiro_faster>("log2_mineiro_faster")
+        .add<log10::table<4, 4>>("table 16/4")
+        .add<log10::table<5, 3>>("table 32/3")
+        .add_batch<[](auto x) { return log10::table<4, 4>(x); }>("table 16/4 simd")
+        .add_batch<[](auto x) { return tiered::log10<tier::coarse>(x); }>("tiered coarse simd")
+        .add_batch<[](auto x) { return tiered::log10<tier::medium>(x); }>("tiered medium simd")
+        .add_batch<[](auto x) { return tiered::log10<tier::precise>(x); }>("tiered precise simd");
+
+    /** WORKLOADS */
+    // the conversions graphs/hz_to_midi.py & graphs/gain_to_db.py time, as
+    // whole formulas so the surrounding arithmetic is part of the cost
+    // 69 + log2(Hz / 440) * 12, 1Hz to 20kHz
+    family{ c, "hz_to_midi", [](double x) { return 69.0 + std::log2(x / 440.0) * 12.0; }, 1.0f, 20000.0f }
+        .add<[](float x) { return 69.0f + log2::stl(x / 440.0f) * 12.0f; }>("stl")
+        .add<[](float x) { return 69.0f + log2::mineiro(x / 440.0f) * 12.0f; }>("mineiro")
+        .add<[](float x) { return 69.0f + log2::log1_njuffa_faster(x / 440.0f) * 12.0f; }>("log1_njuffa_faster")
+        .add<[](float x) { return 69.0f + log2::log1_jenkas(x / 440.0f) * 12.0f; }>("log1_jenkas")
+        .add<[](float x) { return 69.0f + log2::table<4, 3>(x / 440.0f) * 12.0f; }>("table 16/3")
+        .add<[](float x) { return 69.0f + log2::table<4, 4>(x / 440.0f) * 12.0f; }>("table 16/4")
+        .add_batch<[](auto x) {
+            using T = decltype(x);
+            return T(69.0f) + log2::table<4, 4>(x / T(440.0f)) * T(12.0f);
+        }>("table 16/4 simd");
+    // log10(x) * 20, -84dB to +12dB
+    family{ c, "gain_to_db", [](double x) { return std::log10(x) * 20.0; }, 6.3e-5f, 4.0f }
+        .add<[](float x) { return log10::stl(x) * 20.0f; }>("stl")
+        .add<[](float x) { return log10::log2_mineiro(x) * 20.0f; }>("log2_mineiro")
+        .add<[](float x) { return log10::log1_njuffa_faster(x) * 20.0f; }>("log1_njuffa_faster")
+        .add<[](float x) { return log10::log1_jenkas(x) * 20.0f; }>("log1_jenkas")
+        .add<[](float x) { return log10::table<4, 3>(x) * 20.0f; }>("table 16/3")
+        .add<[](float x) { return log10::table<4, 4>(x) * 20.0f; }>("table 16/4")
+        .add_batch<[](auto x) { return log10::table<4, 4>(x) * decltype(x)(20.0f); }>("table 16/4 simd");
+    // 10^(x / 20), -84dB to +12dB
+    family{ c, "db_to_gain", [](double x) { return std::pow(10.0, x / 20.0); }, -84.0f, 12.0f }
+        .add<[](float x) { return exp10::powx_stl(x * 0.05f); }>("powx_stl")
+        .add<[](float x) { return exp10::powx_ekmett_fast_lb(x * 0.05f); }>("powx_ekmett_fast_lb")
+        .add<[](float x) { return exp10::exp_schraudolph(x * 0.05f); }>("exp_schraudolph")
+        .add<[](float x) { return exp10::exp_mineiro(x * 0.05f); }>("exp_mineiro")
+        .add<[](float x) { return exp10::table(x * 0.05f); }>("table 32/3")
+        .add_batch<[](auto x) { return exp10::table(x * decltype(x)(0.05f)); }>("table 32/3 simd");
+
+    /** SQRT */
+    family{ c, "sqrt", [](double x) { return std::sqrt(x); }, 0.0f, 4.0f }
+        .add<sqrt::stl>("stl")
+        .add<sqrt::bigtailwolf>("bigtailwolf")
+        .add<sqrt::nimig18>("nimig18")
+        .add<[](float x) { return x * sqrt::quake(x); }>("quake")
+        .add<sqrt::approx<12, float>>("approx 12")
+        .add<sqrt::approx<22, float>>("approx 22")
+        .add<sqrt::approx<24, float>>("approx 24")
+        .add_batch<[](auto x) { return simd::sqrt(x); }>("stl simd")
+        .add_batch<[](auto x) { return sqrt::approx<12>(x); }>("approx 12 simd")
+        .add_batch<[](auto x) { return sqrt::approx<22>(x); }>("approx 22 simd")
+        .add_batch<[](auto x) { return sqrt::approx<24>(x); }>("approx 24 simd")
+        .add_batch<[](auto x) { return tiered::sqrt<tier::coarse>(x); }>("tiered coarse simd")
+        .add_batch<[](auto x) { return tiered::sqrt<tier::medium>(x); }>("tiered medium simd")
+        .add_batch<[](auto x) { return tiered::sqrt<tier::precise>(x); }>("tiered precise simd");
+    family{ c, "rsqrt", [](double x) { return 1.0 / std::sqrt(x); }, 0.01f, 4.0f }
+        .add<[](float x) { return 1.0f / std::sqrt(x); }>("stl")
+        .add<sqrt::quake>("quake")
+        .add<sqrt::rsqrt<12, float>>("rsqrt 12")
+        .add<sqrt::rsqrt<22, float>>("rsqrt 22")
+        .add<sqrt::rsqrt<24, float>>("rsqrt 24")
+        .add_batch<[](auto x) { return decltype(x)(1.0f) / simd::sqrt(x); }>("stl simd")
+        .add_batch<[](auto x) { return sqrt::rsqrt_newton<0>(x); }>("rsqrt_newton 0 simd")
+        .add_batch<[](auto x) { return sqrt::rsqrt<12>(x); }>("rsqrt 12 simd")
+        .add_batch<[](auto x) { return sqrt::rsqrt<22>(x); }>("rsqrt 22 simd")
+        .add_batch<[](auto x) { return sqrt::rsqrt<24>(x); }>("rsqrt 24 simd")
+        .add_batch<[](auto x) { return tiered::rsqrt<tier::coarse>(x); }>("tiered coarse simd")
+        .add_batch<[](auto x) { return tiered::rsqrt<tier::medium>(x); }>("tiered medium simd")
+        .add_batch<[](auto x) { return tiered::rsqrt<tier::precise>(x); }>("tiered precise simd");
+
+    /** GUARDED */
+    // guarded.hpp, over each kernel's domain (_in), where every vector takes the
+    // fast path, a little past it (_near), where ~2% of the inputs don't, & far
+    // past it (_wide), where most vectors have some that don't
+    for (auto [name, r] : { std::pair{ "sin_in", pi }, { "sin_near", 3.2f }, { "sin_wide", 2.0f * pi } }) {
+        family{ c, name, [](double x) { return std::sin(x); }, -r, r }
+            .add<sin::stl>("stl")
+            .add_batch<[](auto x) { return sin::pade(x); }>("pade simd")
+            .add_batch<guarded::sin_pade>("guarded pade simd");
+    }
+    for (auto [name, lo, hi] : { std::tuple{ "log1p_in", -0.8f, 5.0f }, { "log1p_near", -0.8f, 5.2f }, { "log1p_wide", -0.95f, 20.0f } }) {
+        family{ c, name, [](double x) { return std::log1p(x); }, lo, hi }
+            .add<[](float x) { return std::log1p(x); }>("stl")
+            .add_batch<[](auto x) { return log::logNPlusOne(x); }>("logNPlusOne simd")
+            .add_batch<guarded::log1p_pade>("guarded logNPlusOne simd");
+    }
+    // the outliers only go as high as 88.5, as exp(88.8) is past float's range
+    for (auto [name, lo, hi] : { std::tuple{ "exp_in", -87.0f, 88.0f }, { "exp_near", -88.5f, 88.5f }, { "exp_wide", -120.0f, 88.5f } }) {
+        family{ c, name, [](double x) { return std::exp(x); }, lo, hi }
+            .add<exp::stl<float>>("stl")
+            .add_batch<[](auto x) { return pow::const_base<2.0f>::fast_lb(x * decltype(x)(1.44269504f)); }>("schraudolph lb simd")
+            .add_batch<guarded::exp_lb>("guarded schraudolph lb simd");
+    }
+
+    return c;
+}
+
+/** BLOCKS */
+// Spectrum in dB from interleaved complex bins, floored at -140dB: the
+// stages one after another over the whole block, as most analysers do it,
+// against spectrum::power_db doing them in one pass without the sqrt
+
+inline constexpr float spectrum_floor_db = -140.0f;
+
+template <auto Log10>
+void spectrum_fused(const float* in, float* out, std::size_t n) noexcept {
+    spectrum::power_db<Log10>(in, out, n, spectrum_floor_db);
+}
+
+// |z|, then 20 log10, then the floor
+template <bool Fast>
+void spectrum_separate(const float* in, float* out, std::size_t n) noexcept {
+    if constexpr (Fast) {
+        sqrt::magnitude(in, out, n);
+        for (std::size_t i = 0; i < n; i++)
+            out[i] = 20.0f * log10::log2_mineiro(out[i]);
+    } else {
+        for (std::size_t i = 0; i < n; i++)
+            out[i] = std::sqrt(in[2 * i] * in[2 * i] + in[2 * i + 1] * in[2 * i + 1]);
+        for (std::size_t i = 0; i < n; i++)
+            out[i] = 20.0f * std::log10(out[i]);
+    }
+    for (std::size_t i = 0; i < n; i++)
+        out[i] = std::max(out[i], spectrum_floor_db);
+}
+
+inline void spectrum_reference(const float* in, double* out, std::size_t n) {
+    for (std::size_t i = 0; i < n; i++) {
+        const double re = in[2 * i], im = in[2 * i + 1];
+        out[i] = std::max(10.0 * std::log10(re * re + im * im), double(spectrum_floor_db));
+    }
+}
+
+inline void softmax_reference(const float* in, double* out, std::size_t n) {
+    const double max = *std::max_element(in, in + n);
+    double sum = 0.0;
+    for (std::size_t i = 0; i < n; i++) {
+        out[i] = std::exp(in[i] - max);
+        sum += out[i];
+    }
+    for (std::size_t i = 0; i < n; i++)
+        out[i] /= sum;
+}
+
+// Channel c of C driven by 1 + c / 2 into tanh, a saturator with its own
+// drive per channel. Over the interleaved frames in one pass, through planar
+// copies, & a scalar loop working the channel out from the index
+inline constexpr float drive(std::size_t c) noexcept { return 1.0f + 0.5f * float(c); }
+
+template <std::size_t C>
+inline constexpr auto __drive_frame = [](auto f) {
+    using T = typename decltype(f)::value_type;
+    for (std::size_t c = 0; c < C; c++)
+        f[c] = tanh::pade(f[c] * T(drive(c)));
+    return f;
+};
+
+template <std::size_t C>
+void interleaved_fused(const float* in, float* out, std::size_t n) noexcept {
+    interleaved::transform<C>(in, out, n / C, __drive_frame<C>);
+}
+
+template <std::size_t C>
+void interleaved_planar(const float* in, float* out, std::size_t n) noexcept {
+    thread_local buffer::aligned planes;
+    const std::size_t frames = n / C;
+    planes.resize(C * frames);
+    float* p[C];
+    for (std::size_t c = 0; c < C; c++)
+        p[c] = planes.data() + c * frames;
+    interleaved::split<C>(in, p, frames);
+    for (std::size_t c = 0; c < C; c++)
+        batch::transform(p[c], p[c], frames, [d = drive(c)](auto x) { return tanh::pade(x * decltype(x)(d)); });
+    interleaved::merge<C>(p, out, frames);
+}
+
+template <std::size_t C>
+void interleaved_scalar(const float* in, float* out, std::size_t n) noexcept {
+    for (std::size_t i = 0; i < n; i++)
+        out[i] = tanh::pade(in[i] * drive(i % C));
+}
+
+template <std::size_t C>
+void interleaved_reference(const float* in, double* out, std::size_t n) {
+    for (std::size_t i = 0; i < n; i++)
+        out[i] = std::tanh(double(in[i]) * drive(i % C));
+}
+
+// sigmoid of the first float of every 4, as from an array of 16 byte
+// structs. The table kernel, which only vectorises through simd::f32
+inline constexpr auto __sigmoid = [](auto x) { return sigmoid::table(x); };
+
+inline void strided_gather(const float* in, float* out, std::size_t n) noexcept {
+    strided::transform(in, 4, out, 1, n, __sigmoid);
+}
+
+inline void strided_copy(const float* in, float* out, std::size_t n) noexcept {
+    for (std::size_t i = 0; i < n; i++)
+        out[i] = in[4 * i];
+    batch::transform(out, out, n, __sigmoid);
+}
+
+inline void strided_scalar(const float* in, float* out, std::size_t n) noexcept {
+    for (std::size_t i = 0; i < n; i++)
+        out[i] = sigmoid::table(in[4 * i]);
+}
+
+inline void strided_reference(const float* in, double* out, std::size_t n) {
+    for (std::size_t i = 0; i < n; i++)
+        out[i] = 1.0 / (1.0 + std::exp(-double(in[4 * i])));
+}
+
+inline std::vector<block_entry> blocks() {
+    std::vector<block_entry> c;
+    auto spectrum = [&](const char* name, run_fn run) {
+        c.push_back({ "spectrum", name, run, &spectrum_reference, 2, -1.0f, 1.0f });
+    };
+    spectrum("separate stl", &spectrum_separate<false>);
+    spectrum("separate magnitude mineiro", &spectrum_separate<true>);
+    spectrum("fused stl", &spectrum_fused<log10::stl>);
+    spectrum("fused log2_mineiro", &spectrum_fused<log10::log2_mineiro>);
+    spectrum("fused log1_njuffa_faster", &spectrum_fused<log10::log1_njuffa_faster>);
+    spectrum("fused table simd", &spectrum_fused<[](auto x) { return log10::table(x); }>);
+
+    // logits spread over [-10, 10]. The outputs are probabilities of around
+    // 1 / n, so compare max_abs with that
+    auto softmax_entry = [&](const char* name, run_fn run) {
+        c.push_back({ "softmax", name, run, &softmax_reference, 1, -10.0f, 10.0f });
+    };
+    softmax_entry("stl", &softmax::stl);
+    softmax_entry("ekmett_lb", &softmax::apply<exp::ekmett_lb>);
+    softmax_entry("schraudolph", &softmax::apply<exp::schraudolph>);
+    softmax_entry("mineiro", &softmax::apply<exp::mineiro>);
+    softmax_entry("mineiro_faster", &softmax::apply<exp::mineiro_faster>);
+    softmax_entry("table simd", &softmax::apply<>);
+
+    // n samples, n / C frames
+    auto channels = [&]<std::size_t C>(const char* fused, const char* planar, const char* scalar) {
+        c.push_back({ "interleaved", fused, &interleaved_fused<C>, &interleaved_reference<C>, 1, -1.0f, 1.0f });
+        c.push_back({ "interleaved", planar, &interleaved_planar<C>, &interleaved_reference<C>, 1, -1.0f, 1.0f });
+        c.push_back({ "interleaved", scalar, &interleaved_scalar<C>, &interleaved_reference<C>, 1, -1.0f, 1.0f });
+    };
+    channels.template operator()<2>("2ch fused", "2ch planar", "2ch scalar");
+    channels.template operator()<4>("4ch fused", "4ch planar", "4ch scalar");
+    channels.template operator()<8>("8ch fused", "8ch planar", "8ch scalar");
+
+    auto strided_entry = [&](const char* name, run_fn run) {
+        c.push_back({ "strided", name, run, &strided_reference, 4, -8.0f, 8.0f });
+    };
+    strided_entry("strided", &strided_gather);
+    strided_entry("copy then batch", &strided_copy);
+    strided_entry("scalar", &strided_scalar);
+    return c;
+}
+
+template <auto Kernel>
+void layout_pointer(const float* in, float* out, std::size_t n) noexcept {
+    batch::transform(in, out, n, Kernel);
+}
+
+template <auto Kernel>
+void layout_padded(buffer::padded_span<const float> in, buffer::padded_span<float> out) noexcept {
+    batch::transform(in, out, Kernel);
+}
+
+template <auto Kernel>
+constexpr layout_entry layout(const char* name, float lo, float hi) noexcept {
+    return { name, &layout_pointer<Kernel>, &layout_padded<Kernel>, lo, hi };
+}
+
+// a cheap kernel, where the tail & misalignment show most, & two dearer ones
+inline std::vector<layout_entry> layouts() {
+    return {
+        layout<[](auto x) { return sqrt::approx<12>(x); }>("sqrt approx 12", 0.0f, 4.0f),
+        layout<[](auto x) { return exp::table(x); }>("exp table 32/3", -10.0f, 10.0f),
+        layout<[](auto x) { return sigmoid::table(x); }>("sigmoid table 32/3", -8.0f, 8.0f),
+    };
+}
+
+template <auto Kernel, typename T>
+void io_run(const T* in, T* out, std::size_t n) noexcept {
+    half::transform(in, out, n, Kernel);
+}
+
+template <auto Kernel>
+constexpr io_entry io(const char* name, ref_fn reference, float lo, float hi) noexcept {
+    return { name, reference, lo, hi, &io_run<Kernel, float>, &io_run<Kernel, half::f16>, &io_run<Kernel, half::bf16> };
+}
+
+// over the domains of their families. Within f16's range, so only the
+// precision differs
+inline std::vector<io_entry> io_kernels() {
+    return {
+        io<[](auto x) { return exp2::table(x); }>("exp2 table 32/3", [](double x) { return std::exp2(x); }, -8.8f, 5.6f),
+        io<[](auto x) { return log2::table(x); }>("log2 table 16/4", [](double x) { return std::log2(x); }, 0.00227f, 45.5f),
+        io<[](auto x) { return sin::pade(x); }>("sin pade", [](double x) { return std::sin(x); }, -3.14159265f, 3.14159265f),
+        io<[](auto x) { return tanh::pade(x); }>("tanh pade", [](double x) { return std::tanh(x); }, -4.0f, 4.0f),
+    };
+}
+
+template <typename Bank>
+double bank_render(const float* frequency, const float* amplitude, std::size_t partials, float* out,
+                   std::size_t samples, std::size_t block) {
+    Bank bank(partials);
+    for (std::size_t k = 0; k < partials; k++)
+        bank.set(k, frequency[k], amplitude[k]);
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t t = 0; t < samples; t += block)
+        bank.process(out + t, std::min(block, samples - t));
+    const std::chrono::duration<double, std::nano> diff = std::chrono::steady_clock::now() - start;
+    return diff.count();
+}
+
+// what the banks replace, a sin kernel per partial per sample
+template <auto Sin>
+double bank_scalar(const float* frequency, const float* amplitude, std::size_t partials, float* out,
+                   std::size_t samples, std::size_t block) {
+    std::vector<float> phase(partials, 0.0f);
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t t0 = 0; t0 < samples; t0 += block) {
+        for (std::size_t t = t0; t < std::min(t0 + block, samples); t++) {
+            float sum = 0.0f;
+            for (std::size_t k = 0; k < partials; k++) {
+                sum += amplitude[k] * Sin(6.28318531f * phase[k]);
+                phase[k] += frequency[k];
+                phase[k] -= std::nearbyint(phase[k]);
+            }
+            out[t] += sum;
+        }
+    }
+    const std::chrono::duration<double, std::nano> diff = std::chrono::steady_clock::now() - start;
+    return diff.count();
+}
+
+inline std::vector<bank_entry> banks() {
+    return {
+        { "scalar stl", &bank_scalar<sin::stl> },
+        { "scalar mineiro_full", &bank_scalar<sin::mineiro_full> },
+        { "bank tiered coarse", &bank_render<oscillator::bank<[](auto x) { return tiered::sin<tier::coarse>(x); }>> },
+        { "bank tiered medium", &bank_render<oscillator::bank<>> },
+        { "bank pade", &bank_render<oscillator::bank<[](auto x) { return sin::pade(x); }>> },
+        { "rotation_bank", &bank_render<oscillator::rotation_bank> },
+    };
+}
+
+// Band limited saws, through the wavetables & summed from tiered::sin per
+// harmonic per sample, with as many harmonics as the wavetable plays
+inline const wavetable::mipmap& saw_table() {
+    static const wavetable::mipmap table(wavetable::saw());
+    return table;
+}
+
+inline double voices_wavetable(const float* frequency, std::size_t voices, float* out, std::size_t samples,
+                               std::size_t block) {
+    std::vector<wavetable::voice> v(voices, wavetable::voice(saw_table()));
+    for (std::size_t k = 0; k < voices; k++)
+        v[k].set(frequency[k], 1.0f / float(voices));
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t t = 0; t < samples; t += block)
+        for (wavetable::voice& x : v)
+            x.process(out + t, std::min(block, samples - t));
+    const std::chrono::duration<double, std::nano> diff = std::chrono::steady_clock::now() - start;
+    return diff.count();
+}
+
+inline double voices_additive(const float* frequency, std::size_t voices, float* out, std::size_t samples,
+                              std::size_t block) {
+    const std::vector<float> h = wavetable::saw();
+    std::vector<float> phase(voices, 0.0f);
+    std::vector<std::size_t> harmonics(voices);
+    for (std::size_t k = 0; k < voices; k++)
+        harmonics[k] = wavetable::mipmap::harmonics_in(wavetable::mipmap::level(frequency[k]));
+    const float gain = 1.0f / float(voices);
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t t0 = 0; t0 < samples; t0 += block) {
+        for (std::size_t k = 0; k < voices; k++) {
+            for (std::size_t t = t0; t < std::min(t0 + block, samples); t++) {
+                float sum = 0.0f;
+                for (std::size_t m = 1; m <= harmonics[k]; m++) {
+                    const float x = float(m) * phase[k];
+                    sum += h[m - 1] * tiered::sin<tier::medium>(6.28318531f * (x - std::nearbyint(x)));
+                }
+                out[t] += gain * sum;
+                phase[k] += frequency[k];
+                phase[k] -= std::floor(phase[k]);
+            }
+        }
+    }
+    const std::chrono::duration<double, std::nano> diff = std::chrono::steady_clock::now() - start;
+    return diff.count();
+}
+
+inline void voices_reference(const float* frequency, std::size_t voices, double* out, std::size_t samples) {
+    const std::vector<float> h = wavetable::saw();
+    std::fill(out, out + samples, 0.0);
+    for (std::size_t k = 0; k < voices; k++) {
+        const std::size_t harmonics = wavetable::mipmap::harmonics_in(wavetable::mipmap::level(frequency[k]));
+        for (std::size_t t = 0; t < samples; t++) {
+            const double phase = std::fmod(double(frequency[k]) * double(t), 1.0);
+            double sum = 0.0;
+            for (std::size_t m = 1; m <= harmonics; m++)
+                sum += double(h[m - 1]) * std::sin(6.283185307179586 * std::fmod(double(m) * phase, 1.0));
+            out[t] += sum / double(voices);
+        }
+    }
+}
+
+inline std::vector<voice_entry> voice_kernels() {
+    return {
+        { "saw additive tiered sin", &voices_additive, &voices_reference },
+        { "saw wavetable", &voices_wavetable, &voices_reference },
+    };
+}
+
+} // namespace bench
+} // namespace fast
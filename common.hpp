@@ -1,9 +1,12 @@
 #pragma once
+#include <bit>
+#include <cstdint>
 #define SIGN_MASK_32 0x80000000
 
 
+// reinterprets v's bits as a D, like the unions it replaces, but usable in
+// constant expressions & without breaking strict aliasing
 template <typename T, typename D>
-D convert_type(T v) {
-    union { T a; D b; } o { v };
-    return o.b;
+constexpr D convert_type(T v) noexcept {
+    return std::bit_cast<D>(v);
 }
@@ -1,31 +1,40 @@
 #pragma once
 #include <cmath>
+#include "instrument.hpp"
 #include "sin.hpp"
 
 namespace fast {
 namespace cos {
 
 template<typename T>
-constexpr T stl(T x) noexcept { return std::cos(x); }
+constexpr T stl(T x) noexcept { FASTMATHS_PROBE(x); return std::cos(x); }
 
 // JUCE
 // https://github.com/juce-framework/JUCE/blob/master/modules/juce_dsp/maths/juce_FastMathApproximations.h
-template <typename T>
+template <typename T, typename Div = rcp::exact>
 constexpr T pade (T x) noexcept {
-    auto x2 = x * x;
-    auto numerator = -(-39251520 + x2 * (18471600 + x2 * (-1075032 + 14615 * x2)));
-    auto denominator = 39251520 + x2 * (1154160 + x2 * (16632 + x2 * 127));
-    return numerator / denominator;
+    FASTMATHS_PROBE_DOMAIN(x, -3.14159265f, 3.14159265f);
+    T x2 = x * x;
+    T numerator = -(-39251520 + x2 * (18471600 + x2 * (-1075032 + 14615 * x2)));
+    T denominator = 39251520 + x2 * (1154160 + x2 * (16632 + x2 * 127));
+    return Div::div(numerator, denominator);
 }
 
+// pade with the divide swapped for a reciprocal good to Bits bits, see rcp.hpp.
+// T can also be simd::f32
+template <typename T = float, int Bits = 22>
+constexpr T pade_rcp (T x) noexcept { return pade<T, rcp::divider<Bits>>(x); }
+
 // https://stackoverflow.com/a/28050328
 static inline float milianw(float x) noexcept {
+    FASTMATHS_PROBE(x);
     x *= 0.15915494309189535f; // 1 / 2π
     x -= 0.25f + std::floor(x + 0.25f);
     x *= 16 * (std::abs(x) - 0.5f);
     return x;
 }
 static inline float milianw_precise(float x) noexcept {
+    FASTMATHS_PROBE(x);
     x *= 0.15915494309189535f; // 1 / 2π
     x -= 0.25f + std::floor(x + 0.25f);
     x *= 16 * (std::abs(x) - 0.5f);
@@ -34,55 +43,44 @@ static inline float milianw_precise(float x) noexcept {
 }
 
 // https://stackoverflow.com/a/71674578
-static inline float juha(float x) noexcept {
-    return 4 * (0.5f - 0.31830988618f * x) * (1 - std::abs(0.5f - 0.31830988618f * x));
+constexpr float juha(float x) noexcept {
+    FASTMATHS_PROBE_DOMAIN(x, 0.0f, 3.14159265f);
+    return 4 * (0.5f - 0.31830988618f * x) * (1 - simd::abs(0.5f - 0.31830988618f * x));
 }
 
 // https://github.com/romeric/fastapprox/blob/master/fastapprox/src/fasttrig.h
-static inline float mineiro (float x) {
-    static const float halfpi = 1.5707963267948966f;
-    static const float halfpiminustwopi = -4.7123889803846899f;
+constexpr float mineiro (float x) noexcept {
+    FASTMATHS_PROBE_DOMAIN(x, -3.14159265f, 3.14159265f);
+    constexpr float halfpi = 1.5707963267948966f;
+    constexpr float halfpiminustwopi = -4.7123889803846899f;
     float offset = (x > halfpi) ? halfpiminustwopi : halfpi;
     return sin::mineiro (x + offset);
 }
 
-static inline float mineiro_faster (float x)
+constexpr float mineiro_faster (float x) noexcept
 {
-    static const float twooverpi = 0.63661977236758134f;
-    static const float p = 0.54641335845679634f;
+    FASTMATHS_PROBE_DOMAIN(x, -3.14159265f, 3.14159265f);
+    constexpr float twooverpi = 0.63661977236758134f;
+    constexpr float p = 0.54641335845679634f;
 
-    union { float f; uint32_t i; } vx = { x };
-    vx.i &= 0x7FFFFFFF;
+    const float ax = std::bit_cast<float>(std::bit_cast<uint32_t>(x) & 0x7FFFFFFF);
 
-    float qpprox = 1.0f - twooverpi * vx.f;
+    float qpprox = 1.0f - twooverpi * ax;
 
     return qpprox + p * qpprox * (1.0f - qpprox * qpprox);
 }
 
 // https://www.musicdsp.org/en/latest/Other/115-sin-cos-tan-approximation.html
-float wildmagic0 (float fAngle) noexcept {
-    float fASqr = fAngle * fAngle;
-    float fResult = 3.705e-02f;
-    fResult *= fASqr;
-    fResult -= 4.967e-01f;
-    fResult *= fASqr;
-    fResult += 1.0f;
-    return fResult;
+template <typename T = float, typename Scheme = poly::horner>
+constexpr T wildmagic0 (T fAngle) noexcept {
+    FASTMATHS_PROBE_DOMAIN(fAngle, -1.57079633f, 1.57079633f);
+    return poly::eval<Scheme>(fAngle * fAngle, 1.0f, -4.967e-01f, 3.705e-02f);
 }
-float wildmagic1 (float fAngle) noexcept {
-    float fASqr = fAngle * fAngle;
-    float fResult = -2.605e-07f;
-    fResult *= fASqr;
-    fResult += 2.47609e-05f;
-    fResult *= fASqr;
-    fResult -= 1.3888397e-03f;
-    fResult *= fASqr;
-    fResult += 4.16666418e-02f;
-    fResult *= fASqr;
-    fResult -= 4.999999963e-01f;
-    fResult *= fASqr;
-    fResult += 1.0f;
-    return fResult;
+template <typename T = float, typename Scheme = poly::horner>
+constexpr T wildmagic1 (T fAngle) noexcept {
+    FASTMATHS_PROBE_DOMAIN(fAngle, -1.57079633f, 1.57079633f);
+    return poly::eval<Scheme>(fAngle * fAngle,
+        1.0f, -4.999999963e-01f, 4.16666418e-02f, -1.3888397e-03f, 2.47609e-05f, -2.605e-07f);
 }
 
 } // namespace cos
@@ -1,56 +1,62 @@
 #pragma once
 #include "common.hpp"
+#include "exp_data.hpp"
+#include "instrument.hpp"
 
 namespace fast {
 namespace exp {
 
 template<typename T>
-constexpr T stl(T x) noexcept { return std::exp(x); }
+constexpr T stl(T x) noexcept { FASTMATHS_PROBE(x); return std::exp(x); }
 
 
 // https://github.com/ekmett/approximate/blob/master/cbits/fast.c
 /* 1065353216 + 1 */
-static inline float ekmett_ub(float a) noexcept {
-    union { float f; int x; } u;
-    u.x = (int) (12102203 * a + 1065353217);
-    return u.f;
+constexpr float ekmett_ub(float a) noexcept {
+    FASTMATHS_PROBE_DOMAIN(a, -87.0f, 88.0f);
+    return std::bit_cast<float>((int) (12102203 * a + 1065353217));
 }
 
 // https://github.com/ekmett/approximate/blob/master/cbits/fast.c
 /* 1065353216 - 722019 */
-static inline float ekmett_lb(float a) {
-  union { float f; int x; } u;
-  u.x = (int) (12102203 * a + 1064631197);
-  return u.f;
+constexpr float ekmett_lb(float a) noexcept {
+    FASTMATHS_PROBE_DOMAIN(a, -87.0f, 88.0f);
+    return std::bit_cast<float>((int) (12102203 * a + 1064631197));
 }
 
 // https://github.com/ekmett/approximate/blob/master/cbits/fast.c
 /* 1065353216 - 486411 = 1064866805 */
-static inline float schraudolph(float a) noexcept {
-  union { float f; int x; } u;
-  u.x = (int) (12102203 * a + 1064866805);
-  return u.f;
+constexpr float schraudolph(float a) noexcept {
+    FASTMATHS_PROBE_DOMAIN(a, -87.0f, 88.0f);
+    return std::bit_cast<float>((int) (12102203 * a + 1064866805));
 }
 
 // https://github.com/romeric/fastapprox/blob/master/fastapprox/src/fastexp.h
-static inline float mineiro (float x) noexcept {
+constexpr float mineiro (float x) noexcept {
+    FASTMATHS_PROBE_DOMAIN(x, -87.0f, 88.0f);
     // return exp2::mineiro (1.442695040f * p);
     float p = 1.442695040f * x;
     float offset = (p < 0) ? 1.0f : 0.0f;
     float clipp = (p < -126) ? -126.0f : p;
     int w = (int)clipp;
     float z = clipp - w + offset;
-    union { uint32_t i; float f; } v = { static_cast<uint32_t> ( (1 << 23) * (clipp + 121.2740575f + 27.7280233f / (4.84252568f - z) - 1.49012907f * z) ) };
-
-    return v.f;
+    return std::bit_cast<float>(static_cast<uint32_t> ( (1 << 23) * (clipp + 121.2740575f + 27.7280233f / (4.84252568f - z) - 1.49012907f * z) ));
 }
 
-static inline float mineiro_faster (float x) noexcept {
+constexpr float mineiro_faster (float x) noexcept {
+    FASTMATHS_PROBE_DOMAIN(x, -87.0f, 88.0f);
     // return exp2::mineiro_faster (1.442695040f * p);
     float p = 1.442695040f * x;
     float clipp = (p < -126) ? -126.0f : p;
-    union { uint32_t i; float f; } v = { static_cast<uint32_t> ( (1 << 23) * (clipp + 126.94269504f) ) };
-    return v.f;
+    return std::bit_cast<float>(static_cast<uint32_t> ( (1 << 23) * (clipp + 126.94269504f) ));
+}
+
+// Table driven, see exp_data.hpp. 2^TableBits entries and a Degree polynomial,
+// within a few ulp. T can also be simd::f32
+template <int TableBits = 5, int Degree = 3, typename T = float, typename Scheme = poly::horner>
+constexpr T table(T x) noexcept {
+    FASTMATHS_PROBE(x);
+    return exp_data::__exp2_scaled<TableBits, Degree, Scheme>(x, exp_data::log2e);
 }
 
 } // namespace exp
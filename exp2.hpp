@@ -1,79 +1,99 @@
+#pragma once
 #include "./pow.hpp"
 #include "./exp.hpp"
+#include "./exp_data.hpp"
+#include "instrument.hpp"
 // 2^x or pow(2, x)
 
 namespace fast {
 namespace exp2 {
 
-static inline float stl(float x) noexcept { return std::exp2f(x); }
+static inline float stl(float x) noexcept { FASTMATHS_PROBE(x); return std::exp2f(x); }
 
 // https://github.com/romeric/fastapprox/blob/master/fastapprox/src/fastexp.h
-static inline float mineiro (float p) noexcept {
+constexpr float mineiro (float p) noexcept {
+    FASTMATHS_PROBE_DOMAIN(p, -126.0f, 128.0f);
     float offset = (p < 0) ? 1.0f : 0.0f;
     float clipp = (p < -126) ? -126.0f : p;
     int w = (int)clipp;
     float z = clipp - w + offset;
-    union { uint32_t i; float f; } v = { static_cast<uint32_t> ( (1 << 23) * (clipp + 121.2740575f + 27.7280233f / (4.84252568f - z) - 1.49012907f * z) ) };
-
-    return v.f;
+    return std::bit_cast<float>(static_cast<uint32_t> ( (1 << 23) * (clipp + 121.2740575f + 27.7280233f / (4.84252568f - z) - 1.49012907f * z) ));
 }
 
 // https://github.com/romeric/fastapprox/blob/master/fastapprox/src/fastexp.h
-static inline float mineiro_faster (float p) noexcept {
+constexpr float mineiro_faster (float p) noexcept {
+    FASTMATHS_PROBE_DOMAIN(p, -126.0f, 128.0f);
     float clipp = (p < -126) ? -126.0f : p;
-    union { uint32_t i; float f; } v = { static_cast<uint32_t> ( (1 << 23) * (clipp + 126.94269504f) ) };
-    return v.f;
+    return std::bit_cast<float>(static_cast<uint32_t> ( (1 << 23) * (clipp + 126.94269504f) ));
+}
+
+constexpr float schraudolph(float a) noexcept {
+    FASTMATHS_PROBE_DOMAIN(a, -126.0f, 128.0f);
+    return std::bit_cast<float>((int) (8388607.888014112f * a + 1064866805));
 }
 
-static inline float schraudolph(float a) noexcept {
-    union { float f; int x; } u;
-    u.x = (int) (8388607.888014112f * a + 1064866805);
-    return u.f;
+// v with its exponent field cleared & biased_e added in its place. The
+// original does it through the high int of the double, which assumed little
+// endian
+constexpr double __set_exponent(double v, int biased_e) noexcept {
+    const uint64_t bits = std::bit_cast<uint64_t>(v);
+    const uint32_t hi = (uint32_t(bits >> 32) & ~(2047u << 20)) + (uint32_t(biased_e) << 20);
+    return std::bit_cast<double>((uint64_t(hi) << 32) | (bits & 0xffffffffu));
 }
 
 // https://www.musicdsp.org/en/latest/Other/50-base-2-exp.html
-static inline double desoras (const double val) noexcept {
+constexpr double desoras (const double val) noexcept {
+    FASTMATHS_PROBE_DOMAIN(val, -1022.0f, 1023.0f);
     int    e;
     double ret;
 
     if (val >= 0) {
         e = int (val);
         ret = val - (e - 1);
-        ((*(1 + (int *) &ret)) &= ~(2047 << 20)) += (e + 1023) << 20;
+        ret = __set_exponent(ret, e + 1023);
     }
     else {
         e = int (val + 1023);
         ret = val - (e - 1024);
-        ((*(1 + (int *) &ret)) &= ~(2047 << 20)) += e << 20;
+        ret = __set_exponent(ret, e);
     }
     return (ret);
 }
 
-static inline double desoras_pos (const double val) noexcept {
+constexpr double desoras_pos (const double val) noexcept {
+    FASTMATHS_PROBE_DOMAIN(val, 0.0f, 1023.0f);
     int    e;
     double ret;
 
     e = int (val);
     ret = val - (e - 1);
-    ((*(1 + (int *) &ret)) &= ~(2047 << 20)) += (e + 1023) << 20;
+    ret = __set_exponent(ret, e + 1023);
     return (ret);
 }
 
-static inline float powx_stl(float x) noexcept { return pow::stl(2.0f, x); }
-static inline float powx_ekmett_fast(float x) noexcept { return pow::ekmett_fast(2.0f, x); }
-static inline float powx_ekmett_fast_lb(float x) noexcept { return pow::ekmett_fast_lb(2.0f, x); }
-static inline float powx_ekmett_fast_ub(float x) noexcept { return pow::ekmett_fast_ub(2.0f, x); }
-static inline float powx_ekmett_fast_precise(float x) noexcept { return pow::ekmett_fast_precise(2.0f, x); }
-static inline float powx_ekmett_fast_better_precise(float x) noexcept { return pow::ekmett_fast_better_precise(2.0f, x); }
+static inline float powx_stl(float x) noexcept { FASTMATHS_PROBE(x); return pow::stl(2.0f, x); }
+constexpr float powx_ekmett_fast(float x) noexcept { FASTMATHS_PROBE_DOMAIN(x, -126.0f, 128.0f); return pow::const_base<2.0f>::fast(x); }
+constexpr float powx_ekmett_fast_lb(float x) noexcept { FASTMATHS_PROBE_DOMAIN(x, -126.0f, 128.0f); return pow::const_base<2.0f>::fast_lb(x); }
+constexpr float powx_ekmett_fast_ub(float x) noexcept { FASTMATHS_PROBE_DOMAIN(x, -126.0f, 128.0f); return pow::const_base<2.0f>::fast_ub(x); }
+constexpr float powx_ekmett_fast_precise(float x) noexcept { FASTMATHS_PROBE_DOMAIN(x, -126.0f, 128.0f); return pow::const_base<2.0f>::precise(x); }
+constexpr float powx_ekmett_fast_better_precise(float x) noexcept { FASTMATHS_PROBE_DOMAIN(x, -126.0f, 128.0f); return pow::const_base<2.0f>::better_precise(x); }
 
 static constexpr float ln2 = 0.693147180559945309417f;
 
-static inline float exp_stl(float x) noexcept { return exp::stl(x * ln2); }
-static inline float exp_ekmett_ub(float x) noexcept { return exp::ekmett_ub(x * ln2); }
-static inline float exp_ekmett_lb(float x) noexcept { return exp::ekmett_lb(x * ln2); }
-static inline float exp_schraudolph(float x) noexcept { return exp::schraudolph(x * ln2); }
-static inline float exp_mineiro(float x) noexcept { return exp::mineiro(x * ln2); }
-static inline float exp_mineiro_faster(float x) noexcept { return exp::mineiro_faster(x * ln2); }
+static inline float exp_stl(float x) noexcept { FASTMATHS_PROBE(x); return exp::stl(x * ln2); }
+constexpr float exp_ekmett_ub(float x) noexcept { FASTMATHS_PROBE_DOMAIN(x, -126.0f, 128.0f); return exp::ekmett_ub(x * ln2); }
+constexpr float exp_ekmett_lb(float x) noexcept { FASTMATHS_PROBE_DOMAIN(x, -126.0f, 128.0f); return exp::ekmett_lb(x * ln2); }
+constexpr float exp_schraudolph(float x) noexcept { FASTMATHS_PROBE_DOMAIN(x, -126.0f, 128.0f); return exp::schraudolph(x * ln2); }
+constexpr float exp_mineiro(float x) noexcept { FASTMATHS_PROBE_DOMAIN(x, -126.0f, 128.0f); return exp::mineiro(x * ln2); }
+constexpr float exp_mineiro_faster(float x) noexcept { FASTMATHS_PROBE_DOMAIN(x, -126.0f, 128.0f); return exp::mineiro_faster(x * ln2); }
+
+// Table driven, see exp_data.hpp. 2^TableBits entries and a Degree polynomial,
+// within a few ulp. T can also be simd::f32
+template <int TableBits = 5, int Degree = 3, typename T = float, typename Scheme = poly::horner>
+constexpr T table(T x) noexcept {
+    FASTMATHS_PROBE(x);
+    return exp_data::__exp2_core<TableBits, Degree, Scheme>(x, T(0.0f));
+}
 
 } // namespace exp2
 } // namespace fast
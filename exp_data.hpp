@@ -0,0 +1,119 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <cstdint>
+#include "poly.hpp"
+#include "simd.hpp"
+
+// Tables & the shared core of the table driven exp2/exp/exp10, in the style of
+// glibc's exp2f: https://github.com/bminor/glibc/blob/master/sysdeps/ieee754/flt-32/e_exp2f.c
+//
+//   2^x = 2^(k/N) * 2^r,  k = round(x * N),  |r| <= 1/2N
+//   2^(k/N) = 2^(k>>bits) * 2^((k%N)/N), the fraction comes from a table
+//   2^r is a short polynomial
+//
+// Table entries are the bits of 2^(j/N) with j << (23 - bits) already taken
+// off, so that adding k << (23 - bits) puts both the exponent and j back in
+// one integer add. Everything is computed at compile time.
+
+namespace fast {
+namespace exp_data {
+
+// 2^f, for building the tables. Taylor series in double, converged well
+// beyond float precision for |f| <= 1
+constexpr double __exp2_series(double f) noexcept {
+    const double y = f * 0.693147180559945309417232121458;
+    double sum = 1.0, term = 1.0;
+    for (int i = 1; i < 30; i++) {
+        term *= y / i;
+        sum += term;
+    }
+    return sum;
+}
+
+template <int Bits>
+constexpr std::array<std::int32_t, (1 << Bits)> __make_exp2_table() noexcept {
+    std::array<std::int32_t, (1 << Bits)> t{};
+    for (int j = 0; j < (1 << Bits); j++) {
+        const float v = static_cast<float>(__exp2_series(double(j) / (1 << Bits)));
+        t[j] = std::bit_cast<std::int32_t>(v) - (j << (23 - Bits));
+    }
+    return t;
+}
+
+template <int Bits>
+inline constexpr std::array<std::int32_t, (1 << Bits)> exp2_table = __make_exp2_table<Bits>();
+
+// Taylor coefficients of 2^r = e^(r ln2), ascending. |r| <= 1/64 with a 32
+// entry table, so the first dropped term is already below float precision for
+// degree 3 and around 2 ulp for degree 2
+template <int Degree>
+constexpr std::array<float, Degree + 1> __make_exp2_poly() noexcept {
+    std::array<float, Degree + 1> c{};
+    double term = 1.0;
+    for (int i = 0; i <= Degree; i++) {
+        c[i] = static_cast<float>(term);
+        term *= 0.693147180559945309417232121458 / (i + 1);
+    }
+    return c;
+}
+
+template <int Degree>
+inline constexpr std::array<float, Degree + 1> exp2_poly = __make_exp2_poly<Degree>();
+
+// log2 of a base split in two, hi with only 12 significant bits so that it
+// multiplies exactly with a 12 bit float
+struct split {
+    float hi, lo;
+};
+
+constexpr split __make_split(double v) noexcept {
+    const float hi = std::bit_cast<float>(std::bit_cast<std::uint32_t>(static_cast<float>(v)) & 0xfffff000u);
+    return { hi, static_cast<float>(v - hi) };
+}
+
+inline constexpr split log2e = __make_split(1.44269504088896340735992468100);  // log2(e)
+inline constexpr split log2_10 = __make_split(3.32192809488736234787031942949); // log2(10)
+
+// 2^(hi + lo), where lo is tiny next to hi. hi is clamped to [-126, 128 - 1/N],
+// so k stays below 128 N & the scale a finite float: results saturate at
+// FLT_MIN & 2^(128 - 1/N), just under FLT_MAX, instead of going denormal, 0
+// or inf. The clamps take NaN to -126, so NaN is selected back in at the end
+template <int Bits, int Degree, typename Scheme, typename T>
+constexpr T __exp2_core(T hi, T lo) noexcept {
+    static_assert(Bits >= 1 && Bits <= 10, "table sizes from 2 to 1024 entries");
+    using I = simd::int_t<T>;
+    constexpr float N = float(1 << Bits);
+    // round to nearest by adding 1.5 * 2^23, so the integer lands in the low
+    // mantissa bits. Read through the bits so -ffast-math can't cancel it out
+    constexpr float shift = 12582912.0f;
+
+    const T x = hi;
+    hi = simd::min(simd::max(hi, T(-126.0f)), T(128.0f - 1.0f / N));
+    const T z = hi * T(N);
+    const I k = simd::as_i32(z + T(shift)) - I(std::bit_cast<std::int32_t>(shift));
+    // exact, z and k are close
+    const T r = ((z - simd::to_f32(k)) + lo * T(N)) * T(1.0f / N);
+
+    const T p = poly::eval<Scheme>(r, exp2_poly<Degree>);
+    const I j = k & I((1 << Bits) - 1);
+    const T scale = simd::as_f32(simd::gather(exp2_table<Bits>.data(), j) + (k << (23 - Bits)));
+    return simd::select(x != x, x, scale * p);
+}
+
+// 2^(x * log2(b)) with the product carried in two parts. x is clamped first,
+// as lo grows with it & would carry huge x past the clamp on hi. NaN too
+template <int Bits, int Degree, typename Scheme, typename T>
+constexpr T __exp2_scaled(T x, split log2b) noexcept {
+    using I = simd::int_t<T>;
+    const float v = log2b.hi + log2b.lo;
+    const T c = simd::min(simd::max(x, T(-126.0f / v)), T((128.0f - 1.0f / float(1 << Bits)) / v));
+    const T xh = simd::as_f32(simd::as_i32(c) & I(-4096)); // top 12 bits
+    const T xl = c - xh;
+    const T hi = xh * T(log2b.hi); // exact
+    const T lo = xl * T(log2b.hi) + c * T(log2b.lo);
+    return simd::select(x != x, x, __exp2_core<Bits, Degree, Scheme>(hi, lo));
+}
+
+} // namespace exp_data
+} // namespace fast
@@ -0,0 +1,70 @@
+#pragma once
+#include <cmath>
+#include "log.hpp"
+#include "pow.hpp"
+#include "simd.hpp"
+#include "sin.hpp"
+
+// The cheap kernels that are only good on part of the line, made safe off it.
+// A guarded kernel runs the fast one where lo <= x <= hi & a precise one, eg.
+// the std:: function, everywhere else:
+//   batch::transform(in, out, n, guarded::sin_pade);
+//   constexpr auto k = guarded::domain(-0.8f, 5.0f,
+//       [](auto x) { return log::logNPlusOne(x); }, [](float x) { return std::log1p(x); });
+// A vector tests all its lanes at once & when they're all in the domain, the
+// usual case, costs the fast kernel plus a compare & a clamp. Otherwise the
+// lanes that aren't get the precise kernel one float at a time, so it only
+// has to take float, & the rest keep the fast results. That's cheap for rare
+// outliers & no faster than the precise kernel when most vectors have one.
+// The fast kernel sees x clamped to the domain, so the bit tricks' ints can't
+// overflow on the lanes that are thrown away. NaN goes to the precise kernel
+
+namespace fast {
+namespace guarded {
+
+template <typename Fast, typename Precise>
+struct kernel {
+    float lo, hi;
+    Fast fast;
+    Precise precise;
+
+    float operator()(float x) const noexcept { return x >= lo && x <= hi ? fast(x) : precise(x); }
+
+    simd::f32 operator()(simd::f32 x) const noexcept {
+        const simd::f32 l(lo), h(hi);
+        const simd::f32 r = fast(simd::min(simd::max(x, l), h));
+        if (simd::all((x >= l) & (x <= h)))
+            return r;
+        float xs[simd::f32::size], rs[simd::f32::size];
+        x.store(xs);
+        r.store(rs);
+        for (int i = 0; i < simd::f32::size; i++)
+            if (!(xs[i] >= lo && xs[i] <= hi))
+                rs[i] = precise(xs[i]);
+        return simd::f32::load(rs);
+    }
+};
+
+// fast for lo <= x <= hi, precise elsewhere. fast takes float & simd::f32,
+// precise only float
+template <typename Fast, typename Precise>
+constexpr kernel<Fast, Precise> domain(float lo, float hi, Fast fast, Precise precise) noexcept {
+    return { lo, hi, fast, precise };
+}
+
+// sin::pade, good within pi
+inline constexpr auto sin_pade = domain(
+    -3.14159265f, 3.14159265f, [](auto x) { return sin::pade(x); }, [](float x) { return std::sin(x); });
+
+// log::logNPlusOne, log(1 + x) for x in JUCE's -0.8 to 5
+inline constexpr auto log1p_pade = domain(
+    -0.8f, 5.0f, [](auto x) { return log::logNPlusOne(x); }, [](float x) { return std::log1p(x); });
+
+// Schraudolph's exp, tiered::exp<tier::coarse>. Its int overflows past 88 &
+// its exponent goes negative below -87
+inline constexpr auto exp_lb = domain(
+    -87.0f, 88.0f, [](auto x) { return pow::const_base<2.0f>::fast_lb(x * decltype(x)(1.44269504f)); },
+    [](float x) { return std::exp(x); });
+
+} // namespace guarded
+} // namespace fast
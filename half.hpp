@@ -0,0 +1,202 @@
+#pragma once
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include "simd.hpp"
+
+// 16 bit storage for the batch kernels: IEEE half (f16) & bfloat16 (bf16).
+// Only the loads & stores change, the kernels still compute in float. Halving
+// the bytes per element doubles the throughput of kernels that are bound by
+// memory bandwidth, at the cost of the extra rounding on the way in & out:
+//   f16   11 bit significand, 6e-8 to 65504. Converted in registers by F16C
+//         or AVX-512, or by integer arithmetic without them
+//   bf16  8 bit significand, float's range. Just the top half of a float
+// Both round to nearest even, like the hardware conversions.
+//   half::transform(in, out, n, [](auto x) { return exp2::table(x); });
+// works for any mix of float, half::f16 & half::bf16 arrays.
+
+namespace fast {
+namespace half {
+
+struct f16 {
+    std::uint16_t bits;
+};
+
+struct bf16 {
+    std::uint16_t bits;
+};
+
+/** SCALAR */
+
+constexpr float to_f32(float x) noexcept { return x; }
+
+constexpr float to_f32(f16 h) noexcept {
+    const std::uint32_t sign = std::uint32_t(h.bits & 0x8000) << 16;
+    const std::uint32_t e = (h.bits >> 10) & 0x1f, m = h.bits & 0x3ff;
+    if (e == 0x1f) // inf & NaN, quietened like vcvtph2ps does
+        return std::bit_cast<float>(sign | 0x7f800000u | (m << 13) | (m ? 0x400000u : 0u));
+    if (e == 0) { // 0 & denormals, m * 2^-24
+        const float v = float(m) * 5.9604644775390625e-8f;
+        return sign ? -v : v;
+    }
+    return std::bit_cast<float>(sign | ((e + 112) << 23) | (m << 13));
+}
+
+constexpr float to_f32(bf16 h) noexcept { return std::bit_cast<float>(std::uint32_t(h.bits) << 16); }
+
+// https://gist.github.com/rygorous/2156668, float_to_half_fast3_rtne
+constexpr f16 to_f16(float x) noexcept {
+    const std::uint32_t u = std::bit_cast<std::uint32_t>(x);
+    const std::uint16_t sign = std::uint16_t((u >> 16) & 0x8000);
+    const std::uint32_t mag = u & 0x7fffffff;
+    if (mag > 0x7f800000) // NaN, kept quiet
+        return { std::uint16_t(sign | 0x7e00) };
+    if (mag >= 0x477ff000) // rounds past 65504, inf
+        return { std::uint16_t(sign | 0x7c00) };
+    if (mag < 0x38800000) { // below 2^-14, a denormal. Adding 0.5 lines the
+        // bits up with its 2^-24 steps & rounds them in one go
+        const float a = std::bit_cast<float>(mag) + 0.5f;
+        return { std::uint16_t(sign | (std::bit_cast<std::uint32_t>(a) - 0x3f000000u)) };
+    }
+    // rebias the exponent from 127 to 15 & round to nearest even
+    const std::uint32_t r = mag + 0xc8000fffu + ((mag >> 13) & 1);
+    return { std::uint16_t(sign | (r >> 13)) };
+}
+
+constexpr bf16 to_bf16(float x) noexcept {
+    const std::uint32_t u = std::bit_cast<std::uint32_t>(x);
+    if ((u & 0x7fffffff) > 0x7f800000) // NaN, kept quiet
+        return { std::uint16_t((u >> 16) | 0x40) };
+    return { std::uint16_t((u + 0x7fff + ((u >> 16) & 1)) >> 16) };
+}
+
+// from_f32<float/f16/bf16>(x)
+template <typename T>
+constexpr T from_f32(float x) noexcept {
+    if constexpr (std::is_same_v<T, f16>) return to_f16(x);
+    else if constexpr (std::is_same_v<T, bf16>) return to_bf16(x);
+    else return x;
+}
+
+/** SIMD */
+
+inline simd::f32 load(const float* p) noexcept { return simd::f32::load(p); }
+inline void store(float* p, simd::f32 x) noexcept { x.store(p); }
+
+// The conversions in integer & float vector arithmetic, for when there's no
+// instruction for them. Bit for bit the same as the scalar ones, but for f16
+// denormals with denormals-are-zero on, where they become 0.
+// 16 bit values sit in the low half of each 32 bit lane, sign extended on the
+// way out so that a saturating pack keeps them as they are
+
+// https://gist.github.com/rygorous/2144712, half_to_float_fast5
+inline simd::f32 __f16_to_f32(simd::i32 h) noexcept {
+    using I = simd::i32;
+    const I mag = (h & I(0x7fff)) << 13;
+    const simd::f32 finite = simd::as_f32(mag) * simd::f32(0x1p112f); // rebias, denormals included
+    const I nan = simd::select(mag > I(0x0f800000), I(0x400000), I(0));
+    const I bits = simd::select(mag > I(0x0f7fffff), mag | I(0x7f800000) | nan, simd::as_i32(finite));
+    return simd::as_f32(bits | ((h & I(0x8000)) << 16));
+}
+
+inline simd::i32 __f16_bits(simd::f32 x) noexcept {
+    using I = simd::i32;
+    const I u = simd::as_i32(x);
+    const I mag = u & I(0x7fffffff);
+    const I normal = (mag + I(std::int32_t(0xc8000fffu)) + ((mag >> 13) & I(1))) >> 13;
+    const I denormal = simd::as_i32(simd::as_f32(mag) + simd::f32(0.5f)) - I(0x3f000000);
+    I r = simd::select(mag < I(0x38800000), denormal, normal);
+    r = simd::select(mag > I(0x477fefff), I(0x7c00), r);
+    r = simd::select(mag > I(0x7f800000), I(0x7e00), r);
+    r = r | ((u >> 16) & I(0x8000));
+    return (r << 16) >> 16;
+}
+
+inline simd::i32 __bf16_bits(simd::f32 x) noexcept {
+    using I = simd::i32;
+    const I i = simd::as_i32(x);
+    const I r = (i + I(0x7fff) + ((i >> 16) & I(1))) >> 16;
+    const I bits = simd::select(x != x, (i >> 16) | I(0x40), r);
+    return (bits << 16) >> 16;
+}
+
+// 16 bit values to & from the low halves of 32 bit lanes
+#if defined(FASTMATHS_SIMD_AVX512)
+inline simd::i32 __widen(const void* p) noexcept {
+    return _mm512_cvtepu16_epi32(_mm256_loadu_si256(static_cast<const __m256i*>(p)));
+}
+inline void __narrow(void* p, simd::i32 x) noexcept {
+    _mm256_storeu_si256(static_cast<__m256i*>(p), _mm512_cvtepi32_epi16(x.v));
+}
+#elif defined(FASTMATHS_SIMD_AVX2)
+inline simd::i32 __widen(const void* p) noexcept {
+    return _mm256_cvtepu16_epi32(_mm_loadu_si128(static_cast<const __m128i*>(p)));
+}
+inline void __narrow(void* p, simd::i32 x) noexcept {
+    _mm_storeu_si128(static_cast<__m128i*>(p), _mm_packs_epi32(_mm256_castsi256_si128(x.v), _mm256_extracti128_si256(x.v, 1)));
+}
+#elif defined(FASTMATHS_SIMD_SSE2)
+inline simd::i32 __widen(const void* p) noexcept {
+    return _mm_unpacklo_epi16(_mm_loadl_epi64(static_cast<const __m128i*>(p)), _mm_setzero_si128());
+}
+inline void __narrow(void* p, simd::i32 x) noexcept {
+    _mm_storel_epi64(static_cast<__m128i*>(p), _mm_packs_epi32(x.v, x.v));
+}
+#else
+inline simd::i32 __widen(const void* p) noexcept {
+    simd::i32 r;
+    for (int i = 0; i < simd::i32::size; i++)
+        r.v[i] = static_cast<const std::uint16_t*>(p)[i];
+    return r;
+}
+inline void __narrow(void* p, simd::i32 x) noexcept {
+    for (int i = 0; i < simd::i32::size; i++)
+        static_cast<std::uint16_t*>(p)[i] = static_cast<std::uint16_t>(x.v[i]);
+}
+#endif
+
+inline simd::f32 load(const bf16* p) noexcept { return simd::as_f32(__widen(p) << 16); }
+inline void store(bf16* p, simd::f32 x) noexcept { __narrow(p, __bf16_bits(x)); }
+
+#if defined(FASTMATHS_SIMD_AVX512)
+inline simd::f32 load(const f16* p) noexcept {
+    return _mm512_cvtph_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)));
+}
+inline void store(f16* p, simd::f32 x) noexcept {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), _mm512_cvtps_ph(x.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+}
+#elif defined(FASTMATHS_SIMD_AVX2) && defined(__F16C__)
+inline simd::f32 load(const f16* p) noexcept {
+    return _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+}
+inline void store(f16* p, simd::f32 x) noexcept {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm256_cvtps_ph(x.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+}
+#elif defined(FASTMATHS_SIMD_SSE2) && defined(__F16C__)
+inline simd::f32 load(const f16* p) noexcept {
+    return _mm_cvtph_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)));
+}
+inline void store(f16* p, simd::f32 x) noexcept {
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm_cvtps_ph(x.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+}
+#else
+inline simd::f32 load(const f16* p) noexcept { return __f16_to_f32(__widen(p)); }
+inline void store(f16* p, simd::f32 x) noexcept { __narrow(p, __f16_bits(x)); }
+#endif
+
+/** BATCH */
+
+// out[i] = kernel(in[i]) like batch::transform, for In & Out each one of
+// float, f16 & bf16. in and out may be the same buffer if they're the same type
+template <typename In, typename Out, typename Kernel>
+inline void transform(const In* in, Out* out, std::size_t n, Kernel&& kernel) noexcept {
+    std::size_t i = 0;
+    for (; i + simd::f32::size <= n; i += simd::f32::size)
+        store(out + i, kernel(load(in + i)));
+    for (; i < n; i++)
+        out[i] = from_f32<Out>(kernel(to_f32(in[i])));
+}
+
+} // namespace half
+} // namespace fast
@@ -0,0 +1,201 @@
+#pragma once
+#include <limits>
+#if defined(FASTMATHS_INSTRUMENT)
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <source_location>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include "simd.hpp"
+#endif
+
+// Which kernels run in a product, and on what. Built with FASTMATHS_INSTRUMENT
+// defined, every kernel counts its calls, its inputs by octave, 2^k <= |x| <
+// 2^(k+1), & the inputs outside the domain it's meant for, eg. sin::pade past
+// pi or log::jenkas with denormals. A report goes to stderr at exit, or to
+// the file named by the FASTMATHS_INSTRUMENT_REPORT environment variable:
+//   constexpr T fast::sin::pade(T) [with T = float]
+//     calls 48000  negative 50.00%  seen [-4, 3.99]  outside [-3.14159, 3.14159] 10320 (21.50%)
+//     |x|  2^-7 0.2%  2^-6 0.4% ... 2^0 25%  2^1 50%  2^2 0.1%
+// Also cmake -DFASTMATHS_INSTRUMENT=ON.
+// Without it the probes are empty & the kernels are what they were.
+// Each thread counts into its own block with plain increments, no locks or
+// atomics, & the blocks are only added up for the report. So the report
+// should be taken once the threads that call kernels are done, as it is at
+// exit. The counting makes the kernels many times slower, which is fine for
+// finding the hot ones but not for timing them. SIMD kernels count each lane
+// of their vectors, & a kernel built on another counts in both.
+// Kernels probe their main argument with
+//   FASTMATHS_PROBE(x)                  calls & octaves
+//   FASTMATHS_PROBE_DOMAIN(x, lo, hi)   and the x outside [lo, hi]
+// They are skipped during constant evaluation, so constexpr kernels stay so.
+
+#if defined(FASTMATHS_INSTRUMENT)
+
+namespace fast {
+namespace instrument {
+
+// one bucket per float exponent, 0 being 0 & denormals and 255 inf & NaN
+inline constexpr int __buckets = 256;
+
+struct __counts {
+    const char* name = nullptr;
+    float lo = 0.0f, hi = 0.0f;
+    float min = std::numeric_limits<float>::infinity(), max = -std::numeric_limits<float>::infinity();
+    std::uint64_t calls = 0, negative = 0, outside = 0;
+    std::uint64_t octaves[__buckets] = {};
+
+    void add(float x) noexcept {
+        const std::uint32_t bits = std::bit_cast<std::uint32_t>(x);
+        calls++;
+        negative += bits >> 31;
+        outside += !(x >= lo && x <= hi); // NaN is outside everything
+        octaves[(bits >> 23) & 0xff]++;
+        min = std::min(min, x);
+        max = std::max(max, x);
+    }
+
+    void merge(const __counts& o) noexcept {
+        calls += o.calls;
+        negative += o.negative;
+        outside += o.outside;
+        min = std::min(min, o.min);
+        max = std::max(max, o.max);
+        for (int i = 0; i < __buckets; i++)
+            octaves[i] += o.octaves[i];
+    }
+};
+
+// A thread's counts, keyed on the name pointer, which is the same for every
+// call from one kernel
+using __block = std::unordered_map<const char*, __counts>;
+
+struct __registry;
+inline void __report(__registry& r, std::FILE* out);
+
+// Owns every thread's block, so that the counts of threads that have ended
+// still make the report, which its destructor writes at exit
+struct __registry {
+    std::mutex lock;
+    std::vector<std::unique_ptr<__block>> blocks;
+
+    ~__registry() {
+        const char* path = std::getenv("FASTMATHS_INSTRUMENT_REPORT");
+        std::FILE* out = path ? std::fopen(path, "w") : nullptr;
+        __report(*this, out ? out : stderr);
+        if (out)
+            std::fclose(out);
+    }
+};
+
+inline __registry& __registry_instance() {
+    static __registry r;
+    return r;
+}
+
+inline __block& __thread_block() {
+    thread_local __block* block = [] {
+        __registry& r = __registry_instance();
+        std::lock_guard<std::mutex> guard(r.lock);
+        r.blocks.push_back(std::make_unique<__block>());
+        return r.blocks.back().get();
+    }();
+    return *block;
+}
+
+inline __counts& __site(const char* name, float lo, float hi) {
+    __counts& c = __thread_block()[name];
+    if (!c.name) {
+        c.name = name;
+        c.lo = lo;
+        c.hi = hi;
+    }
+    return c;
+}
+
+inline void record(const char* name, float x, float lo, float hi) { __site(name, lo, hi).add(x); }
+
+inline void record(const char* name, double x, float lo, float hi) {
+    __site(name, lo, hi).add(static_cast<float>(x));
+}
+
+inline void record(const char* name, simd::f32 x, float lo, float hi) {
+    float lanes[simd::f32::size];
+    x.store(lanes);
+    __counts& c = __site(name, lo, hi);
+    for (float l : lanes)
+        c.add(l);
+}
+
+inline void __report(__registry& r, std::FILE* out) {
+    std::map<std::string, __counts> total;
+    {
+        std::lock_guard<std::mutex> guard(r.lock);
+        for (const auto& block : r.blocks) {
+            for (const auto& [name, counts] : *block) {
+                auto [it, added] = total.try_emplace(name, counts);
+                if (!added)
+                    it->second.merge(counts);
+            }
+        }
+    }
+    if (total.empty())
+        return;
+
+    std::vector<const std::pair<const std::string, __counts>*> order;
+    for (const auto& t : total)
+        order.push_back(&t);
+    std::stable_sort(order.begin(), order.end(), [](auto a, auto b) { return a->second.calls > b->second.calls; });
+
+    std::fprintf(out, "fastmaths kernel calls\n");
+    for (const auto* t : order) {
+        const __counts& c = t->second;
+        const double n = double(c.calls);
+        std::fprintf(out, "%s\n  calls %llu  negative %.2f%%  seen [%g, %g]", t->first.c_str(),
+                     (unsigned long long)c.calls, 100.0 * double(c.negative) / n, c.min, c.max);
+        if (c.lo > -std::numeric_limits<float>::infinity() || c.hi < std::numeric_limits<float>::infinity())
+            std::fprintf(out, "  outside [%g, %g] %llu (%.2f%%)", c.lo, c.hi, (unsigned long long)c.outside,
+                         100.0 * double(c.outside) / n);
+        std::fprintf(out, "\n  |x|");
+        for (int i = 0; i < __buckets; i++) {
+            if (!c.octaves[i])
+                continue;
+            const double share = 100.0 * double(c.octaves[i]) / n;
+            if (i == 0) std::fprintf(out, "  0/denormal %.3g%%", share);
+            else if (i == __buckets - 1) std::fprintf(out, "  inf/NaN %.3g%%", share);
+            else std::fprintf(out, "  2^%d %.3g%%", i - 127, share);
+        }
+        std::fprintf(out, "\n");
+    }
+    std::fflush(out);
+}
+
+// Every kernel called so far, the most called first. The blocks aren't
+// locked while they count, so only once the other threads are done with them
+inline void report(std::FILE* out = stderr) { __report(__registry_instance(), out); }
+
+} // namespace instrument
+} // namespace fast
+
+#define FASTMATHS_PROBE_DOMAIN(x, lo, hi)                                                                    \
+    do {                                                                                                     \
+        if (!std::is_constant_evaluated())                                                                   \
+            ::fast::instrument::record(std::source_location::current().function_name(), (x), (lo), (hi));   \
+    } while (0)
+
+#else
+
+#define FASTMATHS_PROBE_DOMAIN(x, lo, hi) ((void)0)
+
+#endif
+
+#define FASTMATHS_PROBE(x) \
+    FASTMATHS_PROBE_DOMAIN(x, -std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity())
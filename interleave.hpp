@@ -0,0 +1,173 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include "batch.hpp"
+#include "buffer.hpp"
+#include "simd.hpp"
+
+// Batch kernels over data that isn't one contiguous run of floats, without
+// first copying it out to planar arrays:
+//   interleaved::transform<C>  C channels interleaved frame by frame, eg.
+//                              L R L R, for C a power of 2 up to 8. Each W
+//                              frames are loaded as C vectors, split into a
+//                              vector per channel in registers, processed &
+//                              merged back
+//   interleaved::split/merge   the same shuffles to & from planar arrays
+//   strided::transform         one float every stride, eg. a member of an
+//                              array of structs
+// The interleaved kernel takes & returns a std::array<T, C> of channels, T
+// being simd::f32 or float for the tail, so each channel can have its own
+// parameters or they can be mixed, eg. mid/side
+//   interleaved::transform<2>(in, out, frames, [](auto f) {
+//       using T = typename decltype(f)::value_type;
+//       return decltype(f){ (f[0] + f[1]) * T(0.5f), (f[0] - f[1]) * T(0.5f) };
+//   });
+
+namespace fast {
+namespace interleaved {
+
+// From C consecutive vectors of C interleaved channels to a vector per
+// channel. A 2 way split of the floats leaves channels 0, 2, 4.. interleaved
+// in the even ones & 1, 3, 5.. in the odd ones, each split again until one is
+// left. log2(C) rounds of C / 2 shuffle pairs, whatever the vector width
+template <std::size_t C>
+inline std::array<simd::f32, C> __split(const std::array<simd::f32, C>& v) noexcept {
+    if constexpr (C == 1) {
+        return v;
+    } else {
+        std::array<simd::f32, C / 2> even, odd;
+        for (std::size_t k = 0; k < C / 2; k++)
+            simd::deinterleave(v[2 * k], v[2 * k + 1], even[k], odd[k]);
+        even = __split(even);
+        odd = __split(odd);
+        std::array<simd::f32, C> r;
+        for (std::size_t k = 0; k < C / 2; k++) {
+            r[2 * k] = even[k];
+            r[2 * k + 1] = odd[k];
+        }
+        return r;
+    }
+}
+
+// the inverse of __split
+template <std::size_t C>
+inline std::array<simd::f32, C> __merge(const std::array<simd::f32, C>& channels) noexcept {
+    if constexpr (C == 1) {
+        return channels;
+    } else {
+        std::array<simd::f32, C / 2> even, odd;
+        for (std::size_t k = 0; k < C / 2; k++) {
+            even[k] = channels[2 * k];
+            odd[k] = channels[2 * k + 1];
+        }
+        even = __merge(even);
+        odd = __merge(odd);
+        std::array<simd::f32, C> r;
+        for (std::size_t k = 0; k < C / 2; k++)
+            simd::interleave(even[k], odd[k], r[2 * k], r[2 * k + 1]);
+        return r;
+    }
+}
+
+template <std::size_t C>
+inline constexpr bool __supported = C > 0 && C <= 8 && (C & (C - 1)) == 0;
+
+// out[f * C + c] = kernel(frame f)[c] for every frame. in and out may be the
+// same buffer
+template <std::size_t C, typename Kernel>
+inline void transform(const float* in, float* out, std::size_t frames, Kernel&& kernel) noexcept {
+    static_assert(__supported<C>, "1, 2, 4 or 8 channels");
+    constexpr std::size_t W = simd::f32::size;
+    std::size_t f = 0;
+    for (; f + W <= frames; f += W) {
+        std::array<simd::f32, C> v;
+        for (std::size_t c = 0; c < C; c++)
+            v[c] = simd::f32::load(in + f * C + c * W);
+        v = __merge(kernel(__split(v)));
+        for (std::size_t c = 0; c < C; c++)
+            v[c].store(out + f * C + c * W);
+    }
+    for (; f < frames; f++) {
+        std::array<float, C> x;
+        for (std::size_t c = 0; c < C; c++)
+            x[c] = in[f * C + c];
+        x = kernel(x);
+        for (std::size_t c = 0; c < C; c++)
+            out[f * C + c] = x[c];
+    }
+}
+
+// planar[c][f] = in[f * C + c]
+template <std::size_t C>
+inline void split(const float* in, float* const* planar, std::size_t frames) noexcept {
+    static_assert(__supported<C>, "1, 2, 4 or 8 channels");
+    constexpr std::size_t W = simd::f32::size;
+    std::size_t f = 0;
+    for (; f + W <= frames; f += W) {
+        std::array<simd::f32, C> v;
+        for (std::size_t c = 0; c < C; c++)
+            v[c] = simd::f32::load(in + f * C + c * W);
+        v = __split(v);
+        for (std::size_t c = 0; c < C; c++)
+            v[c].store(planar[c] + f);
+    }
+    for (; f < frames; f++)
+        for (std::size_t c = 0; c < C; c++)
+            planar[c][f] = in[f * C + c];
+}
+
+// out[f * C + c] = planar[c][f]
+template <std::size_t C>
+inline void merge(const float* const* planar, float* out, std::size_t frames) noexcept {
+    static_assert(__supported<C>, "1, 2, 4 or 8 channels");
+    constexpr std::size_t W = simd::f32::size;
+    std::size_t f = 0;
+    for (; f + W <= frames; f += W) {
+        std::array<simd::f32, C> v;
+        for (std::size_t c = 0; c < C; c++)
+            v[c] = simd::f32::load(planar[c] + f);
+        v = __merge(v);
+        for (std::size_t c = 0; c < C; c++)
+            v[c].store(out + f * C + c * W);
+    }
+    for (; f < frames; f++)
+        for (std::size_t c = 0; c < C; c++)
+            out[f * C + c] = planar[c][f];
+}
+
+} // namespace interleaved
+
+namespace strided {
+
+// out[i * out_stride] = kernel(in[i * in_stride]), strides counted in floats
+// & possibly negative. A member of an array of structs is
+//   strided::transform(&v[0].gain, sizeof(voice) / sizeof(float), ...)
+// and a single channel of interleaved audio (in + c, C, out + c, C, ...).
+// Strides of 1 are batch::transform. Otherwise the floats are copied through a
+// block on the stack, 256 at a time, & batch::transform runs on that: gathers
+// are slower than the scalar loads on most cores, & only AVX-512 has
+// scatters. in and out may be the same buffer if the strides are the same
+template <typename Kernel>
+inline void transform(const float* in, std::ptrdiff_t in_stride, float* out, std::ptrdiff_t out_stride,
+                      std::size_t n, Kernel&& kernel) noexcept {
+    if (in_stride == 1 && out_stride == 1) {
+        batch::transform(in, out, n, kernel);
+        return;
+    }
+    constexpr std::size_t block = 256;
+    alignas(buffer::alignment) float scratch[block];
+    for (std::size_t b = 0; b < n; b += block) {
+        const std::size_t m = std::min(block, n - b);
+        const float* src = in + static_cast<std::ptrdiff_t>(b) * in_stride;
+        float* dst = out + static_cast<std::ptrdiff_t>(b) * out_stride;
+        for (std::size_t i = 0; i < m; i++)
+            scratch[i] = src[static_cast<std::ptrdiff_t>(i) * in_stride];
+        batch::transform(scratch, scratch, m, kernel);
+        for (std::size_t i = 0; i < m; i++)
+            dst[static_cast<std::ptrdiff_t>(i) * out_stride] = scratch[i];
+    }
+}
+
+} // namespace strided
+} // namespace fast
@@ -1,11 +1,15 @@
 #pragma once
 #include <cmath>
 #include "common.hpp"
+#include "instrument.hpp"
+#include "log_data.hpp"
+#include "poly.hpp"
+#include "rcp.hpp"
 
 namespace fast {
 namespace log {
 
-static inline  float stl(float x) noexcept { return std::logf(x); }
+static inline  float stl(float x) noexcept { FASTMATHS_PROBE(x); return std::log(x); }
 
 // JUCE
 /** Provides a fast approximation of the function log(x+1) using a Pade approximant
@@ -13,18 +17,26 @@ static inline  float stl(float x) noexcept { return std::logf(x); }
     Note: This is an approximation which works on a limited range. You are
     advised to use input values only between -0.8 and +5 for limiting the error.
 */
-template <typename FloatType>
-static FloatType logNPlusOne (FloatType x) noexcept
+template <typename FloatType, typename Div = rcp::exact>
+constexpr FloatType logNPlusOne (FloatType x) noexcept
 {
-    auto numerator = x * (7560 + x * (15120 + x * (9870 + x * (2310 + x * 137))));
-    auto denominator = 7560 + x * (18900 + x * (16800 + x * (6300 + x * (900 + 30 * x))));
-    return numerator / denominator;
+    FASTMATHS_PROBE_DOMAIN(x, -0.8f, 5.0f);
+    FloatType numerator = x * (7560 + x * (15120 + x * (9870 + x * (2310 + x * 137))));
+    FloatType denominator = 7560 + x * (18900 + x * (16800 + x * (6300 + x * (900 + 30 * x))));
+    return Div::div(numerator, denominator);
 }
 
+// logNPlusOne with the divide swapped for a reciprocal good to Bits bits, see
+// rcp.hpp. FloatType can also be simd::f32
+template <typename FloatType = float, int Bits = 22>
+constexpr FloatType logNPlusOne_rcp (FloatType x) noexcept { return logNPlusOne<FloatType, rcp::divider<Bits>>(x); }
+
 // https://stackoverflow.com/a/39822314
 /* compute natural logarithm, maximum error 0.85089 ulps */
-static float njuffa (float a) noexcept {
-    float i, m, r, s, t;
+template <typename Scheme = poly::even_odd_fma>
+constexpr float njuffa (float a) noexcept {
+    FASTMATHS_PROBE(a);
+    float i, m, r, s;
     uint32_t e;
 
 #if PORTABLE
@@ -42,24 +54,24 @@ static float njuffa (float a) noexcept {
     }
     e = (convert_type<float, uint32_t> (a) - convert_type<float, uint32_t> (0.666666667f)) & 0xff800000;
     m = convert_type<uint32_t, float> (convert_type<float, uint32_t> (a) - e);
-    i = fmaf ((float)e, 1.19209290e-7f, i); // 0x1.0p-23
+    i = simd::fma ((float)e, 1.19209290e-7f, i); // 0x1.0p-23
 #endif // PORTABLE
     /* m in [2/3, 4/3] */
     m = m - 1.0f;
     s = m * m;
     /* Compute log1p(m) for m in [-1/3, 1/3] */
-    r =             -0.130310059f;  // -0x1.0ae000p-3
-    t =              0.140869141f;  //  0x1.208000p-3
-    r = fmaf (r, s, -0.121483512f); // -0x1.f198b2p-4
-    t = fmaf (t, s,  0.139814854f); //  0x1.1e5740p-3
-    r = fmaf (r, s, -0.166846126f); // -0x1.55b36cp-3
-    t = fmaf (t, s,  0.200120345f); //  0x1.99d8b2p-3
-    r = fmaf (r, s, -0.249996200f); // -0x1.fffe02p-3
-    r = fmaf (t, m, r);
-    r = fmaf (r, m,  0.333331972f); //  0x1.5554fap-2
-    r = fmaf (r, m, -0.500000000f); // -0x1.000000p-1
-    r = fmaf (r, s, m);
-    r = fmaf (i,  0.693147182f, r); //  0x1.62e430p-1 // log(2)
+    r = poly::eval<Scheme> (m,
+        -0.249996200f,  // -0x1.fffe02p-3
+         0.200120345f,  //  0x1.99d8b2p-3
+        -0.166846126f,  // -0x1.55b36cp-3
+         0.139814854f,  //  0x1.1e5740p-3
+        -0.121483512f,  // -0x1.f198b2p-4
+         0.140869141f,  //  0x1.208000p-3
+        -0.130310059f); // -0x1.0ae000p-3
+    r = simd::fma (r, m,  0.333331972f); //  0x1.5554fap-2
+    r = simd::fma (r, m, -0.500000000f); // -0x1.000000p-1
+    r = simd::fma (r, s, m);
+    r = simd::fma (i,  0.693147182f, r); //  0x1.62e430p-1 // log(2)
     if (!((a > 0.0f) && (a < INFINITY))) {
         r = a + a;  // silence NaNs if necessary
         if (a  < 0.0f) r = INFINITY - INFINITY; //  NaN
@@ -70,8 +82,10 @@ static float njuffa (float a) noexcept {
 
 // https://stackoverflow.com/a/39822314
 /* natural log on [0x1.f7a5ecp-127, 0x1.fffffep127]. Maximum relative error 9.4529e-5 */
-float njuffa_faster (float a) noexcept {
-    float m, r, s, t, i, f;
+template <typename Scheme = poly::estrin_fma>
+constexpr float njuffa_faster (float a) noexcept {
+    FASTMATHS_PROBE_DOMAIN(a, 0x1p-126f, 0x1.fffffep127f);
+    float m, r, s, i, f;
     uint32_t e;
 
     e = (convert_type<float, uint32_t> (a) - 0x3f2aaaab) & 0xff800000;
@@ -81,48 +95,52 @@ float njuffa_faster (float a) noexcept {
     f = m - 1.0f;
     s = f * f;
     /* Compute log1p(f) for f in [-1/3, 1/3] */
-    r = fmaf (0.230836749f, f, -0.279208571f); // 0x1.d8c0f0p-3, -0x1.1de8dap-2
-    t = fmaf (0.331826031f, f, -0.498910338f); // 0x1.53ca34p-2, -0x1.fee25ap-2
-    r = fmaf (r, s, t);
-    r = fmaf (r, s, f);
-    r = fmaf (i, 0.693147182f, r); // 0x1.62e430p-1 // log(2)
+    r = poly::eval<Scheme> (f,
+        -0.498910338f,  // -0x1.fee25ap-2
+         0.331826031f,  //  0x1.53ca34p-2
+        -0.279208571f,  // -0x1.1de8dap-2
+         0.230836749f); //  0x1.d8c0f0p-3
+    r = simd::fma (r, s, f);
+    r = simd::fma (i, 0.693147182f, r); // 0x1.62e430p-1 // log(2)
     return r;
 }
 
 // https://github.com/ekmett/approximate/blob/master/cbits/fast.c
 /* Ankerl's inversion of Schraudolph's published algorithm, converted to explicit multiplication */
-static inline double ankerl64(double a) noexcept {
-    union { double d; int x[2]; } u = { a };
-    return (u.x[1] - 1072632447) * 6.610368362777016e-7; /* 1 / 1512775.0; */
+constexpr double ankerl64(double a) noexcept {
+    FASTMATHS_PROBE_DOMAIN(a, 0x1p-126f, 0x1.fffffep127f);
+    const int hi = int(std::bit_cast<uint64_t>(a) >> 32);
+    return (hi - 1072632447) * 6.610368362777016e-7; /* 1 / 1512775.0; */
 }
 
 // https://martin.ankerl.com/2007/10/04/optimized-pow-approximation-for-java-and-c-c/
 // https://github.com/ekmett/approximate/blob/master/cbits/fast.c
 /* 1065353216 - 486411 = 1064866805 */
-static inline float ankerl32(float a) noexcept {
-    union { float f; int x; } u = { a };
-    return (u.x - 1064866805) * 8.262958405176314e-8f; /* 1 / 12102203.0; */
+constexpr float ankerl32(float a) noexcept {
+    FASTMATHS_PROBE_DOMAIN(a, 0x1p-126f, 0x1.fffffep127f);
+    return (std::bit_cast<int>(a) - 1064866805) * 8.262958405176314e-8f; /* 1 / 12102203.0; */
 }
 
 // https://github.com/ekmett/approximate/blob/master/cbits/fast.c
 /* 1065353216 - 722019 */
-static inline float ekmett_ub(float a) {
-  union { float f; int x; } u = { a };
-  return (u.x - 1064631197) * 8.262958405176314e-8f; /* 1 / 12102203.0; */
+constexpr float ekmett_ub(float a) noexcept {
+    FASTMATHS_PROBE_DOMAIN(a, 0x1p-126f, 0x1.fffffep127f);
+    return (std::bit_cast<int>(a) - 1064631197) * 8.262958405176314e-8f; /* 1 / 12102203.0; */
 }
 
 // https://github.com/ekmett/approximate/blob/master/cbits/fast.c
 /* 1065353216 + 1 */
-static inline float ekmett_lb(float a) noexcept {
-    union { float f; int x; } u = { a };
-    return (u.x - 1065353217) * 8.262958405176314e-8f; /* 1 / 12102203.0 */
+constexpr float ekmett_lb(float a) noexcept {
+    FASTMATHS_PROBE_DOMAIN(a, 0x1p-126f, 0x1.fffffep127f);
+    return (std::bit_cast<int>(a) - 1065353217) * 8.262958405176314e-8f; /* 1 / 12102203.0 */
 }
 
 // https://stackoverflow.com/a/74585982
 // assumes x > 0 and that it's not a subnormal.
 // Results for 0 or negative x won't be -Infinity or NaN
-inline float jenkas(float x)
+constexpr float jenkas(float x) noexcept
 {
+    FASTMATHS_PROBE_DOMAIN(x, 0x1p-126f, 0x1.fffffep127f);
     //fast_log abs(rel) : avgError = 2.85911e-06(3.32628e-08), MSE = 4.67298e-06(5.31012e-08), maxError = 1.52588e-05(1.7611e-07)
     const float s_log_C0 = -19.645704f;
     const float s_log_C1 = 0.767002f;
@@ -131,13 +149,11 @@ inline float jenkas(float x)
     const float s_log_C4 = -(1.0f + s_log_C0) * (1.0f + s_log_C1) / ((1.0f + s_log_C2) * (1.0f + s_log_C3)); //ensures that log(1) == 0
     const float s_log_2 = 0.6931472f;
 
-    // uint32_t ux = std::bit_cast<uint32_t, float>(x);
-    union { float f; uint32_t i; } ux = { x };
-    int e = static_cast<int>(ux.i - 0x3f800000) >> 23; //e = exponent part can be negative
-    ux.i |= 0x3f800000;
-    ux.i &= 0x3fffffff; // 1 <= x < 2  after replacing the exponent field
-    // x = std::bit_cast<float, uint32_t>(ux);
-    x = ux.f;
+    uint32_t ux = std::bit_cast<uint32_t>(x);
+    int e = static_cast<int>(ux - 0x3f800000) >> 23; //e = exponent part can be negative
+    ux |= 0x3f800000;
+    ux &= 0x3fffffff; // 1 <= x < 2  after replacing the exponent field
+    x = std::bit_cast<float>(ux);
     float a = (x + s_log_C0) * (x + s_log_C1);
     float b = (x + s_log_C2) * (x + s_log_C3);
     float c = (float(e) + s_log_C4);
@@ -147,25 +163,34 @@ inline float jenkas(float x)
 
 // https://github.com/romeric/fastapprox/blob/master/fastapprox/src/fastlog.h
 constexpr float mineiro (float x) noexcept {
-    union { float f; uint32_t i; } vx = { x };
-    union { uint32_t i; float f; } mx = { (vx.i & 0x007FFFFF) | 0x3f000000 };
-    float y = vx.i;
+    FASTMATHS_PROBE_DOMAIN(x, 0x1p-126f, 0x1.fffffep127f);
+    const uint32_t vx = std::bit_cast<uint32_t>(x);
+    const float mx = std::bit_cast<float>((vx & 0x007FFFFF) | 0x3f000000);
+    float y = vx;
     y *= 1.1920928955078125e-7f;
 
     float log2_x = y - 124.22551499f
-                     - 1.498030302f * mx.f
-                     - 1.72587999f / (0.3520887068f + mx.f);
+                     - 1.498030302f * mx
+                     - 1.72587999f / (0.3520887068f + mx);
 
     return 0.69314718f * log2_x;
 }
 
 constexpr float mineiro_faster (float x) noexcept {
+    FASTMATHS_PROBE_DOMAIN(x, 0x1p-126f, 0x1.fffffep127f);
     //  return 0.69314718f * mineiro (x);
-    union { float f; uint32_t i; } vx = { x };
-    float y = vx.i;
+    float y = std::bit_cast<uint32_t>(x);
     y *= 8.2629582881927490e-8f;
     return y - 87.989971088f;
 }
 
+// Table driven, see log_data.hpp. 2^TableBits entries and a Degree polynomial,
+// within a few ulp for positive normal x. T can also be simd::f32
+template <int TableBits = 4, int Degree = 4, typename T = float, typename Scheme = poly::horner>
+constexpr T table(T x) noexcept {
+    FASTMATHS_PROBE_DOMAIN(x, 0x1p-126f, 0x1.fffffep127f);
+    return log_data::__log_core<TableBits, Degree, Scheme, 0.693147180559945309417232121458>(x);
+}
+
 } // namespace log
 } // namespace fast
@@ -1,14 +1,15 @@
 #pragma once
 
 #include "log.hpp"
+#include "instrument.hpp"
 
 namespace fast {
 namespace log10 {
 
-static inline float stl(float x) noexcept { return std::log10f(x); }
+static inline float stl(float x) noexcept { FASTMATHS_PROBE(x); return std::log10(x); }
 
 // https://www.johndcook.com/blog/2021/03/24/log10-trick/
-constexpr float jcook(float x) noexcept { return (x - 1) / (x + 1); }
+constexpr float jcook(float x) noexcept { FASTMATHS_PROBE(x); return (x - 1) / (x + 1); }
 
 // https://stackoverflow.com/a/41416894
 constexpr float __newton_next(float r, float x) noexcept {
@@ -29,8 +30,9 @@ constexpr float __newton_log2(float x) noexcept {
     return r2;
 }
 
-static inline float newton(float x) noexcept {
-    static float log2_10 = __newton_log2(10);
+constexpr float newton(float x) noexcept {
+    FASTMATHS_PROBE(x);
+    constexpr float log2_10 = __newton_log2(10);
     return __newton_log2(x) / log2_10;
 }
 
@@ -40,39 +42,48 @@ static inline float newton(float x) noexcept {
 // 1 / log10(e)
 static constexpr float log10e = 0.434294481903251827651f;
 
-static inline float log1_njuffa(float x) noexcept { return log::njuffa(x) * log10e; }
-static inline float log1_njuffa_faster(float x) noexcept { return log::njuffa_faster(x) * log10e; }
+constexpr float log1_njuffa(float x) noexcept { FASTMATHS_PROBE(x); return log::njuffa(x) * log10e; }
+constexpr float log1_njuffa_faster(float x) noexcept { FASTMATHS_PROBE_DOMAIN(x, 0x1p-126f, 0x1.fffffep127f); return log::njuffa_faster(x) * log10e; }
 // static inline float log1_ankerl32(float x) noexcept { return log::ankerl32(x) * log10e; }
-static inline float log1_ankerl32(float a) noexcept {
-    union { float f; int x; } u = { a };
-    // return (u.x - 1064866805) * 8.262958405176314e-8f * log10e; /* 1 / 12102203.0; */
-    return (u.x - 1064866805) * 3.5885572395641675e-8f; /* 1 / 12102203.0; */
+constexpr float log1_ankerl32(float a) noexcept {
+    FASTMATHS_PROBE_DOMAIN(a, 0x1p-126f, 0x1.fffffep127f);
+    // return (std::bit_cast<int>(a) - 1064866805) * 8.262958405176314e-8f * log10e; /* 1 / 12102203.0; */
+    return (std::bit_cast<int>(a) - 1064866805) * 3.5885572395641675e-8f; /* 1 / 12102203.0; */
+}
+constexpr float log1_ekmett_ub(float x) noexcept { FASTMATHS_PROBE_DOMAIN(x, 0x1p-126f, 0x1.fffffep127f); return log::ekmett_ub(x) * log10e; }
+constexpr float log1_ekmett_lb(float x) noexcept { FASTMATHS_PROBE_DOMAIN(x, 0x1p-126f, 0x1.fffffep127f); return log::ekmett_lb(x) * log10e; }
+constexpr float log1_jenkas(float x) noexcept { FASTMATHS_PROBE_DOMAIN(x, 0x1p-126f, 0x1.fffffep127f); return log::jenkas(x) * log10e; }
+
+// Table driven, see log_data.hpp. 2^TableBits entries and a Degree polynomial,
+// within a few ulp for positive normal x. T can also be simd::f32
+template <int TableBits = 4, int Degree = 4, typename T = float, typename Scheme = poly::horner>
+constexpr T table(T x) noexcept {
+    FASTMATHS_PROBE_DOMAIN(x, 0x1p-126f, 0x1.fffffep127f);
+    return log_data::__log_core<TableBits, Degree, Scheme, 0.301029995663981195213738894724>(x);
 }
-static inline float log1_ekmett_ub(float x) noexcept { return log::ekmett_ub(x) * log10e; }
-static inline float log1_ekmett_lb(float x) noexcept { return log::ekmett_lb(x) * log10e; }
-static inline float log1_jenkas(float x) noexcept { return log::jenkas(x) * log10e; }
 
 // adapted from log2::mineiro
 constexpr float log2_mineiro (float x) noexcept {
-    union { float f; uint32_t i; } vx = { x };
-    union { uint32_t i; float f; } mx = { (vx.i & 0x007FFFFF) | 0x3f000000 };
-    float y = vx.i;
+    FASTMATHS_PROBE_DOMAIN(x, 0x1p-126f, 0x1.fffffep127f);
+    const uint32_t vx = std::bit_cast<uint32_t>(x);
+    const float mx = std::bit_cast<float>((vx & 0x007FFFFF) | 0x3f000000);
+    float y = vx;
     // log21_10 = 0.3010299956639812
     // y *= log21_10 * 1.1920928955078125e-7f;
     y *= 3.588557191657796e-8f;
 
     // return log21_10 * (y - 124.22551499f
-    //                      - 1.498030302f * mx.f
-    //                      - 1.72587999f  / (0.3520887068f + mx.f));
+    //                      - 1.498030302f * mx
+    //                      - 1.72587999f  / (0.3520887068f + mx));
     return y - 37.39560623879553f
-             - 0.4509520553155725f * mx.f
-             - 0.5195416459062518f / (0.3520887068f + mx.f);
+             - 0.4509520553155725f * mx
+             - 0.5195416459062518f / (0.3520887068f + mx);
 }
 
 // adapted from log2::mineiro_faster
-static inline float log2_mineiro_faster(float x) noexcept {
-    union { float f; uint32_t i; } vx = { x };
-    float y = vx.i;
+constexpr float log2_mineiro_faster(float x) noexcept {
+    FASTMATHS_PROBE_DOMAIN(x, 0x1p-126f, 0x1.fffffep127f);
+    float y = std::bit_cast<uint32_t>(x);
     // log21_10 = 0.3010299956639812
     // y *= log21_10 * 1.1920928955078125e-7f;
     y *= 3.588557191657796e-8f;
@@ -2,33 +2,40 @@
 #include <cmath>
 
 #include "log.hpp"
+#include "instrument.hpp"
+#include "simd.hpp"
 
 namespace fast {
 namespace log2 {
 
-static inline float stl(float x) noexcept { return std::log2f(x); }
+static inline float stl(float x) noexcept { FASTMATHS_PROBE(x); return std::log2f(x); }
 
 // https://stackoverflow.com/questions/9411823/fast-log2float-x-implementation-c/28730362#28730362
-static inline float lgeoffroy(float val) {
-    union { float val; int32_t x; } u = { val };
-    float log_2 = (float)(((u.x >> 23) & 255) - 128);
-    u.x   &= ~(255 << 23);
-    u.x   += 127 << 23;
-    log_2 += ((-0.3358287811f) * u.val + 2.0f) * u.val  -0.65871759316667f;
+constexpr float lgeoffroy(float val) noexcept {
+    FASTMATHS_PROBE_DOMAIN(val, 0x1p-126f, 0x1.fffffep127f);
+    int32_t x = std::bit_cast<int32_t>(val);
+    float log_2 = (float)(((x >> 23) & 255) - 128);
+    x   &= ~(255 << 23);
+    x   += 127 << 23;
+    val = std::bit_cast<float>(x);
+    log_2 += ((-0.3358287811f) * val + 2.0f) * val  -0.65871759316667f;
     return (log_2);
 }
 
-static inline float lgeoffroy_accurate(float val) {
-    union { float val; int32_t x; } u = { val };
-    float log_2 = (float)(((u.x >> 23) & 255) - 128);
-    u.x   &= ~(255 << 23);
-    u.x   += 127 << 23;
-    log_2 += ((-0.34484843f) * u.val + 2.02466578f) * u.val - 0.67487759f;
+constexpr float lgeoffroy_accurate(float val) noexcept {
+    FASTMATHS_PROBE_DOMAIN(val, 0x1p-126f, 0x1.fffffep127f);
+    int32_t x = std::bit_cast<int32_t>(val);
+    float log_2 = (float)(((x >> 23) & 255) - 128);
+    x   &= ~(255 << 23);
+    x   += 127 << 23;
+    val = std::bit_cast<float>(x);
+    log_2 += ((-0.34484843f) * val + 2.02466578f) * val - 0.67487759f;
     return (log_2);
 }
 
 // https://www.johndcook.com/blog/2021/03/24/log10-trick/
-static inline float jcook(float x) noexcept {
+constexpr float jcook(float x) noexcept {
+    FASTMATHS_PROBE(x);
     return 2.9142f * (x - 1)/(x + 1);
 }
 
@@ -38,7 +45,8 @@ constexpr float __newton_next(float r, float x) noexcept {
     return r - static_cast<float>(M_LOG2E) * (1 - x / (1 << static_cast<int>(r)));
 }
 
-static inline float newton(float x) noexcept {
+constexpr float newton(float x) noexcept {
+    FASTMATHS_PROBE(x);
     // static float epsilon = 0.000001f; // change this to change accuracy
     float r = x / 2; // better first guesses converge faster
     float r2 = __newton_next(r, x);
@@ -54,47 +62,58 @@ static inline float newton(float x) noexcept {
 }
 
 // https://github.com/romeric/fastapprox/blob/master/fastapprox/src/fastlog.h
-static inline float mineiro(float x) {
-    union { float f; uint32_t i; } vx = { x };
-    union { uint32_t i; float f; } mx = { (vx.i & 0x007FFFFF) | 0x3f000000 };
-    float y = vx.i;
+constexpr float mineiro(float x) noexcept {
+    FASTMATHS_PROBE_DOMAIN(x, 0x1p-126f, 0x1.fffffep127f);
+    const uint32_t vx = std::bit_cast<uint32_t>(x);
+    const float mx = std::bit_cast<float>((vx & 0x007FFFFF) | 0x3f000000);
+    float y = vx;
     y *= 1.1920928955078125e-7f;
 
     return y - 124.22551499f
-             - 1.498030302f * mx.f
-             - 1.72587999f  / (0.3520887068f + mx.f);
+             - 1.498030302f * mx
+             - 1.72587999f  / (0.3520887068f + mx);
 }
 
 // https://github.com/romeric/fastapprox/blob/master/fastapprox/src/fastlog.h
-static inline float mineiro_faster (float x) noexcept {
-    union { float f; uint32_t i; } vx = { x };
-    float y = vx.i;
-    y *= 1.1920928955078125e-7f;
-    return y - 126.94269504f;
+// the bits as an int, which is the same for positive x. T is float or simd::f32
+template <typename T = float>
+constexpr T mineiro_faster (T x) noexcept {
+    FASTMATHS_PROBE_DOMAIN(x, 0x1p-126f, 0x1.fffffep127f);
+    T y = simd::to_f32(simd::as_i32(x));
+    y = y * T(1.1920928955078125e-7f);
+    return y - T(126.94269504f);
 }
 
 // https://www.musicdsp.org/en/latest/Other/63-fast-log2.html
-static inline float desoras (float val) noexcept {
+constexpr float desoras (float val) noexcept {
+    FASTMATHS_PROBE_DOMAIN(val, 0x1p-126f, 0x1.fffffep127f);
     // assert (val > 0);
 
-    int * const  exp_ptr = reinterpret_cast <int*> (&val);
-    int          x = *exp_ptr;
+    int          x = std::bit_cast<int> (val);
     const int    log_2 = ((x >> 23) & 255) - 128;
     x &= ~(255 << 23);
     x += 127 << 23;
-    *exp_ptr = x;
+    val = std::bit_cast<float> (x);
 
     return (val + log_2);
 }
 
 static constexpr float log2e = 1.4426950408888495f;
 
-static inline float log1_njuffa(float x) noexcept { return log::njuffa(x) * log2e; }
-static inline float log1_njuffa_faster(float x) noexcept { return log::njuffa_faster(x) * log2e; }
-static inline float log1_ankerl32(float x) noexcept { return log::ankerl32(x) * log2e; }
-static inline float log1_ekmett_lb(float x) noexcept { return log::ekmett_lb(x) * log2e; }
-static inline float log1_jenkas(float x) noexcept { return log::jenkas(x) * log2e; }
-static inline float log1_mineiro_faster(float x) noexcept { return log::mineiro_faster(x) * log2e; }
+constexpr float log1_njuffa(float x) noexcept { FASTMATHS_PROBE(x); return log::njuffa(x) * log2e; }
+constexpr float log1_njuffa_faster(float x) noexcept { FASTMATHS_PROBE_DOMAIN(x, 0x1p-126f, 0x1.fffffep127f); return log::njuffa_faster(x) * log2e; }
+constexpr float log1_ankerl32(float x) noexcept { FASTMATHS_PROBE_DOMAIN(x, 0x1p-126f, 0x1.fffffep127f); return log::ankerl32(x) * log2e; }
+constexpr float log1_ekmett_lb(float x) noexcept { FASTMATHS_PROBE_DOMAIN(x, 0x1p-126f, 0x1.fffffep127f); return log::ekmett_lb(x) * log2e; }
+constexpr float log1_jenkas(float x) noexcept { FASTMATHS_PROBE_DOMAIN(x, 0x1p-126f, 0x1.fffffep127f); return log::jenkas(x) * log2e; }
+constexpr float log1_mineiro_faster(float x) noexcept { FASTMATHS_PROBE_DOMAIN(x, 0x1p-126f, 0x1.fffffep127f); return log::mineiro_faster(x) * log2e; }
+
+// Table driven, see log_data.hpp. 2^TableBits entries and a Degree polynomial,
+// within a few ulp for positive normal x. T can also be simd::f32
+template <int TableBits = 4, int Degree = 4, typename T = float, typename Scheme = poly::horner>
+constexpr T table(T x) noexcept {
+    FASTMATHS_PROBE_DOMAIN(x, 0x1p-126f, 0x1.fffffep127f);
+    return log_data::__log_core<TableBits, Degree, Scheme, 1.0>(x);
+}
 
 
 } // namespace log2
@@ -0,0 +1,113 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <cstdint>
+#include "poly.hpp"
+#include "simd.hpp"
+
+// Tables & the shared core of the table driven log2/log/log10, in the style of
+// glibc's log2f: https://github.com/bminor/glibc/blob/master/sysdeps/ieee754/flt-32/e_log2f.c
+//
+//   x = 2^k * z,  z in [OFF, 2 OFF),  OFF ~ 0.7 so that z is centred on 1
+//   log2(x) = k + log2(c) + log2(1 + r),  r = (z - c) / c
+//
+// c is the middle of one of 2^bits subintervals of z, picked by the top
+// mantissa bits. The table holds c, 1/c and log2(c), and log2(1 + r) is a
+// short polynomial. z - c is exact (Sterbenz), so unlike glibc no FMA or
+// double is needed to keep r accurate. The subinterval holding 1 uses c = 1,
+// which keeps results around x = 1 accurate relative to their size.
+// Everything is computed at compile time.
+
+namespace fast {
+namespace log_data {
+
+// 0.69921875, the bottom of the reduced range
+inline constexpr std::int32_t off = 0x3f330000;
+
+// ln(v) for v near 1, as 2 atanh((v - 1) / (v + 1)). In double, converged well
+// beyond float precision on [0.5, 2]
+constexpr double __ln_series(double v) noexcept {
+    const double u = (v - 1.0) / (v + 1.0);
+    const double u2 = u * u;
+    double sum = 0.0, term = u;
+    for (int i = 0; i < 30; i++) {
+        sum += term / (2 * i + 1);
+        term *= u2;
+    }
+    return 2.0 * sum;
+}
+
+// The entries are kept as float bits, like exp2_table. Stores through a
+// float* can't alias them then, so GCC still vectorises loops over the scalar
+// version instead of giving up on the gathers
+template <int Bits>
+struct log2_table_t {
+    std::array<std::int32_t, (1 << Bits)> c, invc, logc;
+};
+
+template <int Bits>
+constexpr log2_table_t<Bits> __make_log2_table() noexcept {
+    log2_table_t<Bits> t{};
+    constexpr std::int32_t width = 1 << (23 - Bits);
+    constexpr std::int32_t one = 0x3f800000;
+    for (int i = 0; i < (1 << Bits); i++) {
+        const std::int32_t lo = off + i * width;
+        const bool holds_one = lo <= one && one < lo + width;
+        const double mid = (double(std::bit_cast<float>(lo)) + double(std::bit_cast<float>(lo + width))) / 2;
+        const float c = holds_one ? 1.0f : static_cast<float>(mid);
+        t.c[i] = std::bit_cast<std::int32_t>(c);
+        t.invc[i] = std::bit_cast<std::int32_t>(static_cast<float>(1.0 / c));
+        t.logc[i] = std::bit_cast<std::int32_t>(static_cast<float>(__ln_series(c) / 0.693147180559945309417232121458));
+    }
+    return t;
+}
+
+template <int Bits>
+inline constexpr log2_table_t<Bits> log2_table = __make_log2_table<Bits>();
+
+// Taylor coefficients of log_b(1 + r) / r, ascending, LogB2 being log_b(2).
+// |r| <= 0.024 with a 16 entry table. The subinterval holding 1 is lopsided,
+// so near x = 1, where relative error counts, the dropped term is about
+// r^Degree / (Degree + 1) relative: 3e-6 for degree 3, 6e-8 for degree 4
+template <int Degree, double LogB2>
+constexpr std::array<float, Degree> __make_log_poly() noexcept {
+    std::array<float, Degree> c{};
+    const double scale = LogB2 / 0.693147180559945309417232121458;
+    for (int i = 0; i < Degree; i++)
+        c[i] = static_cast<float>((i % 2 ? -scale : scale) / (i + 1));
+    return c;
+}
+
+template <int Degree, double LogB2>
+inline constexpr std::array<float, Degree> log_poly = __make_log_poly<Degree, LogB2>();
+
+// log_b(x) for positive, normal x. 0, denormals, negatives, inf & NaN aren't
+// caught and give garbage
+template <int Bits, int Degree, typename Scheme, double LogB2, typename T>
+constexpr T __log_core(T x) noexcept {
+    static_assert(Bits >= 1 && Bits <= 10, "table sizes from 2 to 1024 entries");
+    static_assert(Degree >= 1, "log(1 + r) needs at least the linear term");
+    using I = simd::int_t<T>;
+    constexpr const log2_table_t<Bits>& tbl = log2_table<Bits>;
+
+    const I ix = simd::as_i32(x);
+    const I tmp = ix - I(off);
+    const I i = (tmp >> (23 - Bits)) & I((1 << Bits) - 1);
+    const T z = simd::as_f32(ix - (tmp & I(-(1 << 23))));
+    const T k = simd::to_f32(tmp >> 23);
+
+    const T c = simd::as_f32(simd::gather(tbl.c.data(), i));
+    const T invc = simd::as_f32(simd::gather(tbl.invc.data(), i));
+    const T logc = simd::as_f32(simd::gather(tbl.logc.data(), i));
+
+    const T r = (z - c) * invc;
+    const T hi = k + logc;
+    const T p = r * poly::eval<Scheme>(r, log_poly<Degree, LogB2>);
+    if constexpr (LogB2 == 1.0)
+        return hi + p;
+    else
+        return hi * T(static_cast<float>(LogB2)) + p;
+}
+
+} // namespace log_data
+} // namespace fast
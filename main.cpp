@@ -1,23 +1,15 @@
-#include <chrono>
 #include <cmath>
+#include <cstdlib>
+#include <cstring>
 #include <iomanip>
 #include <iostream>
+#include <numeric>
 #include <random>
+#include <string>
+#include <vector>
 
-#include "common.hpp"
-
-#include "cos.hpp"
-#include "exp.hpp"
-#include "exp2.hpp"
-#include "exp10.hpp"
-#include "log.hpp"
-#include "log2.hpp"
-#include "log10.hpp"
-#include "pow.hpp"
-#include "sin.hpp"
-#include "sqrt.hpp"
-#include "tan.hpp"
-#include "tanh.hpp"
+#include "bench.hpp"
+#include "catalogue.hpp"
 
 
 template <typename F, typename S>
@@ -284,330 +276,405 @@ void log_sqrt(F sqrt_func, S name) noexcept {
     std::cout << "]" << std::endl;
 }
 
-float gen_random() noexcept {
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    static std::uniform_real_distribution<float> dis(-1.0, 1.0);
-    return dis(gen);
+// Prints the arrays that are pasted into the graphs/*.py scripts
+static void print_graph_data(const std::string& family) {
+    if (family == "sin") {
+        log_sin(fast::sin::stl, "stl");
+        log_sin(fast::sin::bhaskara_radians<float>, "bhaskara_radians");
+        log_sin(fast::sin::pade<float>, "pade");
+        log_sin(fast::sin::sin_approx<float>, "sin_approx");
+        log_sin(fast::sin::slaru<float>, "slaru");
+        log_sin(fast::sin::juha<float>, "juha");
+        log_sin(fast::sin::juha_fmod, "juha_fmod");
+        log_sin(fast::sin::mineiro, "mineiro");
+        log_sin(fast::sin::mineiro_faster, "mineiro_faster");
+        log_sin(fast::sin::mineiro_full, "mineiro_full");
+        log_sin(fast::sin::mineiro_full_faster, "mineiro_full_faster");
+        log_sin(fast::sin::njuffa<float>, "njuffa");
+        log_sin(fast::sin::wildmagic0<float>, "wildmagic0");
+        log_sin(fast::sin::wildmagic1<float>, "wildmagic1");
+        log_sin(fast::sin::bluemangoo, "bluemangoo");
+        log_sin(fast::sin::lanceputnam_gamma, "lanceputnam_gamma");
+    }
+
+    if (family == "cos") {
+        log_sin(fast::cos::stl<float>, "stl");
+        log_sin(fast::cos::pade<float>, "pade");
+        log_sin(fast::cos::milianw, "milianw");
+        log_sin(fast::cos::milianw_precise, "milianw_precise");
+        log_sin(fast::cos::juha, "juha");
+        log_sin(fast::cos::mineiro, "mineiro");
+        log_sin(fast::cos::mineiro_faster, "mineiro_faster");
+        log_sin(fast::cos::wildmagic0<float>, "wildmagic0");
+        log_sin(fast::cos::wildmagic1<float>, "wildmagic1");
+    }
+
+    if (family == "tan") {
+        log_tan(fast::tan::stl, "stl");
+        log_tan(fast::tan::pade, "pade");
+        log_tan(fast::tan::wildmagic0<float>, "wildmagic0");
+        log_tan(fast::tan::wildmagic1<float>, "wildmagic1");
+        log_tan(fast::tan::jrus_alt_denorm, "jrus_alt_denorm");
+        log_tan(fast::tan::jrus_denorm, "jrus_denorm");
+        log_tan(fast::tan::jrus_full_denorm, "jrus_full_denorm");
+        log_tan(fast::tan::kay, "kay");
+        log_tan(fast::tan::kay_precise, "kay_precise");
+    }
+
+    if (family == "tanh") {
+        log_tanh(fast::tanh::stl<float>, "stl");
+        log_tanh(fast::tanh::pade<float>, "pade");
+        log_tanh(fast::tanh::c3, "c3");
+        log_tanh(fast::tanh::exp_ekmett_ub, "exp_ekmett_ub");
+        log_tanh(fast::tanh::exp_ekmett_lb, "exp_ekmett_lb");
+        log_tanh(fast::tanh::exp_schraudolph, "exp_schraudolph");
+        log_tanh(fast::tanh::exp_mineiro, "exp_mineiro");
+        log_tanh(fast::tanh::exp_mineiro_faster, "exp_mineiro_faster");
+    }
+
+    if (family == "log") {
+        log_normalised_freq(fast::log::stl, "stl");
+        log_normalised_freq(fast::log::logNPlusOne<float>, "logNPlusOne");
+        log_normalised_freq(fast::log::njuffa<>, "njuffa");
+        log_normalised_freq(fast::log::njuffa_faster<>, "njuffa_faster");
+        log_normalised_freq(fast::log::ankerl32, "ankerl32");
+        log_normalised_freq(fast::log::ekmett_lb, "ekmett_lb");
+        log_normalised_freq(fast::log::mineiro, "mineiro");
+        log_normalised_freq(fast::log::mineiro_faster, "mineiro_faster");
+    }
+
+    if (family == "log2") {
+        log_hz_to_midi(fast::log2::stl, "stl");
+        log_hz_to_midi(fast::log2::lgeoffroy, "lgeoffroy");
+        log_hz_to_midi(fast::log2::lgeoffroy_accurate, "lgeoffroy_accurate");
+        log_hz_to_midi(fast::log2::jcook, "jcook");
+        log_hz_to_midi(fast::log2::mineiro, "mineiro");
+        log_hz_to_midi(fast::log2::mineiro_faster<>, "mineiro_faster");
+        log_hz_to_midi(fast::log2::newton, "newton");
+        log_hz_to_midi(fast::log2::desoras, "desoras");
+        log_hz_to_midi(fast::log2::log1_njuffa, "log1_njuffa");
+        log_hz_to_midi(fast::log2::log1_njuffa_faster, "log1_njuffa_faster");
+        log_hz_to_midi(fast::log2::log1_ankerl32, "log1_ankerl32");
+        log_hz_to_midi(fast::log2::log1_ekmett_lb, "log1_ekmett_lb");
+
+        log_ratio_to_midi_offset(fast::log2::stl, "stl");
+        log_ratio_to_midi_offset(fast::log2::lgeoffroy, "lgeoffroy");
+        log_ratio_to_midi_offset(fast::log2::lgeoffroy_accurate, "lgeoffroy_accurate");
+        log_ratio_to_midi_offset(fast::log2::jcook, "jcook");
+        log_ratio_to_midi_offset(fast::log2::mineiro, "mineiro");
+        log_ratio_to_midi_offset(fast::log2::mineiro_faster<>, "mineiro_faster");
+        log_ratio_to_midi_offset(fast::log2::newton, "newton");
+        log_ratio_to_midi_offset(fast::log2::desoras, "desoras");
+        log_ratio_to_midi_offset(fast::log2::log1_njuffa, "log1_njuffa");
+        log_ratio_to_midi_offset(fast::log2::log1_njuffa_faster, "log1_njuffa_faster");
+        log_ratio_to_midi_offset(fast::log2::log1_ankerl32, "log1_ankerl32");
+        log_ratio_to_midi_offset(fast::log2::log1_ekmett_lb, "log1_ekmett_lb");
+        log_ratio_to_midi_offset(fast::log2::log1_mineiro_faster, "log1_mineiro_faster");
+    }
+
+    if (family == "log10") {
+        log_gain_to_db(fast::log10::stl, "stl");
+        log_gain_to_db(fast::log10::jcook, "jcook");
+        log_gain_to_db(fast::log10::newton, "newton");
+        log_gain_to_db(fast::log10::log1_njuffa, "log1_njuffa");
+        log_gain_to_db(fast::log10::log1_njuffa_faster, "log1_njuffa_faster");
+        log_gain_to_db(fast::log10::log1_ankerl32, "log1_ankerl32");
+        log_gain_to_db(fast::log10::log1_ekmett_ub, "log1_ekmett_ub");
+        log_gain_to_db(fast::log10::log1_ekmett_lb, "log1_ekmett_lb");
+        log_gain_to_db(fast::log10::log2_mineiro, "log2_mineiro");
+        log_gain_to_db(fast::log10::log2_mineiro_faster, "log2_mineiro_faster");
+    }
+
+    if (family == "exp2") {
+        log_midi_to_hz([](float x) { return fast::exp2::stl(x); }, "exp2");
+        log_midi_to_hz([](float x) { return fast::exp2::mineiro(x); }, "mineiro");
+        log_midi_to_hz([](float x) { return fast::exp2::mineiro_faster(x); }, "mineiro_faster");
+        log_midi_to_hz([](float x) { return fast::exp2::schraudolph(x); }, "schraudolph");
+        log_midi_to_hz([](float x) { return (float)fast::exp2::desoras(x); }, "desoras");
+        log_midi_to_hz([](float x) { return fast::exp2::powx_stl(x); }, "powx_stl");
+        log_midi_to_hz([](float x) { return fast::exp2::powx_ekmett_fast(x); }, "powx_ekmett_fast");
+        log_midi_to_hz([](float x) { return fast::exp2::powx_ekmett_fast_lb(x); }, "powx_ekmett_fast_lb");
+        log_midi_to_hz([](float x) { return fast::exp2::powx_ekmett_fast_ub(x); }, "powx_ekmett_fast_ub");
+        log_midi_to_hz([](float x) { return fast::exp2::powx_ekmett_fast_precise(x); }, "powx_ekmett_fast_precise");
+        log_midi_to_hz([](float x) { return fast::exp2::powx_ekmett_fast_better_precise(x); }, "powx_ekmett_fast_better_precise");
+        log_midi_to_hz([](float x) { return fast::exp2::exp_stl(x); }, "exp_stl");
+        log_midi_to_hz([](float x) { return fast::exp2::exp_ekmett_ub(x); }, "exp_ekmett_ub");
+        log_midi_to_hz([](float x) { return fast::exp2::exp_schraudolph(x); }, "exp_schraudolph");
+        log_midi_to_hz([](float x) { return fast::exp2::exp_mineiro(x); }, "exp_mineiro");
+        log_midi_to_hz([](float x) { return fast::exp2::exp_mineiro_faster(x); }, "exp_mineiro_faster");
+
+        log_denormalised_freq([](float x) { return fast::exp2::stl(x); }, "exp2");
+        log_denormalised_freq([](float x) { return fast::exp2::mineiro(x); }, "mineiro");
+        log_denormalised_freq([](float x) { return fast::exp2::mineiro_faster(x); }, "mineiro_faster");
+        log_denormalised_freq([](float x) { return fast::exp2::schraudolph(x); }, "schraudolph");
+        log_denormalised_freq([](float x) { return (float)fast::exp2::desoras(x); }, "desoras");
+        log_denormalised_freq([](float x) { return fast::exp2::powx_stl(x); }, "powx_stl");
+        log_denormalised_freq([](float x) { return fast::exp2::powx_ekmett_fast(x); }, "powx_ekmett_fast");
+        log_denormalised_freq([](float x) { return fast::exp2::powx_ekmett_fast_lb(x); }, "powx_ekmett_fast_lb");
+        log_denormalised_freq([](float x) { return fast::exp2::powx_ekmett_fast_ub(x); }, "powx_ekmett_fast_ub");
+        log_denormalised_freq([](float x) { return fast::exp2::powx_ekmett_fast_precise(x); }, "powx_ekmett_fast_precise");
+        log_denormalised_freq([](float x) { return fast::exp2::powx_ekmett_fast_better_precise(x); }, "powx_ekmett_fast_better_precise");
+        log_denormalised_freq([](float x) { return fast::exp2::exp_stl(x); }, "exp_stl");
+        log_denormalised_freq([](float x) { return fast::exp2::exp_ekmett_ub(x); }, "exp_ekmett_ub");
+        log_denormalised_freq([](float x) { return fast::exp2::exp_schraudolph(x); }, "exp_schraudolph");
+        log_denormalised_freq([](float x) { return fast::exp2::exp_mineiro(x); }, "exp_mineiro");
+        log_denormalised_freq([](float x) { return fast::exp2::exp_mineiro_faster(x); }, "exp_mineiro_faster");
+    }
+
+    if (family == "exp10") {
+        log_db_to_gain([](float x) { return fast::exp10::powx_stl(x); }, "powx_stl");
+        log_db_to_gain([](float x) { return fast::exp10::powx_ekmett_fast(x); }, "powx_ekmett_fast");
+        log_db_to_gain([](float x) { return fast::exp10::powx_ekmett_fast_lb(x); }, "powx_ekmett_fast_lb");
+        log_db_to_gain([](float x) { return fast::exp10::powx_ekmett_fast_ub(x); }, "powx_ekmett_fast_ub");
+        log_db_to_gain([](float x) { return fast::exp10::powx_ekmett_fast_precise(x); }, "powx_ekmett_fast_precise");
+        log_db_to_gain([](float x) { return fast::exp10::powx_ekmett_fast_better_precise(x); }, "powx_ekmett_fast_better_precise");
+        log_db_to_gain([](float x) { return fast::exp10::exp_stl(x); }, "exp_stl");
+        log_db_to_gain([](float x) { return fast::exp10::exp_ekmett_lb(x); }, "exp_ekmett_lb");
+        log_db_to_gain([](float x) { return fast::exp10::exp_ekmett_ub(x); }, "exp_ekmett_ub");
+        log_db_to_gain([](float x) { return fast::exp10::exp_schraudolph(x); }, "exp_schraudolph");
+        log_db_to_gain([](float x) { return fast::exp10::exp_mineiro(x); }, "exp_mineiro");
+        log_db_to_gain([](float x) { return fast::exp10::exp_mineiro_faster(x); }, "exp_mineiro_faster");
+    }
+
+    if (family == "sqrt") {
+        log_sqrt(fast::sqrt::stl, "stl");
+        log_sqrt(fast::sqrt::bigtailwolf, "bigtailwolf");
+        log_sqrt(fast::sqrt::nimig18, "nimig18");
+    }
 }
 
-volatile float sink{}; // ensures a side effect
+static void usage() {
+    std::cout <<
+        "usage: main [options]\n"
+        "  --family NAME   only run this family, may be repeated (sin, exp2, log10, ...)\n"
+        "  --filter TEXT   only run functions whose name contains TEXT\n"
+        "  --reps N        timed repetitions per function (default 11)\n"
+        "  --warmup N      untimed repetitions per function before timing (default 2)\n"
+        "  --pin CPU       pin the benchmark to one core\n"
+        "  --no-shuffle    time the functions one after another instead of interleaving\n"
+        "                  their repetitions in a random order\n"
+        "  --seed N        seed for the interleaving order\n"
+        "  --csv PATH      also write the results to PATH, see bench/compare.py\n"
+        "  --latency       also time each function as a chain of dependent calls\n"
+        "  --exhaustive    measure errors over every float in the domain, not a sweep.\n"
+        "                  Slow, minutes per family\n"
+        "  --exhaustive-step N  same, but only every Nth float\n"
+        "  --counters      read hardware performance counters around each function\n"
+        "  --counter N=HEX add a raw perf event, eg. --counter divider_active=0x01000114\n"
+        "  --graph         print the arrays used by graphs/*.py instead of benchmarking\n"
+        "  --blocks        time the pipelines in catalogue.hpp's blocks() instead, per\n"
+        "                  output at 4K to 64K outputs. --family picks their group\n"
+        "  --scaling       time the functions over one large array on 1 to N threads,\n"
+        "                  with a plain copy for the memory bandwidth. Leave out --pin\n"
+        "  --scaling-size N    elements in that array (default 64M)\n"
+        "  --scaling-threads N time N threads, may be repeated (default 1, 2, 4.. cores)\n"
+        "  --layout        time the kernels in catalogue.hpp's layouts() over padded,\n"
+        "                  aligned & unaligned arrays, for what the tail & alignment cost\n"
+        "  --io            time the kernels in catalogue.hpp's io_kernels() over large\n"
+        "                  float, f16 & bf16 arrays, with their combined errors\n"
+        "  --banks         time the oscillator banks in catalogue.hpp's banks() at 16 to\n"
+        "                  4096 partials, in partials times samples a second\n"
+        "  --voices        time the oscillators in catalogue.hpp's voice_kernels() at 1 to\n"
+        "                  64 voices, in voices one core renders in real time\n"
+        "  --list          list the registered functions\n";
+}
 
-int main() {
-    auto benchmark = [](auto fun, auto rem) {
-        const auto start = std::chrono::high_resolution_clock::now();
-        for (auto size{1ULL}; size != 10'000'000ULL; ++size) {
-            sink = fun(gen_random());
+int main(int argc, char** argv) {
+    fast::bench::options opt;
+    std::vector<std::string> families;
+    std::string filter;
+    std::string csv;
+    bool graph = false;
+    bool list = false;
+    bool blocks = false;
+    bool scaling = false;
+    bool layout = false;
+    bool io = false;
+    bool banks = false;
+    bool voices = false;
+    bool use_counters = false;
+    bool shuffle = true;
+    int pin = -1;
+    unsigned seed = 1;
+    std::vector<fast::bench::counter_spec> counter_specs = fast::bench::default_counters();
+    fast::bench::counter_spec extra;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (!std::strcmp(arg, "--family") && has_value) families.push_back(argv[++i]);
+        else if (!std::strcmp(arg, "--filter") && has_value) filter = argv[++i];
+        else if (!std::strcmp(arg, "--reps") && has_value) opt.repetitions = std::max(1, std::atoi(argv[++i]));
+        else if (!std::strcmp(arg, "--warmup") && has_value) opt.warmup = std::max(0, std::atoi(argv[++i]));
+        else if (!std::strcmp(arg, "--pin") && has_value) pin = std::atoi(argv[++i]);
+        else if (!std::strcmp(arg, "--no-shuffle")) shuffle = false;
+        else if (!std::strcmp(arg, "--seed") && has_value) seed = unsigned(std::strtoul(argv[++i], nullptr, 10));
+        else if (!std::strcmp(arg, "--csv") && has_value) csv = argv[++i];
+        else if (!std::strcmp(arg, "--latency")) opt.latency = true;
+        else if (!std::strcmp(arg, "--exhaustive")) opt.exhaustive = true;
+        else if (!std::strcmp(arg, "--exhaustive-step") && has_value) {
+            opt.exhaustive = true;
+            opt.exhaustive_step = std::uint32_t(std::max(1ul, std::strtoul(argv[++i], nullptr, 10)));
+        }
+        else if (!std::strcmp(arg, "--counters")) use_counters = true;
+        else if (!std::strcmp(arg, "--counter") && has_value && fast::bench::parse_counter(argv[++i], extra)) {
+            counter_specs.push_back(extra);
+            use_counters = true;
+        }
+        else if (!std::strcmp(arg, "--graph")) graph = true;
+        else if (!std::strcmp(arg, "--list")) list = true;
+        else if (!std::strcmp(arg, "--blocks")) blocks = true;
+        else if (!std::strcmp(arg, "--scaling")) scaling = true;
+        else if (!std::strcmp(arg, "--layout")) layout = true;
+        else if (!std::strcmp(arg, "--io")) io = true;
+        else if (!std::strcmp(arg, "--banks")) banks = true;
+        else if (!std::strcmp(arg, "--voices")) voices = true;
+        else if (!std::strcmp(arg, "--scaling-size") && has_value) {
+            scaling = true;
+            opt.scaling_size = std::max(1ul, std::strtoul(argv[++i], nullptr, 10));
         }
-        const std::chrono::duration<double> diff =
-            std::chrono::high_resolution_clock::now() - start;
-        std::cout << "Time: " << std::fixed << std::setprecision(6) << diff.count()
-                  << " sec " << rem << std::endl;
+        else if (!std::strcmp(arg, "--scaling-threads") && has_value) {
+            scaling = true;
+            opt.scaling_threads.push_back(unsigned(std::max(1, std::atoi(argv[++i]))));
+        }
+        else {
+            usage();
+            return 2;
+        }
+    }
+
+    if (graph) {
+        for (const std::string& f : families)
+            print_graph_data(f);
+        return 0;
+    }
+
+    const std::vector<fast::bench::entry> entries = fast::bench::catalogue();
+    auto selected = [&](const fast::bench::entry& e) {
+        if (!families.empty() && std::find(families.begin(), families.end(), e.family) == families.end())
+            return false;
+        return filter.empty() || std::strstr(e.name, filter.c_str()) != nullptr;
     };
 
-    benchmark([](float x) { return x; }, "pass");
-    benchmark([](float x) { return x * x; }, "x^2");
-
-    /** SINE */
-    benchmark(fast::sin::stl, "stl");
-    // benchmark(fast::sin::taylor<float, 5>, "taylor 5");
-    // benchmark(fast::sin::taylor<float, 9>, "taylor 9");
-    // benchmark(fast::sin::taylor<float, 13>, "taylor 13");
-    // benchmark(fast::sin::taylor<float, 17>, "taylor 13");
-    // benchmark(fast::sin::taylorN<float, 1>, "taylorN 1");
-    // benchmark(fast::sin::taylorN<float, 2>, "taylorN 2");
-    // benchmark(fast::sin::taylorN<float, 3>, "taylorN 3");
-    // benchmark(fast::sin::taylorN<float, 4>, "taylorN 3");
-    benchmark(fast::sin::bhaskara_radians<float>, "bhaskara_radians");
-    benchmark(fast::sin::pade<float>, "pade");
-    benchmark(fast::sin::sin_approx<float>, "sin_approx");
-    benchmark(fast::sin::slaru<float>, "slaru");
-    benchmark(fast::sin::juha<float>, "juha");
-    benchmark(fast::sin::juha_fmod, "juha_fmod");
-    benchmark(fast::sin::mineiro, "mineiro");
-    benchmark(fast::sin::mineiro_faster, "mineiro_faster");
-    benchmark(fast::sin::mineiro_full, "mineiro_full");
-    benchmark(fast::sin::mineiro_full_faster, "mineiro_full_faster");
-    benchmark(fast::sin::njuffa<float>, "njuffa");
-    benchmark(fast::sin::wildmagic0, "wildmagic0");
-    benchmark(fast::sin::wildmagic1, "wildmagic1");
-    benchmark(fast::sin::bluemangoo, "bluemangoo");
-    benchmark(fast::sin::lanceputnam_gamma, "lanceputnam_gamma");
-
-    log_sin(fast::sin::stl, "stl");
-    log_sin(fast::sin::bhaskara_radians<float>, "bhaskara_radians");
-    log_sin(fast::sin::pade<float>, "pade");
-    log_sin(fast::sin::sin_approx<float>, "sin_approx");
-    log_sin(fast::sin::slaru<float>, "slaru");
-    log_sin(fast::sin::juha<float>, "juha");
-    log_sin(fast::sin::juha_fmod, "juha_fmod");
-    log_sin(fast::sin::mineiro, "mineiro");
-    log_sin(fast::sin::mineiro_faster, "mineiro_faster");
-    log_sin(fast::sin::mineiro_full, "mineiro_full");
-    log_sin(fast::sin::mineiro_full_faster, "mineiro_full_faster");
-    log_sin(fast::sin::njuffa<float>, "njuffa");
-    log_sin(fast::sin::wildmagic0, "wildmagic0");
-    log_sin(fast::sin::wildmagic1, "wildmagic1");
-    log_sin(fast::sin::bluemangoo, "bluemangoo");
-    log_sin(fast::sin::lanceputnam_gamma, "lanceputnam_gamma");
-
-    /** COS */
-    /**
-    benchmark(fast::cos::stl<float>, "stl");
-    benchmark(fast::cos::pade<float>, "pade");
-    benchmark(fast::cos::milianw, "milianw");
-    benchmark(fast::cos::milianw_precise, "milianw_precise");
-    benchmark(fast::cos::juha, "juha");
-    benchmark(fast::cos::mineiro, "mineiro");
-    benchmark(fast::cos::mineiro_faster, "mineiro_faster");
-    benchmark(fast::cos::wildmagic0, "wildmagic0");
-    benchmark(fast::cos::wildmagic1, "wildmagic1");
-
-    log_sin(fast::cos::stl<float>, "stl");
-    log_sin(fast::cos::pade<float>, "pade");
-    log_sin(fast::cos::milianw, "milianw");
-    log_sin(fast::cos::milianw_precise, "milianw_precise");
-    log_sin(fast::cos::juha, "juha");
-    log_sin(fast::cos::mineiro, "mineiro");
-    log_sin(fast::cos::mineiro_faster, "mineiro_faster");
-    log_sin(fast::cos::wildmagic0, "wildmagic0");
-    log_sin(fast::cos::wildmagic1, "wildmagic1");
-    */
-
-    /** TAN */
-    /**
-    benchmark(fast::tan::stl, "stl");
-    benchmark(fast::tan::pade, "pade");
-    benchmark(fast::tan::wildmagic0, "wildmagic0");
-    benchmark(fast::tan::wildmagic1, "wildmagic1");
-    benchmark(fast::tan::jrus_alt, "jrus_alt");
-    benchmark(fast::tan::jrus_alt_denorm, "jrus_alt_denorm");
-    benchmark(fast::tan::jrus_denorm, "jrus_denorm");
-    benchmark(fast::tan::jrus_full_denorm, "jrus_full_denorm");
-    benchmark(fast::tan::kay, "kay");
-    benchmark(fast::tan::kay_precise, "kay_precise");
-
-    log_tan(fast::tan::stl, "stl");
-    log_tan(fast::tan::pade, "pade");
-    log_tan(fast::tan::wildmagic0, "wildmagic0");
-    log_tan(fast::tan::wildmagic1, "wildmagic1");
-    log_tan(fast::tan::jrus_alt_denorm, "jrus_alt_denorm");
-    log_tan(fast::tan::jrus_denorm, "jrus_denorm");
-    log_tan(fast::tan::jrus_full_denorm, "jrus_full_denorm");
-    log_tan(fast::tan::kay, "kay");
-    log_tan(fast::tan::kay_precise, "kay_precise");
-    */
-
-    /** TANH */
-    /**
-    benchmark(fast::tanh::stl<float>, "stl");
-    benchmark(fast::tanh::pade<float>, "pade");
-    benchmark(fast::tanh::c3, "c3");
-    benchmark(fast::tanh::exp_ekmett_ub, "exp_ekmett_ub");
-    benchmark(fast::tanh::exp_ekmett_lb, "exp_ekmett_lb");
-    benchmark(fast::tanh::exp_schraudolph, "exp_schraudolph");
-    benchmark(fast::tanh::exp_mineiro, "exp_mineiro");
-    benchmark(fast::tanh::exp_mineiro_faster, "exp_mineiro_faster");
-
-    log_tanh(fast::tanh::stl<float>, "stl");
-    log_tanh(fast::tanh::pade<float>, "pade");
-    log_tanh(fast::tanh::c3, "c3");
-    log_tanh(fast::tanh::exp_ekmett_ub, "exp_ekmett_ub");
-    log_tanh(fast::tanh::exp_ekmett_lb, "exp_ekmett_lb");
-    log_tanh(fast::tanh::exp_schraudolph, "exp_schraudolph");
-    log_tanh(fast::tanh::exp_mineiro, "exp_mineiro");
-    log_tanh(fast::tanh::exp_mineiro_faster, "exp_mineiro_faster");
-    */
-
-    /** LOG */
-    /**
-    benchmark(fast::log::stl<float>, "stl");
-    benchmark(fast::log::logNPlusOne<float>, "logNPlusOne");
-    benchmark(fast::log::njuffa, "njuffa");
-    benchmark(fast::log::njuffa_faster, "njuffa_faster");
-    benchmark(fast::log::ankerl32, "ankerl32");
-    benchmark(fast::log::ekmett_lb, "ekmett_lb");
-    benchmark(fast::log::mineiro, "mineiro");
-    benchmark(fast::log::mineiro_faster, "mineiro_faster");
-    log_normalised_freq(fast::log::stl<float>, "stl");
-    log_normalised_freq(fast::log::logNPlusOne<float>, "logNPlusOne");
-    log_normalised_freq(fast::log::njuffa, "njuffa");
-    log_normalised_freq(fast::log::njuffa_faster, "njuffa_faster");
-    log_normalised_freq(fast::log::ankerl32, "ankerl32");
-    log_normalised_freq(fast::log::ekmett_lb, "ekmett_lb");
-    log_normalised_freq(fast::log::mineiro, "mineiro");
-    log_normalised_freq(fast::log::mineiro_faster, "mineiro_faster");
-    */
-
-    /** LOG2 */
-    /**
-    benchmark(fast::log2::stl, "stl");
-    benchmark(fast::log2::lgeoffroy, "lgeoffroy");
-    benchmark(fast::log2::lgeoffroy_accurate, "lgeoffroy_accurate");
-    benchmark(fast::log2::jcook, "jcook");
-    benchmark(fast::log2::mineiro, "mineiro");
-    benchmark(fast::log2::mineiro_faster, "mineiro_faster");
-    benchmark(fast::log2::newton, "newton");
-    benchmark(fast::log2::desoras, "desoras");
-    benchmark(fast::log2::log1_njuffa, "log1_njuffa");
-    benchmark(fast::log2::log1_njuffa_faster, "log1_njuffa_faster");
-    benchmark(fast::log2::log1_ankerl32, "log1_ankerl32");
-    benchmark(fast::log2::log1_ekmett_lb, "log1_ekmett_lb");
-
-    log_hz_to_midi(fast::log2::stl, "stl");
-    log_hz_to_midi(fast::log2::lgeoffroy, "lgeoffroy");
-    log_hz_to_midi(fast::log2::lgeoffroy_accurate, "lgeoffroy_accurate");
-    log_hz_to_midi(fast::log2::jcook, "jcook");
-    log_hz_to_midi(fast::log2::mineiro, "mineiro");
-    log_hz_to_midi(fast::log2::mineiro_faster, "mineiro_faster");
-    log_hz_to_midi(fast::log2::newton, "newton");
-    log_hz_to_midi(fast::log2::desoras, "desoras");
-    log_hz_to_midi(fast::log2::log1_njuffa, "log1_njuffa");
-    log_hz_to_midi(fast::log2::log1_njuffa_faster, "log1_njuffa_faster");
-    log_hz_to_midi(fast::log2::log1_ankerl32, "log1_ankerl32");
-    log_hz_to_midi(fast::log2::log1_ekmett_lb, "log1_ekmett_lb");
-    */
-
-    /*
-    log_ratio_to_midi_offset(fast::log2::stl, "stl");
-    log_ratio_to_midi_offset(fast::log2::lgeoffroy, "lgeoffroy");
-    log_ratio_to_midi_offset(fast::log2::lgeoffroy_accurate, "lgeoffroy_accurate");
-    log_ratio_to_midi_offset(fast::log2::jcook, "jcook");
-    log_ratio_to_midi_offset(fast::log2::mineiro, "mineiro");
-    log_ratio_to_midi_offset(fast::log2::mineiro_faster, "mineiro_faster");
-    log_ratio_to_midi_offset(fast::log2::newton, "newton");
-    log_ratio_to_midi_offset(fast::log2::desoras, "desoras");
-    log_ratio_to_midi_offset(fast::log2::log1_njuffa, "log1_njuffa");
-    log_ratio_to_midi_offset(fast::log2::log1_njuffa_faster, "log1_njuffa_faster");
-    log_ratio_to_midi_offset(fast::log2::log1_ankerl32, "log1_ankerl32");
-    log_ratio_to_midi_offset(fast::log2::log1_ekmett_lb, "log1_ekmett_lb");
-    log_ratio_to_midi_offset(fast::log2::log1_mineiro_faster, "log1_mineiro_faster");
-    */
-
-    /** LOG10 */
-    /*
-    benchmark(fast::log10::stl, "stl");
-    benchmark(fast::log10::jcook, "jcook");
-    benchmark(fast::log10::newton, "newton");
-    benchmark(fast::log10::log1_njuffa, "log1_njuffa");
-    benchmark(fast::log10::log1_njuffa_faster, "log1_njuffa_faster");
-    benchmark(fast::log10::log1_ankerl32, "log1_ankerl32");
-    benchmark(fast::log10::log1_ekmett_ub, "log1_ekmett_ub");
-    benchmark(fast::log10::log1_ekmett_lb, "log1_ekmett_lb");
-    benchmark(fast::log10::log2_mineiro, "log2_mineiro");
-    benchmark(fast::log10::log2_mineiro_faster, "log2_mineiro_faster");
-
-    log_gain_to_db(fast::log10::stl, "stl");
-    log_gain_to_db(fast::log10::jcook, "jcook");
-    log_gain_to_db(fast::log10::newton, "newton");
-    log_gain_to_db(fast::log10::log1_njuffa, "log1_njuffa");
-    log_gain_to_db(fast::log10::log1_njuffa_faster, "log1_njuffa_faster");
-    log_gain_to_db(fast::log10::log1_ankerl32, "log1_ankerl32");
-    log_gain_to_db(fast::log10::log1_ekmett_ub, "log1_ekmett_ub");
-    log_gain_to_db(fast::log10::log1_ekmett_lb, "log1_ekmett_lb");
-    log_gain_to_db(fast::log10::log2_mineiro, "log2_mineiro");
-    log_gain_to_db(fast::log10::log2_mineiro_faster, "log2_mineiro_faster");
-    */
-
-    /** EXP2 */
-    /**
-    benchmark([](float x) { return fast::exp2::stl(x); }, "exp2");
-    benchmark([](float x) { return fast::exp2::mineiro(x); }, "mineiro");
-    benchmark([](float x) { return fast::exp2::mineiro_faster(x); }, "mineiro_faster");
-    benchmark([](float x) { return fast::exp2::schraudolph(x); }, "schraudolph");
-    benchmark([](float x) { return (float)fast::exp2::desoras(x); }, "desoras");
-    benchmark([](float x) { return (float)fast::exp2::desoras_pos(x); }, "desoras_pos");
-    benchmark([](float x) { return fast::exp2::powx_stl(x); }, "powx_stl");
-    benchmark([](float x) { return fast::exp2::powx_ekmett_fast(x); }, "powx_ekmett_fast");
-    benchmark([](float x) { return fast::exp2::powx_ekmett_fast_lb(x); }, "powx_ekmett_fast_lb");
-    benchmark([](float x) { return fast::exp2::powx_ekmett_fast_ub(x); }, "powx_ekmett_fast_ub");
-    benchmark([](float x) { return fast::exp2::powx_ekmett_fast_precise(x); }, "powx_ekmett_fast_precise");
-    benchmark([](float x) { return fast::exp2::powx_ekmett_fast_better_precise(x); }, "powx_ekmett_fast_better_precise");
-    benchmark([](float x) { return fast::exp2::exp_stl(x); }, "exp_stl");
-    benchmark([](float x) { return fast::exp2::exp_ekmett_ub(x); }, "exp_ekmett_ub");
-    benchmark([](float x) { return fast::exp2::exp_schraudolph(x); }, "exp_schraudolph");
-    benchmark([](float x) { return fast::exp2::exp_mineiro(x); }, "exp_mineiro");
-    benchmark([](float x) { return fast::exp2::exp_mineiro_faster(x); }, "exp_mineiro_faster");
-
-    log_midi_to_hz([](float x) { return fast::exp2::stl(x); }, "exp2");
-    log_midi_to_hz([](float x) { return fast::exp2::mineiro(x); }, "mineiro");
-    log_midi_to_hz([](float x) { return fast::exp2::mineiro_faster(x); }, "mineiro_faster");
-    log_midi_to_hz([](float x) { return fast::exp2::schraudolph(x); }, "schraudolph");
-    log_midi_to_hz([](float x) { return (float)fast::exp2::desoras(x); }, "desoras");
-    log_midi_to_hz([](float x) { return fast::exp2::powx_stl(x); }, "powx_stl");
-    log_midi_to_hz([](float x) { return fast::exp2::powx_ekmett_fast(x); }, "powx_ekmett_fast");
-    log_midi_to_hz([](float x) { return fast::exp2::powx_ekmett_fast_lb(x); }, "powx_ekmett_fast_lb");
-    log_midi_to_hz([](float x) { return fast::exp2::powx_ekmett_fast_ub(x); }, "powx_ekmett_fast_ub");
-    log_midi_to_hz([](float x) { return fast::exp2::powx_ekmett_fast_precise(x); }, "powx_ekmett_fast_precise");
-    log_midi_to_hz([](float x) { return fast::exp2::powx_ekmett_fast_better_precise(x); }, "powx_ekmett_fast_better_precise");
-    log_midi_to_hz([](float x) { return fast::exp2::exp_stl(x); }, "exp_stl");
-    log_midi_to_hz([](float x) { return fast::exp2::exp_ekmett_ub(x); }, "exp_ekmett_ub");
-    log_midi_to_hz([](float x) { return fast::exp2::exp_schraudolph(x); }, "exp_schraudolph");
-    log_midi_to_hz([](float x) { return fast::exp2::exp_mineiro(x); }, "exp_mineiro");
-    log_midi_to_hz([](float x) { return fast::exp2::exp_mineiro_faster(x); }, "exp_mineiro_faster");
-
-    log_denormalised_freq([](float x) { return fast::exp2::stl(x); }, "exp2");
-    log_denormalised_freq([](float x) { return fast::exp2::mineiro(x); }, "mineiro");
-    log_denormalised_freq([](float x) { return fast::exp2::mineiro_faster(x); }, "mineiro_faster");
-    log_denormalised_freq([](float x) { return fast::exp2::schraudolph(x); }, "schraudolph");
-    log_denormalised_freq([](float x) { return (float)fast::exp2::desoras(x); }, "desoras");
-    log_denormalised_freq([](float x) { return fast::exp2::powx_stl(x); }, "powx_stl");
-    log_denormalised_freq([](float x) { return fast::exp2::powx_ekmett_fast(x); }, "powx_ekmett_fast");
-    log_denormalised_freq([](float x) { return fast::exp2::powx_ekmett_fast_lb(x); }, "powx_ekmett_fast_lb");
-    log_denormalised_freq([](float x) { return fast::exp2::powx_ekmett_fast_ub(x); }, "powx_ekmett_fast_ub");
-    log_denormalised_freq([](float x) { return fast::exp2::powx_ekmett_fast_precise(x); }, "powx_ekmett_fast_precise");
-    log_denormalised_freq([](float x) { return fast::exp2::powx_ekmett_fast_better_precise(x); }, "powx_ekmett_fast_better_precise");
-    log_denormalised_freq([](float x) { return fast::exp2::exp_stl(x); }, "exp_stl");
-    log_denormalised_freq([](float x) { return fast::exp2::exp_ekmett_ub(x); }, "exp_ekmett_ub");
-    log_denormalised_freq([](float x) { return fast::exp2::exp_schraudolph(x); }, "exp_schraudolph");
-    log_denormalised_freq([](float x) { return fast::exp2::exp_mineiro(x); }, "exp_mineiro");
-    log_denormalised_freq([](float x) { return fast::exp2::exp_mineiro_faster(x); }, "exp_mineiro_faster");
-    */
-
-    /** EXP */
-    // benchmark(fast::exp::stl<float>, "stl");
-    // benchmark(fast::exp::ekmett_ub, "ekmett_ub");
-    // benchmark(fast::exp::schraudolph, "schraudolph");
-    // benchmark(fast::exp::mineiro, "mineiro");
-    // benchmark(fast::exp::mineiro_faster, "mineiro_faster");
-
-    /** EXP10 */
-    /**
-    benchmark([](float x) { return fast::exp10::powx_stl(x); }, "powx_stl");
-    benchmark([](float x) { return fast::exp10::powx_ekmett_fast(x); }, "powx_ekmett_fast");
-    benchmark([](float x) { return fast::exp10::powx_ekmett_fast_lb(x); }, "powx_ekmett_fast_lb");
-    benchmark([](float x) { return fast::exp10::powx_ekmett_fast_ub(x); }, "powx_ekmett_fast_ub");
-    benchmark([](float x) { return fast::exp10::powx_ekmett_fast_precise(x); }, "powx_ekmett_fast_precise");
-    benchmark([](float x) { return fast::exp10::powx_ekmett_fast_better_precise(x); }, "powx_ekmett_fast_better_precise");
-    benchmark([](float x) { return fast::exp10::exp_stl(x); }, "exp_stl");
-    benchmark([](float x) { return fast::exp10::exp_ekmett_lb(x); }, "exp_ekmett_lb");
-    benchmark([](float x) { return fast::exp10::exp_ekmett_ub(x); }, "exp_ekmett_ub");
-    benchmark([](float x) { return fast::exp10::exp_schraudolph(x); }, "exp_schraudolph");
-    benchmark([](float x) { return fast::exp10::exp_mineiro(x); }, "exp_mineiro");
-    benchmark([](float x) { return fast::exp10::exp_mineiro_faster(x); }, "exp_mineiro_faster");
-
-    log_db_to_gain([](float x) { return fast::exp10::powx_stl(x); }, "powx_stl");
-    log_db_to_gain([](float x) { return fast::exp10::powx_ekmett_fast(x); }, "powx_ekmett_fast");
-    log_db_to_gain([](float x) { return fast::exp10::powx_ekmett_fast_lb(x); }, "powx_ekmett_fast_lb");
-    log_db_to_gain([](float x) { return fast::exp10::powx_ekmett_fast_ub(x); }, "powx_ekmett_fast_ub");
-    log_db_to_gain([](float x) { return fast::exp10::powx_ekmett_fast_precise(x); }, "powx_ekmett_fast_precise");
-    log_db_to_gain([](float x) { return fast::exp10::powx_ekmett_fast_better_precise(x); }, "powx_ekmett_fast_better_precise");
-    log_db_to_gain([](float x) { return fast::exp10::exp_stl(x); }, "exp_stl");
-    log_db_to_gain([](float x) { return fast::exp10::exp_ekmett_lb(x); }, "exp_ekmett_lb");
-    log_db_to_gain([](float x) { return fast::exp10::exp_ekmett_ub(x); }, "exp_ekmett_ub");
-    log_db_to_gain([](float x) { return fast::exp10::exp_schraudolph(x); }, "exp_schraudolph");
-    log_db_to_gain([](float x) { return fast::exp10::exp_mineiro(x); }, "exp_mineiro");
-    log_db_to_gain([](float x) { return fast::exp10::exp_mineiro_faster(x); }, "exp_mineiro_faster");
-    */
-
-    /** SQRT */
-    /**
-    benchmark(fast::sqrt::stl, "stl");
-    benchmark(fast::sqrt::bigtailwolf, "bigtailwolf");
-    benchmark(fast::sqrt::nimig18, "nimig18"); // awful
-
-    log_sqrt(fast::sqrt::stl, "stl");
-    log_sqrt(fast::sqrt::bigtailwolf, "bigtailwolf");
-    log_sqrt(fast::sqrt::nimig18, "nimig18");
-    */
+    if (list) {
+        for (const auto& e : entries)
+            if (selected(e))
+                std::cout << e.family << '/' << e.name << std::endl;
+        return 0;
+    }
+
+    fast::bench::counters pmu(counter_specs);
+    fast::bench::counters* counters = nullptr;
+    if (use_counters) {
+        if (pmu.open())
+            counters = &pmu;
+        if (!pmu.error().empty())
+            std::cerr << "some counters are unavailable: " << pmu.error() << std::endl;
+    }
+
+    if (pin >= 0 && !fast::bench::pin_to_cpu(pin))
+        std::cerr << "could not pin to cpu " << pin << std::endl;
+
+    if (blocks) {
+        const std::vector<fast::bench::block_entry> all = fast::bench::blocks();
+        std::vector<const fast::bench::block_entry*> picked;
+        for (const auto& e : all)
+            if ((families.empty() || std::find(families.begin(), families.end(), e.group) != families.end())
+                && (filter.empty() || std::strstr(e.name, filter.c_str()) != nullptr))
+                picked.push_back(&e);
+        fast::bench::print_block_header();
+        for (const auto& r : fast::bench::run_blocks(picked, opt))
+            fast::bench::print_block_result(r);
+        return 0;
+    }
+
+    if (io) {
+        const std::vector<fast::bench::io_entry> all = fast::bench::io_kernels();
+        fast::bench::print_io_header();
+        for (const auto& r : fast::bench::run_io(all, opt))
+            fast::bench::print_io_result(r);
+        return 0;
+    }
+
+    if (banks) {
+        const std::vector<fast::bench::bank_entry> all = fast::bench::banks();
+        fast::bench::print_bank_header();
+        for (const auto& r : fast::bench::run_banks(all, opt))
+            fast::bench::print_bank_result(r);
+        return 0;
+    }
+
+    if (voices) {
+        const std::vector<fast::bench::voice_entry> all = fast::bench::voice_kernels();
+        fast::bench::print_voice_header();
+        for (const auto& r : fast::bench::run_voices(all, opt))
+            fast::bench::print_voice_result(r);
+        return 0;
+    }
+
+    if (layout) {
+        const std::vector<fast::bench::layout_entry> all = fast::bench::layouts();
+        fast::bench::print_layout_header();
+        for (const auto& r : fast::bench::run_layout(all, opt))
+            fast::bench::print_layout_result(r);
+        return 0;
+    }
+
+    if (scaling) {
+        std::vector<const fast::bench::entry*> picked;
+        for (const auto& e : entries)
+            if (selected(e))
+                picked.push_back(&e);
+        fast::bench::print_scaling_header();
+        for (const auto& r : fast::bench::run_scaling(picked, opt))
+            fast::bench::print_scaling_result(r);
+        return 0;
+    }
+
+    std::vector<fast::bench::timer> timers;
+    for (const auto& e : entries)
+        if (selected(e))
+            timers.emplace_back(e, opt);
+
+    for (int w = 0; w < opt.warmup; w++)
+        for (auto& t : timers)
+            t.warmup();
+
+    // every round times each function once, in a new random order
+    std::mt19937 gen(seed);
+    std::vector<std::size_t> order(timers.size());
+    std::iota(order.begin(), order.end(), 0);
+    if (shuffle) {
+        for (int rep = 0; rep < opt.repetitions; rep++) {
+            std::shuffle(order.begin(), order.end(), gen);
+            for (std::size_t i : order)
+                timers[i].sample(counters);
+        }
+    } else {
+        for (auto& t : timers)
+            for (int rep = 0; rep < opt.repetitions; rep++)
+                t.sample(counters);
+    }
+
+    std::vector<fast::bench::result> results;
+    for (const auto& t : timers) {
+        fast::bench::result r{};
+        r.e = &t.e();
+        r.ns = t.summary();
+        r.latency = t.latency();
+        r.events = t.events();
+        results.push_back(r);
+    }
+    fast::bench::measure_errors(results, opt);
+    fast::bench::rank(results);
+
+    fast::bench::print_header(opt, counters);
+    for (const auto& r : results)
+        fast::bench::print_result(r, opt, counters);
+
+    if (!csv.empty() && !fast::bench::write_csv(csv, results, opt, counters)) {
+        std::cerr << "could not write " << csv << std::endl;
+        return 1;
+    }
+    return 0;
 }
@@ -0,0 +1,161 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include "buffer.hpp"
+#include "simd.hpp"
+#include "tier.hpp"
+
+// Banks of sine oscillators for additive synthesis, summed into one output.
+// Calling a sin kernel per partial per sample leaves most of each vector
+// register idle. A bank keeps its partials as arrays instead, a phase, an
+// increment & an amplitude each, so that a simd::f32 of partials advances &
+// evaluates at once:
+//   oscillator::bank<Sin>        a phase per partial, through a sin kernel good
+//                                in [-pi, pi], tiered::sin unless chosen
+//   oscillator::rotation_bank    a phasor per partial, rotated by a complex
+//                                multiply each sample. No sin at all, but the
+//                                frequencies are dearer to change
+// Both render in tiles of samples: a vector of partials stays in registers
+// for the whole tile, adding into one vector per sample, & each of those is
+// summed across its lanes once, at the end of the tile.
+//   oscillator::bank<> b(64);
+//   for (std::size_t k = 0; k < 64; k++)
+//       b.set(k, (k + 1) * 110.0f / 48000.0f, 0.5f / (k + 1));
+//   b.process(out, n); // out[t] += the partials
+// Frequencies are in cycles per sample, ie. Hz / sample rate, & phases in
+// cycles. The arrays are padded with silent partials to whole vectors.
+
+namespace fast {
+namespace oscillator {
+
+// samples per tile, one accumulator vector each
+inline constexpr std::size_t __tile = 16;
+
+// the default kernel, named as gcc 12 rejects a lambda as the default itself
+inline constexpr auto __tiered_sin = [](auto x) { return tiered::sin(x); };
+
+template <auto Sin = __tiered_sin>
+class bank {
+public:
+    bank() = default;
+    explicit bank(std::size_t partials) { resize(partials); }
+
+    // Every partial, old & new, is left silent at phase 0
+    void resize(std::size_t partials) {
+        for (buffer::aligned* a : { &phase_, &increment_, &amplitude_ }) {
+            a->resize(partials);
+            std::fill(a->data(), a->data() + buffer::padded_size(partials), 0.0f);
+        }
+    }
+
+    std::size_t size() const noexcept { return phase_.size(); }
+
+    void set(std::size_t k, float frequency, float amplitude, float phase = 0.0f) noexcept {
+        increment_[k] = frequency;
+        amplitude_[k] = amplitude;
+        phase_[k] = phase - std::nearbyint(phase);
+    }
+
+    // the arrays themselves, to change many partials at once, eg. envelopes
+    float* increments() noexcept { return increment_.data(); }
+    float* amplitudes() noexcept { return amplitude_.data(); }
+
+    // out[t] += the sum of the partials at sample t, advancing them
+    void process(float* out, std::size_t samples) noexcept {
+        constexpr std::size_t W = simd::f32::size;
+        const std::size_t partials = buffer::padded_size(size());
+        const simd::f32 twopi(6.28318531f);
+        for (std::size_t t0 = 0; t0 < samples; t0 += __tile) {
+            const std::size_t m = std::min(__tile, samples - t0);
+            simd::f32 sum[__tile];
+            for (std::size_t t = 0; t < m; t++)
+                sum[t] = simd::f32(0.0f);
+            for (std::size_t k = 0; k < partials; k += W) {
+                simd::f32 p = simd::f32::load_aligned(phase_.data() + k);
+                const simd::f32 inc = simd::f32::load_aligned(increment_.data() + k);
+                const simd::f32 a = simd::f32::load_aligned(amplitude_.data() + k);
+                for (std::size_t t = 0; t < m; t++) {
+                    sum[t] = simd::fma(a, Sin(p * twopi), sum[t]);
+                    p = p + inc;
+                    p = p - simd::round(p); // back into [-0.5, 0.5]
+                }
+                p.store_aligned(phase_.data() + k);
+            }
+            for (std::size_t t = 0; t < m; t++)
+                out[t0 + t] += simd::reduce_add(sum[t]);
+        }
+    }
+
+private:
+    buffer::aligned phase_, increment_, amplitude_;
+};
+
+// Each partial is the imaginary part of a unit phasor re + i im, multiplied
+// by c + i s = e^(i 2pi frequency) every sample. Rounding drifts its length a
+// little each time, so it's pulled back to 1 once per tile, by a Newton step
+// of 1 / sqrt(re^2 + im^2)
+class rotation_bank {
+public:
+    rotation_bank() = default;
+    explicit rotation_bank(std::size_t partials) { resize(partials); }
+
+    // Every partial, old & new, is left silent at phase 0
+    void resize(std::size_t partials) {
+        for (buffer::aligned* a : { &re_, &im_, &c_, &s_, &amplitude_ }) {
+            a->resize(partials);
+            std::fill(a->data(), a->data() + buffer::padded_size(partials), 0.0f);
+        }
+        std::fill(re_.data(), re_.data() + buffer::padded_size(partials), 1.0f);
+        std::fill(c_.data(), c_.data() + buffer::padded_size(partials), 1.0f);
+    }
+
+    std::size_t size() const noexcept { return re_.size(); }
+
+    void set(std::size_t k, float frequency, float amplitude, float phase = 0.0f) noexcept {
+        const double w = 6.283185307179586 * frequency, p = 6.283185307179586 * phase;
+        c_[k] = float(std::cos(w));
+        s_[k] = float(std::sin(w));
+        re_[k] = float(std::cos(p));
+        im_[k] = float(std::sin(p));
+        amplitude_[k] = amplitude;
+    }
+
+    float* amplitudes() noexcept { return amplitude_.data(); }
+
+    // out[t] += the sum of the partials at sample t, advancing them
+    void process(float* out, std::size_t samples) noexcept {
+        constexpr std::size_t W = simd::f32::size;
+        const std::size_t partials = buffer::padded_size(size());
+        for (std::size_t t0 = 0; t0 < samples; t0 += __tile) {
+            const std::size_t m = std::min(__tile, samples - t0);
+            simd::f32 sum[__tile];
+            for (std::size_t t = 0; t < m; t++)
+                sum[t] = simd::f32(0.0f);
+            for (std::size_t k = 0; k < partials; k += W) {
+                simd::f32 re = simd::f32::load_aligned(re_.data() + k);
+                simd::f32 im = simd::f32::load_aligned(im_.data() + k);
+                const simd::f32 c = simd::f32::load_aligned(c_.data() + k);
+                const simd::f32 s = simd::f32::load_aligned(s_.data() + k);
+                const simd::f32 a = simd::f32::load_aligned(amplitude_.data() + k);
+                for (std::size_t t = 0; t < m; t++) {
+                    sum[t] = simd::fma(a, im, sum[t]);
+                    const simd::f32 r = re * c - im * s;
+                    im = simd::fma(re, s, im * c);
+                    re = r;
+                }
+                const simd::f32 g = simd::f32(1.5f) - simd::f32(0.5f) * (re * re + im * im);
+                (re * g).store_aligned(re_.data() + k);
+                (im * g).store_aligned(im_.data() + k);
+            }
+            for (std::size_t t = 0; t < m; t++)
+                out[t0 + t] += simd::reduce_add(sum[t]);
+        }
+    }
+
+private:
+    buffer::aligned re_, im_, c_, s_, amplitude_;
+};
+
+} // namespace oscillator
+} // namespace fast
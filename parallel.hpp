@@ -0,0 +1,200 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <version>
+#if defined(__cpp_lib_parallel_algorithm)
+#include <execution>
+#endif
+#if defined(__unix__)
+#include <unistd.h>
+#endif
+#include "batch.hpp"
+#include "simd.hpp"
+
+// Batch kernels over arrays too large for one core, eg. hundreds of millions
+// of floats in offline rendering. The array is cut into chunks that fit in
+// L2 and an executor hands them out:
+//   parallel::sequential   the calling thread alone
+//   parallel::thread_pool  a fixed set of workers, the caller helps
+//   parallel::par_unseq    std::execution::par_unseq, where the standard
+//                          library has it. libstdc++ needs TBB for it to
+//                          actually run in parallel
+// Any kernel works, eg.
+//   parallel::thread_pool pool;
+//   parallel::transform(pool, in, out, n, [](auto x) { return exp::table(x); });
+//   parallel::run(pool, in, out, n, &bench::apply<log2::mineiro>);
+// Once the array is much larger than the caches, cheap kernels are limited by
+// memory bandwidth and stop scaling long before the core count.
+
+namespace fast {
+namespace parallel {
+
+// L2 size of a core, from sysconf where glibc knows it, else 256kb
+inline std::size_t l2_bytes() noexcept {
+#if defined(_SC_LEVEL2_CACHE_SIZE)
+    const long bytes = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    if (bytes > 0)
+        return static_cast<std::size_t>(bytes);
+#endif
+    return 256 * 1024;
+}
+
+// Elements per chunk, so that a chunk of input & output takes half the L2.
+// A whole number of cache lines, so no two threads write the same line
+inline std::size_t chunk_elements(std::size_t bytes_per_element = 2 * sizeof(float)) noexcept {
+    constexpr std::size_t line = 64 / sizeof(float);
+    const std::size_t n = l2_bytes() / 2 / bytes_per_element;
+    return std::max(line, n / line * line);
+}
+
+struct sequential {
+    unsigned concurrency() const noexcept { return 1; }
+
+    // f(begin, end) for every chunk of [0, n)
+    template <typename F>
+    void for_chunks(std::size_t n, std::size_t chunk, F&& f) const {
+        for (std::size_t b = 0; b < n; b += chunk)
+            f(b, std::min(b + chunk, n));
+    }
+};
+
+// Threads wait on a condition variable between jobs & take chunks from an
+// atomic counter during one, so uneven chunks balance themselves. for_chunks
+// blocks until every chunk is done. Calls from several threads run one after
+// the other
+class thread_pool {
+public:
+    // threads counts the caller, so thread_pool(1) starts no workers
+    explicit thread_pool(unsigned threads = std::thread::hardware_concurrency()) {
+        for (unsigned i = 1; i < threads; i++)
+            workers_.emplace_back([this] { loop(); });
+    }
+
+    ~thread_pool() {
+        {
+            std::lock_guard<std::mutex> lock(m_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (std::thread& t : workers_)
+            t.join();
+    }
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    unsigned concurrency() const noexcept { return static_cast<unsigned>(workers_.size()) + 1; }
+
+    template <typename F>
+    void for_chunks(std::size_t n, std::size_t chunk, F&& f) {
+        chunk = std::max<std::size_t>(chunk, 1);
+        if (workers_.empty() || n <= chunk) {
+            sequential{}.for_chunks(n, chunk, f);
+            return;
+        }
+        std::lock_guard<std::mutex> one_job(run_);
+        using Fn = std::remove_reference_t<F>;
+        job j{ [](void* fn, std::size_t b, std::size_t e) { (*static_cast<Fn*>(fn))(b, e); },
+               const_cast<void*>(static_cast<const void*>(std::addressof(f))), n, chunk };
+        {
+            std::lock_guard<std::mutex> lock(m_);
+            job_ = &j;
+            generation_++;
+        }
+        wake_.notify_all();
+        work(j);
+        // workers that wake after this find no job & go back to sleep
+        std::unique_lock<std::mutex> lock(m_);
+        done_.wait(lock, [&] { return busy_ == 0; });
+        job_ = nullptr;
+    }
+
+private:
+    struct job {
+        void (*call)(void* f, std::size_t begin, std::size_t end);
+        void* f;
+        std::size_t n, chunk;
+        std::atomic<std::size_t> next{ 0 };
+    };
+
+    static void work(job& j) {
+        for (;;) {
+            const std::size_t b = j.next.fetch_add(j.chunk, std::memory_order_relaxed);
+            if (b >= j.n)
+                return;
+            j.call(j.f, b, std::min(b + j.chunk, j.n));
+        }
+    }
+
+    void loop() {
+        std::uint64_t seen = 0;
+        for (;;) {
+            job* j;
+            {
+                std::unique_lock<std::mutex> lock(m_);
+                wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+                if (stop_)
+                    return;
+                seen = generation_;
+                j = job_;
+                if (!j)
+                    continue;
+                busy_++;
+            }
+            work(*j);
+            std::lock_guard<std::mutex> lock(m_);
+            if (--busy_ == 0)
+                done_.notify_all();
+        }
+    }
+
+    std::vector<std::thread> workers_;
+    std::mutex run_; // held for the whole of a for_chunks
+    std::mutex m_;   // guards the rest
+    std::condition_variable wake_, done_;
+    job* job_ = nullptr;
+    std::uint64_t generation_ = 0;
+    unsigned busy_ = 0;
+    bool stop_ = false;
+};
+
+#if defined(__cpp_lib_parallel_algorithm)
+struct par_unseq {
+    unsigned concurrency() const noexcept { return std::max(1u, std::thread::hardware_concurrency()); }
+
+    template <typename F>
+    void for_chunks(std::size_t n, std::size_t chunk, F&& f) const {
+        chunk = std::max<std::size_t>(chunk, 1);
+        std::vector<std::size_t> begins;
+        for (std::size_t b = 0; b < n; b += chunk)
+            begins.push_back(b);
+        std::for_each(std::execution::par_unseq, begins.begin(), begins.end(),
+                      [&](std::size_t b) { f(b, std::min(b + chunk, n)); });
+    }
+};
+#endif
+
+// block(in + b, out + b, e - b) for every chunk. block is anything with the
+// signature of bench::run_fn, eg. a catalogue entry
+template <typename Executor, typename Block>
+inline void run(Executor&& ex, const float* in, float* out, std::size_t n, Block&& block,
+                std::size_t chunk = chunk_elements()) {
+    ex.for_chunks(n, chunk, [&](std::size_t b, std::size_t e) { block(in + b, out + b, e - b); });
+}
+
+// batch::transform over chunks
+template <typename Executor, typename Kernel>
+inline void transform(Executor&& ex, const float* in, float* out, std::size_t n, Kernel&& kernel,
+                      std::size_t chunk = chunk_elements()) {
+    run(ex, in, out, n, [&](const float* i, float* o, std::size_t m) { batch::transform(i, o, m, kernel); }, chunk);
+}
+
+} // namespace parallel
+} // namespace fast
@@ -0,0 +1,161 @@
+#pragma once
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Hardware performance counters read around each benchmarked function.
+// Linux only, through perf_event_open. Elsewhere, or when the kernel refuses
+// (perf_event_paranoid > 2, no PMU in a VM), open() fails and the benchmark
+// just reports timings.
+
+namespace fast {
+namespace bench {
+
+struct counter_spec {
+    std::string name;
+    std::uint32_t type;   // PERF_TYPE_HARDWARE or PERF_TYPE_RAW
+    std::uint64_t config;
+};
+
+static inline bool is_intel() {
+    std::ifstream f("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(f, line))
+        if (line.rfind("vendor_id", 0) == 0)
+            return line.find("GenuineIntel") != std::string::npos;
+    return false;
+}
+
+// cycles, instructions & branch misses are generic. The divider and fp assist
+// events are model specific raw codes, these are the Skylake..Alder Lake ones:
+//   ARITH.DIVIDER_ACTIVE   event 0x14 umask 0x01 cmask 1
+//   FP_ASSIST.ANY          event 0xca umask 0x1e cmask 1
+// Other cores can pass their own with --counter name=0xconfig
+static inline std::vector<counter_spec> default_counters() {
+#if defined(__linux__)
+    std::vector<counter_spec> specs = {
+        { "cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+        { "instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+        { "branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+    };
+    if (is_intel()) {
+        specs.push_back({ "divider_active", PERF_TYPE_RAW, 0x01000114 });
+        specs.push_back({ "fp_assist", PERF_TYPE_RAW, 0x01001eca });
+    }
+    return specs;
+#else
+    return {};
+#endif
+}
+
+// parses "name=0xconfig" as a raw event
+static inline bool parse_counter(const char* arg, counter_spec& out) {
+    const char* eq = std::strchr(arg, '=');
+    if (!eq || eq == arg)
+        return false;
+    char* end = nullptr;
+    const unsigned long long config = std::strtoull(eq + 1, &end, 0);
+    if (end == eq + 1 || *end != '\0')
+        return false;
+#if defined(__linux__)
+    out = { std::string(arg, eq), PERF_TYPE_RAW, config };
+    return true;
+#else
+    (void)config;
+    return false;
+#endif
+}
+
+class counters {
+public:
+    explicit counters(std::vector<counter_spec> wanted) noexcept : wanted_(std::move(wanted)) {}
+    counters(const counters&) = delete;
+    counters& operator=(const counters&) = delete;
+    ~counters() { close(); }
+
+    // Opens every event that the kernel accepts, in one group so that they
+    // are scheduled together. Returns false if none could be opened
+    bool open() {
+#if defined(__linux__)
+        for (const counter_spec& spec : wanted_) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = spec.type;
+            attr.config = spec.config;
+            attr.disabled = fds_.empty() ? 1 : 0;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            const int leader = fds_.empty() ? -1 : fds_.front();
+            const int fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0);
+            if (fd < 0) {
+                error_ += spec.name + ": " + std::strerror(errno) + "; ";
+                continue;
+            }
+            fds_.push_back(fd);
+            opened_.push_back(spec);
+        }
+        return !fds_.empty();
+#else
+        error_ = "perf_event_open is only available on Linux";
+        return false;
+#endif
+    }
+
+    void start() noexcept {
+#if defined(__linux__)
+        if (fds_.empty()) return;
+        ioctl(fds_.front(), PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(fds_.front(), PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+    }
+
+    // Counts since start(), scaled up if the group was multiplexed
+    std::vector<double> stop() noexcept {
+        std::vector<double> counts(opened_.size(), 0.0);
+#if defined(__linux__)
+        if (fds_.empty()) return counts;
+        ioctl(fds_.front(), PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        // nr, time_enabled, time_running, values[nr]
+        std::vector<std::uint64_t> buf(3 + opened_.size());
+        if (::read(fds_.front(), buf.data(), buf.size() * sizeof(std::uint64_t)) <= 0)
+            return counts;
+        const double scale = buf[2] ? double(buf[1]) / double(buf[2]) : 0.0;
+        for (std::size_t i = 0; i < counts.size() && i < buf[0]; i++)
+            counts[i] = double(buf[3 + i]) * scale;
+#endif
+        return counts;
+    }
+
+    const std::vector<counter_spec>& opened() const noexcept { return opened_; }
+    const std::string& error() const noexcept { return error_; }
+
+private:
+    void close() noexcept {
+#if defined(__linux__)
+        for (int fd : fds_) ::close(fd);
+#endif
+        fds_.clear();
+    }
+
+    std::vector<counter_spec> wanted_;
+    std::vector<counter_spec> opened_;
+    std::vector<int> fds_;
+    std::string error_;
+};
+
+} // namespace bench
+} // namespace fast
@@ -0,0 +1,113 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <type_traits>
+#include "simd.hpp"
+
+// Polynomial evaluation, c[0] + c[1] x + c[2] x^2 + ...
+// The scheme is a policy, so a kernel can swap it without being rewritten:
+//   poly::eval<poly::horner>(x, c0, c1, c2, c3)
+//   poly::eval<poly::estrin_fma>(x, coeffs)     // std::array
+// T can be float, double or simd::f32.
+//
+// horner    one long dependency chain, fewest operations
+// estrin    pairs up terms in powers of x^2, x^4.. so out of order cores can
+//           overlap them. Roughly log2(N) deep instead of N
+// even_odd  two Horner chains in x^2, one for the even and one for the odd
+//           coefficients, joined with a final multiply add
+// The _fma versions fuse every multiply add into one rounding. Scalar fused
+// ops go through std::fma, which is only fast when built with FMA enabled.
+
+namespace fast {
+namespace poly {
+
+// a * b + c
+template <bool Fused, typename T>
+constexpr T madd(T a, T b, T c) noexcept {
+    if constexpr (Fused)
+        return simd::fma(a, b, c);
+    else
+        return a * b + c;
+}
+
+template <bool Fused>
+struct horner_scheme {
+    template <typename T, typename C, std::size_t N>
+    static constexpr T run(T x, const std::array<C, N>& c) noexcept {
+        T r = T(c[N - 1]);
+        for (std::size_t i = N - 1; i-- > 0;)
+            r = madd<Fused>(r, x, T(c[i]));
+        return r;
+    }
+};
+
+template <bool Fused>
+struct estrin_scheme {
+    template <typename T, typename C, std::size_t N>
+    static constexpr T run(T x, const std::array<C, N>& c) noexcept {
+        if constexpr (N == 1) {
+            return T(c[0]);
+        } else {
+            std::array<T, (N + 1) / 2> a{};
+            for (std::size_t i = 0; i < N / 2; i++)
+                a[i] = madd<Fused>(T(c[2 * i + 1]), x, T(c[2 * i]));
+            if constexpr (N % 2)
+                a[N / 2] = T(c[N - 1]);
+            return fold(a, x * x);
+        }
+    }
+
+    // combines neighbouring terms with p = x^2, x^4, x^8..
+    template <typename T, std::size_t M>
+    static constexpr T fold(const std::array<T, M>& a, T p) noexcept {
+        if constexpr (M == 1) {
+            return a[0];
+        } else {
+            std::array<T, (M + 1) / 2> b{};
+            for (std::size_t i = 0; i < M / 2; i++)
+                b[i] = madd<Fused>(a[2 * i + 1], p, a[2 * i]);
+            if constexpr (M % 2)
+                b[M / 2] = a[M - 1];
+            return fold(b, p * p);
+        }
+    }
+};
+
+template <bool Fused>
+struct even_odd_scheme {
+    template <typename T, typename C, std::size_t N>
+    static constexpr T run(T x, const std::array<C, N>& c) noexcept {
+        if constexpr (N == 1) {
+            return T(c[0]);
+        } else {
+            std::array<C, (N + 1) / 2> even{};
+            std::array<C, N / 2> odd{};
+            for (std::size_t i = 0; i < N; i++)
+                (i % 2 ? odd[i / 2] : even[i / 2]) = c[i];
+            const T s = x * x;
+            return madd<Fused>(horner_scheme<Fused>::run(s, odd), x, horner_scheme<Fused>::run(s, even));
+        }
+    }
+};
+
+using horner       = horner_scheme<false>;
+using horner_fma   = horner_scheme<true>;
+using estrin       = estrin_scheme<false>;
+using estrin_fma   = estrin_scheme<true>;
+using even_odd     = even_odd_scheme<false>;
+using even_odd_fma = even_odd_scheme<true>;
+
+template <typename Scheme = horner, typename T, typename C, std::size_t N>
+constexpr T eval(T x, const std::array<C, N>& c) noexcept {
+    static_assert(N > 0, "a polynomial needs at least one coefficient");
+    return Scheme::run(x, c);
+}
+
+template <typename Scheme = horner, typename T, typename... C>
+    requires (sizeof...(C) > 0 && (std::is_arithmetic_v<C> && ...))
+constexpr T eval(T x, C... c) noexcept {
+    return Scheme::run(x, std::array<std::common_type_t<C...>, sizeof...(C)>{ c... });
+}
+
+} // namespace poly
+} // namespace fast
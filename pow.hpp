@@ -1,28 +1,41 @@
 #pragma once
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include "simd.hpp"
+#include "instrument.hpp"
 
 namespace fast {
 namespace pow {
 
-static inline float stl(float a, float b) noexcept { return std::powf(a, b); }
+static inline float stl(float a, float b) noexcept { FASTMATHS_PROBE(a); return std::pow(a, b); }
+
+// The high 32 bits of a double, sign & exponent & the top of the
+// significand, & a double from them with the low bits 0. What the ankerl pows
+// did with a union of a double & two ints, which assumed little endian
+constexpr int __high(double a) noexcept { return int(std::bit_cast<std::uint64_t>(a) >> 32); }
+constexpr double __with_high(double hi) noexcept {
+    return std::bit_cast<double>(std::uint64_t(std::uint32_t(int(hi))) << 32);
+}
 
 // https://martin.ankerl.com/2007/10/04/optimized-pow-approximation-for-java-and-c-c/
 // meant for doubles
-static inline double ankerl64(double a, double b) {
-    union { double d; int x[2]; } u = { a };
-    u.x[1] = (int)(b * (u.x[1] - 1072632447) + 1072632447);
-    u.x[0] = 0;
-    return u.d;
+constexpr double ankerl64(double a, double b) noexcept {
+    FASTMATHS_PROBE_DOMAIN(a, 0x1p-126f, 0x1.fffffep127f);
+    return __with_high(b * (__high(a) - 1072632447) + 1072632447);
 }
 
 // NOTE: while loop can cause infinite loops. Not recommended!
+// See ladder below for a bounded version.
 // https://martin.ankerl.com/2012/01/25/optimized-approximative-pow-in-c-and-cpp/
 // should be much more precise with large b
-static inline double ankerl_precise64(double a, double b) {
+constexpr double ankerl_precise64(double a, double b) noexcept {
+    FASTMATHS_PROBE_DOMAIN(a, 0x1p-126f, 0x1.fffffep127f);
     // calculate approximation with fraction of the exponent
     int e = (int) b;
-    union { double d; int x[2]; } u = { a };
-    u.x[1] = (int)((b - e) * (u.x[1] - 1072632447) + 1072632447);
-    u.x[0] = 0;
+    const double u = __with_high((b - e) * (__high(a) - 1072632447) + 1072632447);
 
     // exponentiation by squaring with the exponent's integer part
     // double r = u.d makes everything much slower, not sure why
@@ -35,35 +48,33 @@ static inline double ankerl_precise64(double a, double b) {
         e >>= 1;
     }
 
-    return r * u.d;
+    return r * u;
 }
 
 // https://github.com/ekmett/approximate/blob/master/cbits/fast.c
 /* 1065353216 + 1      = 1065353217 ub */
 /* 1065353216 - 486411 = 1064866805 min RMSE */
 /* 1065353216 - 722019 = 1064631197 lb */
-static inline float ekmett_fast(float a, float b) noexcept {
-    union { float d; int x; } u = { a };
-    u.x = (int)(b * (u.x - 1064866805) + 1064866805);
-    return u.d;
+constexpr float ekmett_fast(float a, float b) noexcept {
+    FASTMATHS_PROBE_DOMAIN(a, 0x1p-126f, 0x1.fffffep127f);
+    return std::bit_cast<float>((int)(b * (std::bit_cast<int>(a) - 1064866805) + 1064866805));
 }
 
-static inline float ekmett_fast_lb(float a, float b) noexcept {
-    union { float d; int x; } u = { a };
-    u.x = (int)(b * (u.x - 1065353217) + 1064631197);
-    return u.d;
+constexpr float ekmett_fast_lb(float a, float b) noexcept {
+    FASTMATHS_PROBE_DOMAIN(a, 0x1p-126f, 0x1.fffffep127f);
+    return std::bit_cast<float>((int)(b * (std::bit_cast<int>(a) - 1065353217) + 1064631197));
 }
 
-static inline float ekmett_fast_ub(float a, float b) noexcept {
-    union { float d; int x; } u = { a };
-    u.x = (int)(b * (u.x - 1064631197) + 1065353217);
-    return u.d;
+constexpr float ekmett_fast_ub(float a, float b) noexcept {
+    FASTMATHS_PROBE_DOMAIN(a, 0x1p-126f, 0x1.fffffep127f);
+    return std::bit_cast<float>((int)(b * (std::bit_cast<int>(a) - 1064631197) + 1065353217));
 }
 
 // https://github.com/ekmett/approximate/blob/master/cbits/fast.c
 /* should be much more precise with large b */
 // slower than stl
-static inline float ekmett_fast_precise(float a, float b) {
+constexpr float ekmett_fast_precise(float a, float b) noexcept {
+    FASTMATHS_PROBE_DOMAIN(a, 0x1p-126f, 0x1.fffffep127f);
     int flipped = 0;
     if (b < 0) {
         flipped = 1;
@@ -72,8 +83,7 @@ static inline float ekmett_fast_precise(float a, float b) {
 
     /* calculate approximation with fraction of the exponent */
     int e = (int) b;
-    union { float f; int x; } u = { a };
-    u.x = (int)((b - e) * (u.x - 1065353216) + 1065353216);
+    const float u = std::bit_cast<float>((int)((b - e) * (std::bit_cast<int>(a) - 1065353216) + 1065353216));
 
     float r = 1.0f;
     while (e) {
@@ -84,20 +94,18 @@ static inline float ekmett_fast_precise(float a, float b) {
         e >>= 1;
     }
 
-    r *= u.f;
+    r *= u;
     return flipped ? (1.0f / r) : r;
 }
 
 // https://github.com/ekmett/approximate/blob/master/cbits/fast.c
 /* should be much more precise with large b */
 // slower than stl
-static inline float __better_expf_fast(float a) {
-    union { float f; int x; } u, v;
-    u.x = (int)(6051102 * a + 1056478197);
-    v.x = (int)(1056478197 - 6051102 * a);
-    return u.f / v.f;
+constexpr float __better_expf_fast(float a) noexcept {
+    return std::bit_cast<float>((int)(6051102 * a + 1056478197)) / std::bit_cast<float>((int)(1056478197 - 6051102 * a));
 }
-static inline float ekmett_fast_better_precise(float a, float b) {
+constexpr float ekmett_fast_better_precise(float a, float b) noexcept {
+    FASTMATHS_PROBE_DOMAIN(a, 0x1p-126f, 0x1.fffffep127f);
     int flipped = 0;
     if (b < 0) {
         flipped = 1;
@@ -121,6 +129,168 @@ static inline float ekmett_fast_better_precise(float a, float b) {
     return flipped ? 1.0f/r : r;
 }
 
+// x^N for an integer N known at compile time, by squaring unrolled at compile
+// time, eg. x^5 is (x^2)^2 x in three multiplies. A negative N costs one
+// divide at the end. T is float, double or simd::f32, eg. waveshaping terms
+//   pow::integer<3>(x)
+template <int N, typename T>
+constexpr T __integer(T x) noexcept {
+    if constexpr (N < 0) {
+        return T(1.0f) / __integer<-N>(x);
+    } else if constexpr (N == 0) {
+        return T(1.0f);
+    } else if constexpr (N == 1) {
+        return x;
+    } else {
+        const T h = __integer<N / 2>(x);
+        if constexpr (N % 2) return h * h * x;
+        else return h * h;
+    }
+}
+
+template <int N, typename T>
+constexpr T integer(T x) noexcept {
+    FASTMATHS_PROBE(x);
+    return __integer<N>(x);
+}
+
+// a^e for integers 0 <= e < 2^Bits. Square & multiply, selecting instead of
+// branching on each bit so that it vectorises. At most Bits rounds, fewer
+// once no lane has bits left: squaring on past them makes denormals of small
+// a, which cost the vector versions 15 times as much
+template <int Bits, typename T, typename I>
+constexpr T __ladder(T a, I e) noexcept {
+    T r(1.0f);
+    for (int k = 0; k < Bits && simd::any(e > I((std::int32_t(1) << k) - 1)); k++) {
+        r = r * simd::select((e & I(std::int32_t(1) << k)) == I(0), T(1.0f), a);
+        a = a * a;
+    }
+    return r;
+}
+
+// a^b for a > 0, ekmett_fast_precise without its loop & bit for bit the same
+// for |b| < 2^Bits. The integer part of b goes through __ladder, the
+// fraction through the exponent bits. |b| of 2^Bits or more is NaN rather
+// than a wrong number. The rounds stop at the largest integer part in the
+// vector, so the default 24, as far as floats step by 1, costs small b
+// nothing. T is float or simd::f32
+template <int Bits = 24, typename T>
+constexpr T ladder(T a, T b) noexcept {
+    static_assert(Bits > 0 && Bits < 25, "integer parts up to 2^24");
+    FASTMATHS_PROBE_DOMAIN(a, 0x1p-126f, 0x1.fffffep127f);
+    using I = simd::int_t<T>;
+    const T limit(float(std::int32_t(1) << Bits));
+    const T m = simd::min(simd::abs(b), limit - T(1.0f));
+    const I e = simd::to_i32(m);
+    const T scale = simd::to_f32(simd::as_i32(a) - I(1065353216));
+    const T f = simd::as_f32(simd::to_i32((m - simd::to_f32(e)) * scale + T(1065353216.0f)));
+    const T r = f * __ladder<Bits>(a, e);
+    const T nan(std::numeric_limits<float>::quiet_NaN());
+    return simd::select(simd::abs(b) < limit, simd::select(b < T(0.0f), T(1.0f) / r, r), nan);
+}
+
+// ln(x) during constant evaluation, where std::log isn't usable. The exponent
+// times ln 2, plus 2 atanh((m - 1) / (m + 1)) for the significand m in [1, 2)
+constexpr double __ln(double x) noexcept {
+    int e = 0;
+    while (x >= 2.0) { x *= 0.5; e++; }
+    while (x < 1.0) { x *= 2.0; e--; }
+    const double y = (x - 1.0) / (x + 1.0), y2 = y * y;
+    double term = y, sum = 0.0;
+    for (int k = 1; k < 60; k += 2) {
+        sum += term / k;
+        term *= y2;
+    }
+    return e * 0.693147180559945309417 + 2.0 * sum;
+}
+
+// The ekmett pows above for a Base known at compile time, eg. a semitone
+// ratio or a decay coefficient. The base's bits, the scales & ln(Base) fold
+// into constants, like the hand folded 27262975 of exp10::powx_ekmett_fast_lb
+// that const_base<10.0f>::fast_lb replaces, and the precise versions swap the
+// loop over the exponent's bits for a fixed ladder of Base^(2^k) constants,
+// so they vectorise. T is float or simd::f32:
+//   pow::const_base<1.05946309f>::fast(semitones)
+//   batch::transform(in, out, n, [](auto x) { return pow::const_base<0.999f>::precise(x); });
+// Base must be positive
+template <float Base>
+struct const_base {
+    static_assert(Base > 0.0f && Base <= std::numeric_limits<float>::max(), "Base must be positive & finite");
+
+    static constexpr std::int32_t bits = std::bit_cast<std::int32_t>(Base);
+
+    template <typename T>
+    static constexpr T fast(T b) noexcept { return __scaled(b, bits - 1064866805, 1064866805); }
+    template <typename T>
+    static constexpr T fast_lb(T b) noexcept { return __scaled(b, bits - 1065353217, 1064631197); }
+    template <typename T>
+    static constexpr T fast_ub(T b) noexcept { return __scaled(b, bits - 1064631197, 1065353217); }
+
+    // for |b| up to 2^24 at most. Past where Base^b leaves float's range the
+    // ladder saturates to inf or 0
+    template <typename T>
+    static constexpr T precise(T b) noexcept {
+        const T a = simd::min(simd::abs(b), T(float(__max_e)));
+        const simd::int_t<T> e = simd::to_i32(a);
+        const T r = __scaled(a - simd::to_f32(e), bits - 1065353216, 1065353216) * __ladder(e);
+        return simd::select(b < T(0.0f), T(1.0f) / r, r);
+    }
+
+    // pow::ekmett_fast_better_precise's e^x on the fraction, scaled by ln(Base).
+    // That one leaves the ln out, so it's only right for e
+    template <typename T>
+    static constexpr T better_precise(T b) noexcept {
+        using I = simd::int_t<T>;
+        const T a = simd::min(simd::abs(b), T(float(__max_e)));
+        const I e = simd::to_i32(a);
+        const T s = (a - simd::to_f32(e)) * T(__better_scale);
+        const T u = simd::as_f32(simd::to_i32(s + T(1056478197.0f)));
+        const T v = simd::as_f32(simd::to_i32(T(1056478197.0f) - s));
+        const T r = u / v * __ladder(e);
+        return simd::select(b < T(0.0f), T(1.0f) / r, r);
+    }
+
+    // (int)(b * scale + offset) as a float's bits, as in the scalar versions
+    template <typename T>
+    static constexpr T __scaled(T b, std::int32_t scale, std::int32_t offset) noexcept {
+        return simd::as_f32(simd::to_i32(b * T(float(scale)) + T(float(offset))));
+    }
+
+    // Base^(2^k) for as many k as it takes Base^(2^k) to leave float's normal
+    // range, which is then inf or 0, and at most 25
+    static constexpr int __max_rounds = 25;
+    static constexpr std::array<float, __max_rounds> __powers = [] {
+        std::array<float, __max_rounds> p{};
+        double v = Base;
+        for (int k = 0; k < __max_rounds; k++) {
+            if (v > std::numeric_limits<float>::max()) p[k] = std::numeric_limits<float>::infinity();
+            else if (v < std::numeric_limits<float>::min()) p[k] = 0.0f;
+            else p[k] = float(v);
+            v = v > 1e100 ? v : v * v; // past float already, & squaring on could overflow double
+        }
+        return p;
+    }();
+    static constexpr int __rounds = [] {
+        int k = 0;
+        while (k + 1 < __max_rounds && __powers[k] != 0.0f && __powers[k] != std::numeric_limits<float>::infinity())
+            k++;
+        return k + 1;
+    }();
+    static constexpr std::int32_t __max_e = (std::int32_t(1) << __rounds) - 1;
+
+    static constexpr float __better_scale = float(6051102.0 * __ln(Base));
+
+    // Base^e for 0 <= e <= __max_e, a multiply per bit of e
+    template <typename I>
+    static constexpr auto __ladder(I e) noexcept {
+        using T = decltype(simd::to_f32(e));
+        const I capped = simd::min(e, I(__max_e));
+        T r(1.0f);
+        for (int k = 0; k < __rounds; k++)
+            r = r * simd::select((capped & I(std::int32_t(1) << k)) == I(0), T(1.0f), T(__powers[k]));
+        return r;
+    }
+};
 
 } // namespace pow
 } // namespace fast
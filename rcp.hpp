@@ -0,0 +1,93 @@
+#pragma once
+#include "simd.hpp"
+#include "instrument.hpp"
+
+// Division free 1/x & a / b, for kernels that end in a divide.
+// A divide has several times the latency of a multiply & can only start every
+// few cycles, while the estimate instructions are about as cheap as a
+// multiply. Each Newton-Raphson step roughly doubles the correct bits of
+// simd::rcp_estimate:
+//
+//   float        4 bits, from the bits. 3 steps for full precision
+//   simd::f32   14 bits with AVX-512 (rcp14), 11 bits with SSE/AVX (rcpps),
+//                4 bits in the generic build
+//
+// Ask for a precision rather than a number of steps, so that scalar & SIMD
+// code ask for the same thing:
+//   rcp::approx<12>(x)   coarse, the hardware estimate alone
+//   rcp::approx<22>(x)   within an ulp or two, the default
+//   rcp::approx<24>(x)   as many steps as reach 24 bits, but rounding keeps it
+//                        to about 1.5 ulp without FMA & 1 ulp with. For
+//                        scalar float it's the same 3 steps as approx<22>
+// T can be float or simd::f32. Only for normal |x| < 2^125, which covers
+// denominators that stay away from 0 & from float's top:
+//   0 & denormals  estimated as inf, which the steps turn into NaN
+//   |x| >= 2^125   the magic constant goes denormal, then negative past
+//                  2^126, so scalar 1/3e38 is NaN. rcpps flushes to 0 there
+
+namespace fast {
+namespace rcp {
+
+// correct bits of simd::rcp_estimate, rounded down. simd::rsqrt_estimate has
+// the same on every instruction set, so sqrt.hpp counts its steps with this too
+template <typename T>
+inline constexpr int estimate_bits = 4;
+#if defined(FASTMATHS_SIMD_AVX512)
+template <>
+inline constexpr int estimate_bits<simd::f32> = 14;
+#elif defined(FASTMATHS_SIMD_AVX2) || defined(FASTMATHS_SIMD_SSE2)
+template <>
+inline constexpr int estimate_bits<simd::f32> = 11;
+#endif
+
+// Newton-Raphson steps from estimate_bits to Bits
+template <typename T>
+constexpr int steps_for(int bits) noexcept {
+    int steps = 0;
+    for (int have = estimate_bits<T>; have < bits; have *= 2)
+        steps++;
+    return steps;
+}
+
+// https://en.wikipedia.org/wiki/Division_algorithm#Newton%E2%80%93Raphson_division
+// written as y + y (1 - x y), which rounds better than y (2 - x y) on the last
+// step & becomes two FMAs where available
+template <int Steps = 1, typename T>
+constexpr T newton(T x) noexcept {
+    static_assert(Steps >= 0, "Steps is the number of Newton-Raphson refinements");
+    T y = simd::rcp_estimate(x);
+    for (int i = 0; i < Steps; i++)
+        y = y + y * (T(1.0f) - x * y);
+    return y;
+}
+
+// 1 / x to at least Bits correct bits
+template <int Bits = 22, typename T>
+constexpr T approx(T x) noexcept {
+    static_assert(Bits >= 1 && Bits <= 24, "a float has 24 bits");
+    FASTMATHS_PROBE(x);
+    return newton<steps_for<T>(Bits)>(x);
+}
+
+// a / b as a * (1 / b)
+template <int Bits = 22, typename T>
+constexpr T div(T a, T b) noexcept {
+    return a * approx<Bits>(b);
+}
+
+// How a kernel that ends in a divide divides, so that one set of
+// coefficients serves both: exact is a / b & divider<Bits> rcp::div<Bits>
+//   sin::pade<float, rcp::divider<12>>(x)
+struct exact {
+    template <typename T>
+    static constexpr T div(T a, T b) noexcept { return a / b; }
+};
+
+template <int Bits>
+struct divider {
+    template <typename T>
+    static constexpr T div(T a, T b) noexcept { return rcp::div<Bits>(a, b); }
+};
+
+} // namespace rcp
+} // namespace fast
@@ -0,0 +1,569 @@
+#pragma once
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// Minimal SIMD layer for the batch kernels.
+// simd::f32 / simd::i32 are the widest float & int vectors the build targets:
+//   AVX-512F -> 16 lanes, AVX2 -> 8 lanes, SSE2 -> 4 lanes, otherwise a plain
+//   4 lane array. Define FASTMATHS_SIMD_GENERIC to force the plain version.
+// Every operation also has a scalar overload, so a kernel written as a
+// template works for both float and simd::f32. Comparisons return a mask
+// (bool for scalars), combine masks with & | ~ and consume them with select().
+
+#if !defined(FASTMATHS_SIMD_GENERIC)
+#if defined(__AVX512F__)
+#define FASTMATHS_SIMD_AVX512 1
+#elif defined(__AVX2__)
+#define FASTMATHS_SIMD_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FASTMATHS_SIMD_SSE2 1
+#else
+#define FASTMATHS_SIMD_GENERIC 1
+#endif
+#endif
+
+#if !defined(FASTMATHS_SIMD_GENERIC)
+#include <immintrin.h>
+#endif
+
+namespace fast {
+namespace simd {
+
+/** SCALAR */
+
+// Float selects are done with bit masks rather than ?: which GCC tends to
+// turn into branches without -ffast-math, stopping loops from vectorising
+constexpr float select(bool m, float a, float b) noexcept {
+    const std::int32_t mask = -std::int32_t(m);
+    return std::bit_cast<float>((std::bit_cast<std::int32_t>(a) & mask) | (std::bit_cast<std::int32_t>(b) & ~mask));
+}
+constexpr double select(bool m, double a, double b) noexcept { return m ? a : b; }
+constexpr std::int32_t select(bool m, std::int32_t a, std::int32_t b) noexcept { return m ? a : b; }
+
+// a * b + c with a single rounding. Falls back to plain arithmetic during
+// constant evaluation, where std::fma isn't usable
+constexpr float fma(float a, float b, float c) noexcept {
+    if (std::is_constant_evaluated()) return a * b + c;
+    return std::fma(a, b, c);
+}
+constexpr double fma(double a, double b, double c) noexcept {
+    if (std::is_constant_evaluated()) return a * b + c;
+    return std::fma(a, b, c);
+}
+
+constexpr float min(float a, float b) noexcept { return select(a < b, a, b); }
+constexpr float max(float a, float b) noexcept { return select(a > b, a, b); }
+constexpr std::int32_t min(std::int32_t a, std::int32_t b) noexcept { return a < b ? a : b; }
+constexpr std::int32_t max(std::int32_t a, std::int32_t b) noexcept { return a > b ? a : b; }
+constexpr float abs(float x) noexcept { return std::bit_cast<float>(std::bit_cast<std::uint32_t>(x) & 0x7fffffffu); }
+inline float sqrt(float x) noexcept { return std::sqrt(x); }
+inline float floor(float x) noexcept { return std::floor(x); }
+inline float round(float x) noexcept { return std::nearbyint(x); } // to nearest even, like cvtps2dq
+
+// 1/x to 4 bits, by negating the exponent with a magic constant like quake's
+// rsqrt. Not rcpss, which GCC can't vectorise, so loops over the scalar
+// version still run as SIMD. Only for normal |x| < 2^125, see rcp.hpp for
+// that & the refined versions
+constexpr float rcp_estimate(float x) noexcept { return std::bit_cast<float>(0x7ef311c3 - std::bit_cast<std::int32_t>(x)); }
+// 1/sqrt(x) to 4 bits, quake's magic constant. See sqrt.hpp for the refined versions
+// https://en.wikipedia.org/wiki/Fast_inverse_square_root
+constexpr float rsqrt_estimate(float x) noexcept { return std::bit_cast<float>(0x5f3759df - (std::bit_cast<std::int32_t>(x) >> 1)); }
+
+constexpr std::int32_t as_i32(float x) noexcept { return std::bit_cast<std::int32_t>(x); }
+constexpr float as_f32(std::int32_t x) noexcept { return std::bit_cast<float>(x); }
+constexpr std::int32_t to_i32(float x) noexcept { return static_cast<std::int32_t>(x); } // truncates
+constexpr float to_f32(std::int32_t x) noexcept { return static_cast<float>(x); }
+
+constexpr float gather(const float* table, std::int32_t i) noexcept { return table[i]; }
+constexpr std::int32_t gather(const std::int32_t* table, std::int32_t i) noexcept { return table[i]; }
+
+constexpr bool any(bool m) noexcept { return m; }
+constexpr bool all(bool m) noexcept { return m; }
+constexpr float reduce_add(float x) noexcept { return x; }
+constexpr float reduce_max(float x) noexcept { return x; }
+
+#if defined(FASTMATHS_SIMD_AVX512)
+
+/** AVX-512 */
+
+struct mask {
+    __mmask16 m;
+};
+
+struct f32 {
+    static constexpr int size = 16;
+    __m512 v;
+    f32() = default;
+    f32(__m512 x) noexcept : v(x) {}
+    f32(float x) noexcept : v(_mm512_set1_ps(x)) {}
+    static f32 load(const float* p) noexcept { return _mm512_loadu_ps(p); }
+    static f32 load_aligned(const float* p) noexcept { return _mm512_load_ps(p); }
+    void store(float* p) const noexcept { _mm512_storeu_ps(p, v); }
+    void store_aligned(float* p) const noexcept { _mm512_store_ps(p, v); }
+};
+
+struct i32 {
+    static constexpr int size = 16;
+    __m512i v;
+    i32() = default;
+    i32(__m512i x) noexcept : v(x) {}
+    i32(std::int32_t x) noexcept : v(_mm512_set1_epi32(x)) {}
+    static i32 load(const std::int32_t* p) noexcept { return _mm512_loadu_si512(p); }
+    void store(std::int32_t* p) const noexcept { _mm512_storeu_si512(p, v); }
+};
+
+inline f32 operator+(f32 a, f32 b) noexcept { return _mm512_add_ps(a.v, b.v); }
+inline f32 operator-(f32 a, f32 b) noexcept { return _mm512_sub_ps(a.v, b.v); }
+inline f32 operator*(f32 a, f32 b) noexcept { return _mm512_mul_ps(a.v, b.v); }
+inline f32 operator/(f32 a, f32 b) noexcept { return _mm512_div_ps(a.v, b.v); }
+inline f32 operator-(f32 a) noexcept { return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(a.v), _mm512_set1_epi32(INT32_MIN))); }
+inline f32 operator&(f32 a, f32 b) noexcept { return _mm512_castsi512_ps(_mm512_and_si512(_mm512_castps_si512(a.v), _mm512_castps_si512(b.v))); }
+inline f32 operator|(f32 a, f32 b) noexcept { return _mm512_castsi512_ps(_mm512_or_si512(_mm512_castps_si512(a.v), _mm512_castps_si512(b.v))); }
+inline f32 operator^(f32 a, f32 b) noexcept { return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(a.v), _mm512_castps_si512(b.v))); }
+inline mask operator<(f32 a, f32 b) noexcept { return { _mm512_cmp_ps_mask(a.v, b.v, _CMP_LT_OQ) }; }
+inline mask operator<=(f32 a, f32 b) noexcept { return { _mm512_cmp_ps_mask(a.v, b.v, _CMP_LE_OQ) }; }
+inline mask operator>(f32 a, f32 b) noexcept { return { _mm512_cmp_ps_mask(a.v, b.v, _CMP_GT_OQ) }; }
+inline mask operator>=(f32 a, f32 b) noexcept { return { _mm512_cmp_ps_mask(a.v, b.v, _CMP_GE_OQ) }; }
+inline mask operator==(f32 a, f32 b) noexcept { return { _mm512_cmp_ps_mask(a.v, b.v, _CMP_EQ_OQ) }; }
+inline mask operator!=(f32 a, f32 b) noexcept { return { _mm512_cmp_ps_mask(a.v, b.v, _CMP_NEQ_UQ) }; }
+
+inline i32 operator+(i32 a, i32 b) noexcept { return _mm512_add_epi32(a.v, b.v); }
+inline i32 operator-(i32 a, i32 b) noexcept { return _mm512_sub_epi32(a.v, b.v); }
+inline i32 operator&(i32 a, i32 b) noexcept { return _mm512_and_si512(a.v, b.v); }
+inline i32 operator|(i32 a, i32 b) noexcept { return _mm512_or_si512(a.v, b.v); }
+inline i32 operator^(i32 a, i32 b) noexcept { return _mm512_xor_si512(a.v, b.v); }
+inline i32 operator<<(i32 a, int n) noexcept { return _mm512_sll_epi32(a.v, _mm_cvtsi32_si128(n)); }
+inline i32 operator>>(i32 a, int n) noexcept { return _mm512_sra_epi32(a.v, _mm_cvtsi32_si128(n)); } // arithmetic
+inline mask operator<(i32 a, i32 b) noexcept { return { _mm512_cmplt_epi32_mask(a.v, b.v) }; }
+inline mask operator>(i32 a, i32 b) noexcept { return { _mm512_cmpgt_epi32_mask(a.v, b.v) }; }
+inline mask operator==(i32 a, i32 b) noexcept { return { _mm512_cmpeq_epi32_mask(a.v, b.v) }; }
+
+inline mask operator&(mask a, mask b) noexcept { return { __mmask16(a.m & b.m) }; }
+inline mask operator|(mask a, mask b) noexcept { return { __mmask16(a.m | b.m) }; }
+inline mask operator^(mask a, mask b) noexcept { return { __mmask16(a.m ^ b.m) }; }
+inline mask operator~(mask a) noexcept { return { __mmask16(~a.m) }; }
+inline bool any(mask a) noexcept { return a.m != 0; }
+inline bool all(mask a) noexcept { return a.m == 0xffff; }
+
+inline f32 select(mask m, f32 a, f32 b) noexcept { return _mm512_mask_blend_ps(m.m, b.v, a.v); }
+inline i32 select(mask m, i32 a, i32 b) noexcept { return _mm512_mask_blend_epi32(m.m, b.v, a.v); }
+inline f32 fma(f32 a, f32 b, f32 c) noexcept { return _mm512_fmadd_ps(a.v, b.v, c.v); }
+inline f32 min(f32 a, f32 b) noexcept { return _mm512_min_ps(a.v, b.v); }
+inline f32 max(f32 a, f32 b) noexcept { return _mm512_max_ps(a.v, b.v); }
+inline i32 min(i32 a, i32 b) noexcept { return _mm512_min_epi32(a.v, b.v); }
+inline i32 max(i32 a, i32 b) noexcept { return _mm512_max_epi32(a.v, b.v); }
+inline f32 abs(f32 x) noexcept { return _mm512_castsi512_ps(_mm512_and_si512(_mm512_castps_si512(x.v), _mm512_set1_epi32(0x7fffffff))); }
+inline f32 sqrt(f32 x) noexcept { return _mm512_sqrt_ps(x.v); }
+inline f32 rcp_estimate(f32 x) noexcept { return _mm512_rcp14_ps(x.v); } // 14 bits
+inline f32 rsqrt_estimate(f32 x) noexcept { return _mm512_rsqrt14_ps(x.v); } // 14 bits
+inline f32 floor(f32 x) noexcept { return _mm512_roundscale_ps(x.v, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC); }
+inline f32 round(f32 x) noexcept { return _mm512_roundscale_ps(x.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+
+inline i32 as_i32(f32 x) noexcept { return _mm512_castps_si512(x.v); }
+inline f32 as_f32(i32 x) noexcept { return _mm512_castsi512_ps(x.v); }
+inline i32 to_i32(f32 x) noexcept { return _mm512_cvttps_epi32(x.v); }
+inline f32 to_f32(i32 x) noexcept { return _mm512_cvtepi32_ps(x.v); }
+
+inline f32 gather(const float* table, i32 i) noexcept { return _mm512_i32gather_ps(i.v, table, 4); }
+inline i32 gather(const std::int32_t* table, i32 i) noexcept { return _mm512_i32gather_epi32(i.v, table, 4); }
+
+// splits the 2 * size floats of a then b, eg. complex numbers, into the even
+// & odd ones. interleave is the inverse
+inline void deinterleave(f32 a, f32 b, f32& even, f32& odd) noexcept {
+    even = _mm512_permutex2var_ps(a.v, _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30), b.v);
+    odd = _mm512_permutex2var_ps(a.v, _mm512_setr_epi32(1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31), b.v);
+}
+inline void interleave(f32 even, f32 odd, f32& a, f32& b) noexcept {
+    a = _mm512_permutex2var_ps(even.v, _mm512_setr_epi32(0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23), odd.v);
+    b = _mm512_permutex2var_ps(even.v, _mm512_setr_epi32(8, 24, 9, 25, 10, 26, 11, 27, 12, 28, 13, 29, 14, 30, 15, 31), odd.v);
+}
+
+inline float reduce_add(f32 x) noexcept { return _mm512_reduce_add_ps(x.v); }
+inline float reduce_max(f32 x) noexcept { return _mm512_reduce_max_ps(x.v); }
+
+#elif defined(FASTMATHS_SIMD_AVX2)
+
+/** AVX2 */
+
+struct mask {
+    __m256 m; // all bits set in true lanes
+};
+
+struct f32 {
+    static constexpr int size = 8;
+    __m256 v;
+    f32() = default;
+    f32(__m256 x) noexcept : v(x) {}
+    f32(float x) noexcept : v(_mm256_set1_ps(x)) {}
+    static f32 load(const float* p) noexcept { return _mm256_loadu_ps(p); }
+    static f32 load_aligned(const float* p) noexcept { return _mm256_load_ps(p); }
+    void store(float* p) const noexcept { _mm256_storeu_ps(p, v); }
+    void store_aligned(float* p) const noexcept { _mm256_store_ps(p, v); }
+};
+
+struct i32 {
+    static constexpr int size = 8;
+    __m256i v;
+    i32() = default;
+    i32(__m256i x) noexcept : v(x) {}
+    i32(std::int32_t x) noexcept : v(_mm256_set1_epi32(x)) {}
+    static i32 load(const std::int32_t* p) noexcept { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+    void store(std::int32_t* p) const noexcept { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+};
+
+inline f32 operator+(f32 a, f32 b) noexcept { return _mm256_add_ps(a.v, b.v); }
+inline f32 operator-(f32 a, f32 b) noexcept { return _mm256_sub_ps(a.v, b.v); }
+inline f32 operator*(f32 a, f32 b) noexcept { return _mm256_mul_ps(a.v, b.v); }
+inline f32 operator/(f32 a, f32 b) noexcept { return _mm256_div_ps(a.v, b.v); }
+inline f32 operator-(f32 a) noexcept { return _mm256_xor_ps(a.v, _mm256_set1_ps(-0.0f)); }
+inline f32 operator&(f32 a, f32 b) noexcept { return _mm256_and_ps(a.v, b.v); }
+inline f32 operator|(f32 a, f32 b) noexcept { return _mm256_or_ps(a.v, b.v); }
+inline f32 operator^(f32 a, f32 b) noexcept { return _mm256_xor_ps(a.v, b.v); }
+inline mask operator<(f32 a, f32 b) noexcept { return { _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ) }; }
+inline mask operator<=(f32 a, f32 b) noexcept { return { _mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ) }; }
+inline mask operator>(f32 a, f32 b) noexcept { return { _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ) }; }
+inline mask operator>=(f32 a, f32 b) noexcept { return { _mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ) }; }
+inline mask operator==(f32 a, f32 b) noexcept { return { _mm256_cmp_ps(a.v, b.v, _CMP_EQ_OQ) }; }
+inline mask operator!=(f32 a, f32 b) noexcept { return { _mm256_cmp_ps(a.v, b.v, _CMP_NEQ_UQ) }; }
+
+inline i32 operator+(i32 a, i32 b) noexcept { return _mm256_add_epi32(a.v, b.v); }
+inline i32 operator-(i32 a, i32 b) noexcept { return _mm256_sub_epi32(a.v, b.v); }
+inline i32 operator&(i32 a, i32 b) noexcept { return _mm256_and_si256(a.v, b.v); }
+inline i32 operator|(i32 a, i32 b) noexcept { return _mm256_or_si256(a.v, b.v); }
+inline i32 operator^(i32 a, i32 b) noexcept { return _mm256_xor_si256(a.v, b.v); }
+inline i32 operator<<(i32 a, int n) noexcept { return _mm256_sll_epi32(a.v, _mm_cvtsi32_si128(n)); }
+inline i32 operator>>(i32 a, int n) noexcept { return _mm256_sra_epi32(a.v, _mm_cvtsi32_si128(n)); } // arithmetic
+inline mask operator<(i32 a, i32 b) noexcept { return { _mm256_castsi256_ps(_mm256_cmpgt_epi32(b.v, a.v)) }; }
+inline mask operator>(i32 a, i32 b) noexcept { return { _mm256_castsi256_ps(_mm256_cmpgt_epi32(a.v, b.v)) }; }
+inline mask operator==(i32 a, i32 b) noexcept { return { _mm256_castsi256_ps(_mm256_cmpeq_epi32(a.v, b.v)) }; }
+
+inline mask operator&(mask a, mask b) noexcept { return { _mm256_and_ps(a.m, b.m) }; }
+inline mask operator|(mask a, mask b) noexcept { return { _mm256_or_ps(a.m, b.m) }; }
+inline mask operator^(mask a, mask b) noexcept { return { _mm256_xor_ps(a.m, b.m) }; }
+inline mask operator~(mask a) noexcept { return { _mm256_xor_ps(a.m, _mm256_castsi256_ps(_mm256_set1_epi32(-1))) }; }
+inline bool any(mask a) noexcept { return _mm256_movemask_ps(a.m) != 0; }
+inline bool all(mask a) noexcept { return _mm256_movemask_ps(a.m) == 0xff; }
+
+inline f32 select(mask m, f32 a, f32 b) noexcept { return _mm256_blendv_ps(b.v, a.v, m.m); }
+inline i32 select(mask m, i32 a, i32 b) noexcept { return _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(b.v), _mm256_castsi256_ps(a.v), m.m)); }
+#if defined(__FMA__)
+inline f32 fma(f32 a, f32 b, f32 c) noexcept { return _mm256_fmadd_ps(a.v, b.v, c.v); }
+#else
+inline f32 fma(f32 a, f32 b, f32 c) noexcept { return _mm256_add_ps(_mm256_mul_ps(a.v, b.v), c.v); }
+#endif
+inline f32 min(f32 a, f32 b) noexcept { return _mm256_min_ps(a.v, b.v); }
+inline f32 max(f32 a, f32 b) noexcept { return _mm256_max_ps(a.v, b.v); }
+inline i32 min(i32 a, i32 b) noexcept { return _mm256_min_epi32(a.v, b.v); }
+inline i32 max(i32 a, i32 b) noexcept { return _mm256_max_epi32(a.v, b.v); }
+inline f32 abs(f32 x) noexcept { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), x.v); }
+inline f32 sqrt(f32 x) noexcept { return _mm256_sqrt_ps(x.v); }
+inline f32 rcp_estimate(f32 x) noexcept { return _mm256_rcp_ps(x.v); } // 11 bits
+inline f32 rsqrt_estimate(f32 x) noexcept { return _mm256_rsqrt_ps(x.v); } // 11 bits
+inline f32 floor(f32 x) noexcept { return _mm256_floor_ps(x.v); }
+inline f32 round(f32 x) noexcept { return _mm256_round_ps(x.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+
+inline i32 as_i32(f32 x) noexcept { return _mm256_castps_si256(x.v); }
+inline f32 as_f32(i32 x) noexcept { return _mm256_castsi256_ps(x.v); }
+inline i32 to_i32(f32 x) noexcept { return _mm256_cvttps_epi32(x.v); }
+inline f32 to_f32(i32 x) noexcept { return _mm256_cvtepi32_ps(x.v); }
+
+inline f32 gather(const float* table, i32 i) noexcept { return _mm256_i32gather_ps(table, i.v, 4); }
+inline i32 gather(const std::int32_t* table, i32 i) noexcept { return _mm256_i32gather_epi32(reinterpret_cast<const int*>(table), i.v, 4); }
+
+// shuffles within each 128 bit half, then puts the 64 bit pairs back in order
+inline void deinterleave(f32 a, f32 b, f32& even, f32& odd) noexcept {
+    even = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(_mm256_shuffle_ps(a.v, b.v, _MM_SHUFFLE(2, 0, 2, 0))), _MM_SHUFFLE(3, 1, 2, 0)));
+    odd = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(_mm256_shuffle_ps(a.v, b.v, _MM_SHUFFLE(3, 1, 3, 1))), _MM_SHUFFLE(3, 1, 2, 0)));
+}
+// unpacks within each 128 bit half, then swaps the middle halves
+inline void interleave(f32 even, f32 odd, f32& a, f32& b) noexcept {
+    const __m256 lo = _mm256_unpacklo_ps(even.v, odd.v), hi = _mm256_unpackhi_ps(even.v, odd.v);
+    a = _mm256_permute2f128_ps(lo, hi, 0x20);
+    b = _mm256_permute2f128_ps(lo, hi, 0x31);
+}
+
+inline float reduce_add(f32 x) noexcept {
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(x.v), _mm256_extractf128_ps(x.v, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+    return _mm_cvtss_f32(s);
+}
+inline float reduce_max(f32 x) noexcept {
+    __m128 s = _mm_max_ps(_mm256_castps256_ps128(x.v), _mm256_extractf128_ps(x.v, 1));
+    s = _mm_max_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_max_ss(s, _mm_shuffle_ps(s, s, 1));
+    return _mm_cvtss_f32(s);
+}
+
+#elif defined(FASTMATHS_SIMD_SSE2)
+
+/** SSE2, with SSE4.1 where the build allows it */
+
+struct mask {
+    __m128 m; // all bits set in true lanes
+};
+
+struct f32 {
+    static constexpr int size = 4;
+    __m128 v;
+    f32() = default;
+    f32(__m128 x) noexcept : v(x) {}
+    f32(float x) noexcept : v(_mm_set1_ps(x)) {}
+    static f32 load(const float* p) noexcept { return _mm_loadu_ps(p); }
+    static f32 load_aligned(const float* p) noexcept { return _mm_load_ps(p); }
+    void store(float* p) const noexcept { _mm_storeu_ps(p, v); }
+    void store_aligned(float* p) const noexcept { _mm_store_ps(p, v); }
+};
+
+struct i32 {
+    static constexpr int size = 4;
+    __m128i v;
+    i32() = default;
+    i32(__m128i x) noexcept : v(x) {}
+    i32(std::int32_t x) noexcept : v(_mm_set1_epi32(x)) {}
+    static i32 load(const std::int32_t* p) noexcept { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+    void store(std::int32_t* p) const noexcept { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+};
+
+inline f32 operator+(f32 a, f32 b) noexcept { return _mm_add_ps(a.v, b.v); }
+inline f32 operator-(f32 a, f32 b) noexcept { return _mm_sub_ps(a.v, b.v); }
+inline f32 operator*(f32 a, f32 b) noexcept { return _mm_mul_ps(a.v, b.v); }
+inline f32 operator/(f32 a, f32 b) noexcept { return _mm_div_ps(a.v, b.v); }
+inline f32 operator-(f32 a) noexcept { return _mm_xor_ps(a.v, _mm_set1_ps(-0.0f)); }
+inline f32 operator&(f32 a, f32 b) noexcept { return _mm_and_ps(a.v, b.v); }
+inline f32 operator|(f32 a, f32 b) noexcept { return _mm_or_ps(a.v, b.v); }
+inline f32 operator^(f32 a, f32 b) noexcept { return _mm_xor_ps(a.v, b.v); }
+inline mask operator<(f32 a, f32 b) noexcept { return { _mm_cmplt_ps(a.v, b.v) }; }
+inline mask operator<=(f32 a, f32 b) noexcept { return { _mm_cmple_ps(a.v, b.v) }; }
+inline mask operator>(f32 a, f32 b) noexcept { return { _mm_cmpgt_ps(a.v, b.v) }; }
+inline mask operator>=(f32 a, f32 b) noexcept { return { _mm_cmpge_ps(a.v, b.v) }; }
+inline mask operator==(f32 a, f32 b) noexcept { return { _mm_cmpeq_ps(a.v, b.v) }; }
+inline mask operator!=(f32 a, f32 b) noexcept { return { _mm_cmpneq_ps(a.v, b.v) }; }
+
+inline i32 operator+(i32 a, i32 b) noexcept { return _mm_add_epi32(a.v, b.v); }
+inline i32 operator-(i32 a, i32 b) noexcept { return _mm_sub_epi32(a.v, b.v); }
+inline i32 operator&(i32 a, i32 b) noexcept { return _mm_and_si128(a.v, b.v); }
+inline i32 operator|(i32 a, i32 b) noexcept { return _mm_or_si128(a.v, b.v); }
+inline i32 operator^(i32 a, i32 b) noexcept { return _mm_xor_si128(a.v, b.v); }
+inline i32 operator<<(i32 a, int n) noexcept { return _mm_sll_epi32(a.v, _mm_cvtsi32_si128(n)); }
+inline i32 operator>>(i32 a, int n) noexcept { return _mm_sra_epi32(a.v, _mm_cvtsi32_si128(n)); } // arithmetic
+inline mask operator<(i32 a, i32 b) noexcept { return { _mm_castsi128_ps(_mm_cmplt_epi32(a.v, b.v)) }; }
+inline mask operator>(i32 a, i32 b) noexcept { return { _mm_castsi128_ps(_mm_cmpgt_epi32(a.v, b.v)) }; }
+inline mask operator==(i32 a, i32 b) noexcept { return { _mm_castsi128_ps(_mm_cmpeq_epi32(a.v, b.v)) }; }
+
+inline mask operator&(mask a, mask b) noexcept { return { _mm_and_ps(a.m, b.m) }; }
+inline mask operator|(mask a, mask b) noexcept { return { _mm_or_ps(a.m, b.m) }; }
+inline mask operator^(mask a, mask b) noexcept { return { _mm_xor_ps(a.m, b.m) }; }
+inline mask operator~(mask a) noexcept { return { _mm_xor_ps(a.m, _mm_castsi128_ps(_mm_set1_epi32(-1))) }; }
+inline bool any(mask a) noexcept { return _mm_movemask_ps(a.m) != 0; }
+inline bool all(mask a) noexcept { return _mm_movemask_ps(a.m) == 0xf; }
+
+#if defined(__SSE4_1__)
+inline f32 select(mask m, f32 a, f32 b) noexcept { return _mm_blendv_ps(b.v, a.v, m.m); }
+#else
+inline f32 select(mask m, f32 a, f32 b) noexcept { return _mm_or_ps(_mm_and_ps(m.m, a.v), _mm_andnot_ps(m.m, b.v)); }
+#endif
+inline i32 select(mask m, i32 a, i32 b) noexcept {
+    const __m128i mi = _mm_castps_si128(m.m);
+    return _mm_or_si128(_mm_and_si128(mi, a.v), _mm_andnot_si128(mi, b.v));
+}
+#if defined(__FMA__)
+inline f32 fma(f32 a, f32 b, f32 c) noexcept { return _mm_fmadd_ps(a.v, b.v, c.v); }
+#else
+inline f32 fma(f32 a, f32 b, f32 c) noexcept { return _mm_add_ps(_mm_mul_ps(a.v, b.v), c.v); }
+#endif
+inline f32 min(f32 a, f32 b) noexcept { return _mm_min_ps(a.v, b.v); }
+inline f32 max(f32 a, f32 b) noexcept { return _mm_max_ps(a.v, b.v); }
+inline i32 min(i32 a, i32 b) noexcept { return select(a < b, a, b); }
+inline i32 max(i32 a, i32 b) noexcept { return select(a > b, a, b); }
+inline f32 abs(f32 x) noexcept { return _mm_andnot_ps(_mm_set1_ps(-0.0f), x.v); }
+inline f32 sqrt(f32 x) noexcept { return _mm_sqrt_ps(x.v); }
+inline f32 rcp_estimate(f32 x) noexcept { return _mm_rcp_ps(x.v); } // 11 bits
+inline f32 rsqrt_estimate(f32 x) noexcept { return _mm_rsqrt_ps(x.v); } // 11 bits
+
+inline i32 as_i32(f32 x) noexcept { return _mm_castps_si128(x.v); }
+inline f32 as_f32(i32 x) noexcept { return _mm_castsi128_ps(x.v); }
+inline i32 to_i32(f32 x) noexcept { return _mm_cvttps_epi32(x.v); }
+inline f32 to_f32(i32 x) noexcept { return _mm_cvtepi32_ps(x.v); }
+
+#if defined(__SSE4_1__)
+inline f32 floor(f32 x) noexcept { return _mm_floor_ps(x.v); }
+inline f32 round(f32 x) noexcept { return _mm_round_ps(x.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+#else
+// only valid for |x| < 2^31, which is all the kernels need
+inline f32 floor(f32 x) noexcept {
+    const f32 t = to_f32(to_i32(x));
+    return t - (f32(_mm_cmpgt_ps(t.v, x.v)) & f32(1.0f));
+}
+inline f32 round(f32 x) noexcept { return to_f32(i32(_mm_cvtps_epi32(x.v))); }
+#endif
+
+inline f32 gather(const float* table, i32 i) noexcept {
+    alignas(16) std::int32_t idx[4];
+    i.store(idx);
+    return _mm_setr_ps(table[idx[0]], table[idx[1]], table[idx[2]], table[idx[3]]);
+}
+inline i32 gather(const std::int32_t* table, i32 i) noexcept {
+    alignas(16) std::int32_t idx[4];
+    i.store(idx);
+    return _mm_setr_epi32(table[idx[0]], table[idx[1]], table[idx[2]], table[idx[3]]);
+}
+
+inline void deinterleave(f32 a, f32 b, f32& even, f32& odd) noexcept {
+    even = _mm_shuffle_ps(a.v, b.v, _MM_SHUFFLE(2, 0, 2, 0));
+    odd = _mm_shuffle_ps(a.v, b.v, _MM_SHUFFLE(3, 1, 3, 1));
+}
+inline void interleave(f32 even, f32 odd, f32& a, f32& b) noexcept {
+    a = _mm_unpacklo_ps(even.v, odd.v);
+    b = _mm_unpackhi_ps(even.v, odd.v);
+}
+
+inline float reduce_add(f32 x) noexcept {
+    __m128 s = _mm_add_ps(x.v, _mm_movehl_ps(x.v, x.v));
+    s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+    return _mm_cvtss_f32(s);
+}
+inline float reduce_max(f32 x) noexcept {
+    __m128 s = _mm_max_ps(x.v, _mm_movehl_ps(x.v, x.v));
+    s = _mm_max_ss(s, _mm_shuffle_ps(s, s, 1));
+    return _mm_cvtss_f32(s);
+}
+
+#else
+
+/** GENERIC */
+// Plain arrays, left to the compiler's auto-vectoriser
+
+struct mask {
+    bool m[4];
+};
+
+struct f32 {
+    static constexpr int size = 4;
+    float v[4];
+    f32() = default;
+    f32(float x) noexcept : v{ x, x, x, x } {}
+    static f32 load(const float* p) noexcept { f32 r; for (int i = 0; i < 4; i++) r.v[i] = p[i]; return r; }
+    static f32 load_aligned(const float* p) noexcept { return load(p); }
+    void store(float* p) const noexcept { for (int i = 0; i < 4; i++) p[i] = v[i]; }
+    void store_aligned(float* p) const noexcept { store(p); }
+};
+
+struct i32 {
+    static constexpr int size = 4;
+    std::int32_t v[4];
+    i32() = default;
+    i32(std::int32_t x) noexcept : v{ x, x, x, x } {}
+    static i32 load(const std::int32_t* p) noexcept { i32 r; for (int i = 0; i < 4; i++) r.v[i] = p[i]; return r; }
+    void store(std::int32_t* p) const noexcept { for (int i = 0; i < 4; i++) p[i] = v[i]; }
+};
+
+#define FASTMATHS_SIMD_LANES(R, expr) { R r; for (int i = 0; i < 4; i++) r.v[i] = (expr); return r; }
+#define FASTMATHS_SIMD_MASK(expr) { mask r; for (int i = 0; i < 4; i++) r.m[i] = (expr); return r; }
+
+inline f32 operator+(f32 a, f32 b) noexcept FASTMATHS_SIMD_LANES(f32, a.v[i] + b.v[i])
+inline f32 operator-(f32 a, f32 b) noexcept FASTMATHS_SIMD_LANES(f32, a.v[i] - b.v[i])
+inline f32 operator*(f32 a, f32 b) noexcept FASTMATHS_SIMD_LANES(f32, a.v[i] * b.v[i])
+inline f32 operator/(f32 a, f32 b) noexcept FASTMATHS_SIMD_LANES(f32, a.v[i] / b.v[i])
+inline f32 operator-(f32 a) noexcept FASTMATHS_SIMD_LANES(f32, -a.v[i])
+inline f32 operator&(f32 a, f32 b) noexcept FASTMATHS_SIMD_LANES(f32, as_f32(as_i32(a.v[i]) & as_i32(b.v[i])))
+inline f32 operator|(f32 a, f32 b) noexcept FASTMATHS_SIMD_LANES(f32, as_f32(as_i32(a.v[i]) | as_i32(b.v[i])))
+inline f32 operator^(f32 a, f32 b) noexcept FASTMATHS_SIMD_LANES(f32, as_f32(as_i32(a.v[i]) ^ as_i32(b.v[i])))
+inline mask operator<(f32 a, f32 b) noexcept FASTMATHS_SIMD_MASK(a.v[i] < b.v[i])
+inline mask operator<=(f32 a, f32 b) noexcept FASTMATHS_SIMD_MASK(a.v[i] <= b.v[i])
+inline mask operator>(f32 a, f32 b) noexcept FASTMATHS_SIMD_MASK(a.v[i] > b.v[i])
+inline mask operator>=(f32 a, f32 b) noexcept FASTMATHS_SIMD_MASK(a.v[i] >= b.v[i])
+inline mask operator==(f32 a, f32 b) noexcept FASTMATHS_SIMD_MASK(a.v[i] == b.v[i])
+inline mask operator!=(f32 a, f32 b) noexcept FASTMATHS_SIMD_MASK(a.v[i] != b.v[i])
+
+inline i32 operator+(i32 a, i32 b) noexcept FASTMATHS_SIMD_LANES(i32, std::int32_t(std::uint32_t(a.v[i]) + std::uint32_t(b.v[i])))
+inline i32 operator-(i32 a, i32 b) noexcept FASTMATHS_SIMD_LANES(i32, std::int32_t(std::uint32_t(a.v[i]) - std::uint32_t(b.v[i])))
+inline i32 operator&(i32 a, i32 b) noexcept FASTMATHS_SIMD_LANES(i32, a.v[i] & b.v[i])
+inline i32 operator|(i32 a, i32 b) noexcept FASTMATHS_SIMD_LANES(i32, a.v[i] | b.v[i])
+inline i32 operator^(i32 a, i32 b) noexcept FASTMATHS_SIMD_LANES(i32, a.v[i] ^ b.v[i])
+inline i32 operator<<(i32 a, int n) noexcept FASTMATHS_SIMD_LANES(i32, std::int32_t(std::uint32_t(a.v[i]) << n))
+inline i32 operator>>(i32 a, int n) noexcept FASTMATHS_SIMD_LANES(i32, a.v[i] >> n)
+inline mask operator<(i32 a, i32 b) noexcept FASTMATHS_SIMD_MASK(a.v[i] < b.v[i])
+inline mask operator>(i32 a, i32 b) noexcept FASTMATHS_SIMD_MASK(a.v[i] > b.v[i])
+inline mask operator==(i32 a, i32 b) noexcept FASTMATHS_SIMD_MASK(a.v[i] == b.v[i])
+
+inline mask operator&(mask a, mask b) noexcept FASTMATHS_SIMD_MASK(a.m[i] && b.m[i])
+inline mask operator|(mask a, mask b) noexcept FASTMATHS_SIMD_MASK(a.m[i] || b.m[i])
+inline mask operator^(mask a, mask b) noexcept FASTMATHS_SIMD_MASK(a.m[i] != b.m[i])
+inline mask operator~(mask a) noexcept FASTMATHS_SIMD_MASK(!a.m[i])
+inline bool any(mask a) noexcept { return a.m[0] || a.m[1] || a.m[2] || a.m[3]; }
+inline bool all(mask a) noexcept { return a.m[0] && a.m[1] && a.m[2] && a.m[3]; }
+
+inline f32 select(mask m, f32 a, f32 b) noexcept FASTMATHS_SIMD_LANES(f32, m.m[i] ? a.v[i] : b.v[i])
+inline i32 select(mask m, i32 a, i32 b) noexcept FASTMATHS_SIMD_LANES(i32, m.m[i] ? a.v[i] : b.v[i])
+inline f32 fma(f32 a, f32 b, f32 c) noexcept FASTMATHS_SIMD_LANES(f32, fma(a.v[i], b.v[i], c.v[i]))
+inline f32 min(f32 a, f32 b) noexcept FASTMATHS_SIMD_LANES(f32, min(a.v[i], b.v[i]))
+inline f32 max(f32 a, f32 b) noexcept FASTMATHS_SIMD_LANES(f32, max(a.v[i], b.v[i]))
+inline i32 min(i32 a, i32 b) noexcept FASTMATHS_SIMD_LANES(i32, min(a.v[i], b.v[i]))
+inline i32 max(i32 a, i32 b) noexcept FASTMATHS_SIMD_LANES(i32, max(a.v[i], b.v[i]))
+inline f32 abs(f32 x) noexcept FASTMATHS_SIMD_LANES(f32, abs(x.v[i]))
+inline f32 sqrt(f32 x) noexcept FASTMATHS_SIMD_LANES(f32, sqrt(x.v[i]))
+inline f32 rcp_estimate(f32 x) noexcept FASTMATHS_SIMD_LANES(f32, rcp_estimate(x.v[i]))
+inline f32 rsqrt_estimate(f32 x) noexcept FASTMATHS_SIMD_LANES(f32, rsqrt_estimate(x.v[i]))
+inline f32 floor(f32 x) noexcept FASTMATHS_SIMD_LANES(f32, floor(x.v[i]))
+inline f32 round(f32 x) noexcept FASTMATHS_SIMD_LANES(f32, round(x.v[i]))
+
+inline i32 as_i32(f32 x) noexcept FASTMATHS_SIMD_LANES(i32, as_i32(x.v[i]))
+inline f32 as_f32(i32 x) noexcept FASTMATHS_SIMD_LANES(f32, as_f32(x.v[i]))
+inline i32 to_i32(f32 x) noexcept FASTMATHS_SIMD_LANES(i32, to_i32(x.v[i]))
+inline f32 to_f32(i32 x) noexcept FASTMATHS_SIMD_LANES(f32, to_f32(x.v[i]))
+
+inline f32 gather(const float* table, i32 i) noexcept { f32 r; for (int l = 0; l < 4; l++) r.v[l] = table[i.v[l]]; return r; }
+inline i32 gather(const std::int32_t* table, i32 i) noexcept { i32 r; for (int l = 0; l < 4; l++) r.v[l] = table[i.v[l]]; return r; }
+
+inline void deinterleave(f32 a, f32 b, f32& even, f32& odd) noexcept {
+    const f32 x = a, y = b;
+    for (int l = 0; l < 2; l++) {
+        even.v[l] = x.v[2 * l];
+        odd.v[l] = x.v[2 * l + 1];
+        even.v[l + 2] = y.v[2 * l];
+        odd.v[l + 2] = y.v[2 * l + 1];
+    }
+}
+inline void interleave(f32 even, f32 odd, f32& a, f32& b) noexcept {
+    const f32 e = even, o = odd;
+    for (int l = 0; l < 2; l++) {
+        a.v[2 * l] = e.v[l];
+        a.v[2 * l + 1] = o.v[l];
+        b.v[2 * l] = e.v[l + 2];
+        b.v[2 * l + 1] = o.v[l + 2];
+    }
+}
+
+inline float reduce_add(f32 x) noexcept { return (x.v[0] + x.v[1]) + (x.v[2] + x.v[3]); }
+inline float reduce_max(f32 x) noexcept { return max(max(x.v[0], x.v[1]), max(x.v[2], x.v[3])); }
+
+#undef FASTMATHS_SIMD_LANES
+#undef FASTMATHS_SIMD_MASK
+
+#endif
+
+// compound assignment, shared by every instruction set
+inline f32& operator+=(f32& a, f32 b) noexcept { return a = a + b; }
+inline f32& operator-=(f32& a, f32 b) noexcept { return a = a - b; }
+inline f32& operator*=(f32& a, f32 b) noexcept { return a = a * b; }
+inline f32& operator/=(f32& a, f32 b) noexcept { return a = a / b; }
+inline i32& operator+=(i32& a, i32 b) noexcept { return a = a + b; }
+inline i32& operator-=(i32& a, i32 b) noexcept { return a = a - b; }
+
+// splits 2 * size interleaved floats, eg. complex numbers, into the even &
+// odd ones
+inline void load_deinterleave(const float* p, f32& even, f32& odd) noexcept {
+    deinterleave(f32::load(p), f32::load(p + f32::size), even, odd);
+}
+
+// the matching integer vector of a float type
+template <typename T> struct int_of { using type = i32; };
+template <> struct int_of<float> { using type = std::int32_t; };
+template <typename T> using int_t = typename int_of<T>::type;
+
+} // namespace simd
+} // namespace fast
@@ -1,15 +1,19 @@
 #pragma once
 #include <cmath>
 #include "./common.hpp"
+#include "instrument.hpp"
+#include "./poly.hpp"
+#include "./rcp.hpp"
 
 namespace fast {
 namespace sin {
 
-static inline float stl(float x) noexcept { return std::sinf(x); }
+static inline float stl(float x) noexcept { FASTMATHS_PROBE(x); return std::sin(x); }
 
 // based on https://stackoverflow.com/questions/18662261/fastest-implementation-of-sine-cosine-and-square-root-in-c-doesnt-need-to-b
 template<typename T, int N = 15>
 constexpr T taylor(T x) noexcept {
+    FASTMATHS_PROBE_DOMAIN(x, -3.14159265f, 3.14159265f);
     T sum       = 0;
     T power     = x;
     T sign      = 1;
@@ -29,6 +33,7 @@ constexpr T taylor(T x) noexcept {
 // slower than above method when N is low, faster when N is >= 3
 template<typename T, int N = 1>
 constexpr T taylorN(T x) noexcept {
+    FASTMATHS_PROBE_DOMAIN(x, -3.14159265f, 3.14159265f);
     // sin(x) = x - x^3 / 3! + x^5 / 5!
     T x2 = x * x;
     T x3 = x * x2;
@@ -45,17 +50,19 @@ constexpr T taylorN(T x) noexcept {
 }
 
 // https://www.musicdsp.org/en/latest/Other/93-hermite-interpollation.html
-constexpr float __hermiteInterpolate(float v0, float v1, float v2, float v3, float offset) {
-    float slope0 = (v2 - v0) * 0.5f;
-    float slope1 = (v3 - v1) * 0.5f;
-
-    float v = v1 - v2;
-    float w = slope0 + v;
-    float a = w + v + slope1;
-    float b_neg = w + a;
-    float stage1 = a * offset - b_neg;
-    float stage2 = stage1 * offset + slope0;
-    float result = stage2 * offset + v1;
+// between v1 & v2, offset from 0 to 1. T can also be simd::f32
+template <typename T>
+constexpr T __hermiteInterpolate(T v0, T v1, T v2, T v3, T offset) noexcept {
+    T slope0 = (v2 - v0) * T(0.5f);
+    T slope1 = (v3 - v1) * T(0.5f);
+
+    T v = v1 - v2;
+    T w = slope0 + v;
+    T a = w + v + slope1;
+    T b_neg = w + a;
+    T stage1 = a * offset - b_neg;
+    T stage2 = stage1 * offset + slope0;
+    T result = stage2 * offset + v1;
     return result;
 }
 
@@ -63,19 +70,26 @@ constexpr float __hermiteInterpolate(float v0, float v1, float v2, float v3, flo
 // ~ 32% faster than std::sin
 // JUCE uses this
 // https://github.com/juce-framework/JUCE/blob/master/modules/juce_dsp/maths/juce_FastMathApproximations.h
-template<typename T>
+template<typename T, typename Div = rcp::exact>
 constexpr T pade (T x) noexcept {
+    FASTMATHS_PROBE_DOMAIN(x, -3.14159265f, 3.14159265f);
     T x2 = x * x;
     T numerator = -x * (-11511339840 + x2 * (1640635920 + x2 * (-52785432 + x2 * 479249)));
     T denominator = 11511339840 + x2 * (277920720 + x2 * (3177720 + x2 * 18361));
-    return numerator / denominator;
+    return Div::div(numerator, denominator);
 }
 
+// pade with the divide swapped for a reciprocal good to Bits bits, see rcp.hpp.
+// T can also be simd::f32
+template <typename T = float, int Bits = 22>
+constexpr T pade_rcp (T x) noexcept { return pade<T, rcp::divider<Bits>>(x); }
+
 // not sure where i found this
 // fairly accurate in values between -pi & pi, but not beyond that
 // ~28% faster than std::sin
 template<typename T>
 constexpr T sin_approx(T x) noexcept {
+    FASTMATHS_PROBE_DOMAIN(x, -3.14159265f, 3.14159265f);
     T pi_major = static_cast<T>(3.1415927);
     T pi_minor = static_cast<T>(-0.00000008742278);
     T x2 = x*x;
@@ -92,12 +106,14 @@ constexpr T sin_approx(T x) noexcept {
 // https://en.wikipedia.org/wiki/Bhaskara_I's_sine_approximation_formula
 template<typename T>
 constexpr T bhaskara_degrees(T x) noexcept {
+    FASTMATHS_PROBE_DOMAIN(x, 0.0f, 180.0f);
     return 4 * x * (180 - x) / (40500 - x * (180 - x));
 }
 // very very fast
 // ~43% faster than stl
 template<typename T>
 constexpr T bhaskara_radians(T x) noexcept {
+    FASTMATHS_PROBE_DOMAIN(x, 0.0f, 3.14159265f);
     return 16 * x * (static_cast<T>(M_PI) - x) /
         (25 * static_cast<T>(M_PI) * static_cast<T>(M_PI) - 4 * x * (static_cast<T>(M_PI) - x));
 }
@@ -105,16 +121,17 @@ constexpr T bhaskara_radians(T x) noexcept {
 // https://web.archive.org/web/20141220225551/http://forum.devmaster.net/t/fast-and-accurate-sine-cosine/9648
 template<typename T>
 constexpr T slaru(T x) noexcept {
+    FASTMATHS_PROBE_DOMAIN(x, -3.14159265f, 3.14159265f);
     const T B = 4/static_cast<T>(M_PI);
     const T C = -4/(static_cast<T>(M_PI)*static_cast<T>(M_PI));
 
     T y = B * x
-        + C * x * abs(x);
+        + C * x * std::abs(x);
 
     // const float Q = 0.775;
     const T P = static_cast<T>(0.225);
 
-    y = P * (y * abs(y) - y) + y;   // Q * y + P * y * abs(y)
+    y = P * (y * std::abs(y) - y) + y;   // Q * y + P * y * abs(y)
     return y;
 }
 
@@ -123,72 +140,77 @@ constexpr T slaru(T x) noexcept {
 // https://stackoverflow.com/a/71674578
 template<typename T>
 constexpr T juha(float x) noexcept {
+    FASTMATHS_PROBE_DOMAIN(x, -3.14159265f, 3.14159265f);
     return 4 * static_cast<T>(0.31830988618) * x * (1 - static_cast<T>(0.31830988618) * std::abs(x));
 }
 
 // I edited juha to cycle well over +/- pi
 static inline float juha_fmod(float x) noexcept {
+    FASTMATHS_PROBE(x);
     int times = (int)(x / static_cast<float>(M_PI));
 
     // correct sign
-    union { float f; int i; } y = { juha<float>(std::fmodf(x, static_cast<float>(M_PI))) };
-    y.i ^= times << 31;
-    return y.f;
+    const int y = std::bit_cast<int>(juha<float>(std::fmod(x, static_cast<float>(M_PI))));
+    return std::bit_cast<float>(y ^ (times << 31));
 }
 
 // https://github.com/romeric/fastapprox/blob/master/fastapprox/src/fasttrig.h
-static inline float mineiro (float x) noexcept {
-    static const float fouroverpi = 1.2732395447351627f;
-    static const float fouroverpisq = 0.40528473456935109f;
-    static const float q = 0.78444488374548933f;
-    union { float f; uint32_t i; } p = { 0.20363937680730309f };
-    union { float f; uint32_t i; } r = { 0.015124940802184233f };
-    union { float f; uint32_t i; } s = { -0.0032225901625579573f };
-
-    union { float f; uint32_t i; } vx = { x };
-    uint32_t sign = vx.i & 0x80000000;
-    vx.i = vx.i & 0x7FFFFFFF;
-
-    float qpprox = fouroverpi * x - fouroverpisq * x * vx.f;
+constexpr float mineiro (float x) noexcept {
+    FASTMATHS_PROBE_DOMAIN(x, -3.14159265f, 3.14159265f);
+    constexpr float fouroverpi = 1.2732395447351627f;
+    constexpr float fouroverpisq = 0.40528473456935109f;
+    constexpr float q = 0.78444488374548933f;
+    constexpr uint32_t p = std::bit_cast<uint32_t>(0.20363937680730309f);
+    constexpr uint32_t r = std::bit_cast<uint32_t>(0.015124940802184233f);
+    constexpr uint32_t s = std::bit_cast<uint32_t>(-0.0032225901625579573f);
+
+    const uint32_t vx = std::bit_cast<uint32_t>(x);
+    const uint32_t sign = vx & 0x80000000;
+    const float ax = std::bit_cast<float>(vx & 0x7FFFFFFF);
+
+    float qpprox = fouroverpi * x - fouroverpisq * x * ax;
     float qpproxsq = qpprox * qpprox;
 
-    p.i |= sign;
-    r.i |= sign;
-    s.i ^= sign;
+    const float ps = std::bit_cast<float>(p | sign);
+    const float rs = std::bit_cast<float>(r | sign);
+    const float ss = std::bit_cast<float>(s ^ sign);
 
-    return q * qpprox + qpproxsq * (p.f + qpproxsq * (r.f + qpproxsq * s.f));
+    return q * qpprox + qpproxsq * (ps + qpproxsq * (rs + qpproxsq * ss));
 }
 
-static inline float mineiro_faster (float x) noexcept {
-    static const float fouroverpi = 1.2732395447351627f;
-    static const float fouroverpisq = 0.40528473456935109f;
-    static const float q = 0.77633023248007499f;
-    union { float f; uint32_t i; } p = { 0.22308510060189463f };
+constexpr float mineiro_faster (float x) noexcept {
+    FASTMATHS_PROBE_DOMAIN(x, -3.14159265f, 3.14159265f);
+    constexpr float fouroverpi = 1.2732395447351627f;
+    constexpr float fouroverpisq = 0.40528473456935109f;
+    constexpr float q = 0.77633023248007499f;
+    constexpr uint32_t p = std::bit_cast<uint32_t>(0.22308510060189463f);
 
-    union { float f; uint32_t i; } vx = { x };
-    uint32_t sign = vx.i & 0x80000000;
-    vx.i &= 0x7FFFFFFF;
+    const uint32_t vx = std::bit_cast<uint32_t>(x);
+    const uint32_t sign = vx & 0x80000000;
+    const float ax = std::bit_cast<float>(vx & 0x7FFFFFFF);
 
     float qpprox = fouroverpi * x
-                 - fouroverpisq * x * vx.f;
+                 - fouroverpisq * x * ax;
 
-    p.i |= sign;
+    const float ps = std::bit_cast<float>(p | sign);
 
-    return qpprox * (q + p.f * qpprox);
+    return qpprox * (q + ps * qpprox);
 }
 
-static inline float mineiro_full (float x) noexcept {
-    static const float twopi = 6.2831853071795865f;
-    static const float invtwopi = 0.15915494309189534f;
+constexpr float mineiro_full (float x) noexcept {
+    FASTMATHS_PROBE(x);
+    constexpr float twopi = 6.2831853071795865f;
+    constexpr float invtwopi = 0.15915494309189534f;
 
     int k = (int)(x * invtwopi);
     float half = (x < 0) ? -0.5f : 0.5f;
     return mineiro ((half + k) * twopi - x);
 }
 
-static inline float mineiro_full_faster (float x) noexcept {
-    static const float twopi = 6.2831853071795865f;
-    static const float invtwopi = 0.15915494309189534f;
+constexpr float mineiro_full_faster (float x) noexcept {
+    FASTMATHS_PROBE(x);
+    constexpr float twopi = 6.2831853071795865f;
+    constexpr float invtwopi = 0.15915494309189534f;
 
     int k = (int)(x * invtwopi);
     float half = (x < 0) ? -0.5f : 0.5f;
@@ -202,31 +224,39 @@ constexpr T __rint (T x) noexcept {
   T t = floor(std::fabs(x) + static_cast<T>(0.5));
   return (x < 0) ? -t : t;
 }
-template <typename T>
+// The default keeps the original by hand. poly::estrin adds the odd pair on
+// last, A x8 + (B x4 + C), where this adds C last, which rounds differently
+template <typename T, typename Scheme = poly::estrin>
 constexpr T __cos_core (T x) noexcept {
-    T x8, x4, x2;
-    x2 = x * x;
-    x4 = x2 * x2;
-    x8 = x4 * x4;
-    /* evaluate polynomial using Estrin's scheme */
-    return (static_cast<T>(-2.7236370439787708e-7) * x2 + static_cast<T>(2.4799852696610628e-5)) * x8 +
-           (static_cast<T>(-1.3888885054799695e-3) * x2 + static_cast<T>(4.1666666636943683e-2)) * x4 +
-           (static_cast<T>(-4.9999999999963024e-1) * x2 + static_cast<T>(1.0000000000000000e+0));
+    if constexpr (std::is_same_v<Scheme, poly::estrin>) {
+        T x8, x4, x2;
+        x2 = x * x;
+        x4 = x2 * x2;
+        x8 = x4 * x4;
+        /* evaluate polynomial using Estrin's scheme */
+        return (static_cast<T>(-2.7236370439787708e-7) * x2 + static_cast<T>(2.4799852696610628e-5)) * x8 +
+               (static_cast<T>(-1.3888885054799695e-3) * x2 + static_cast<T>(4.1666666636943683e-2)) * x4 +
+               (static_cast<T>(-4.9999999999963024e-1) * x2 + static_cast<T>(1.0000000000000000e+0));
+    } else {
+        return poly::eval<Scheme>(x * x,
+            1.0000000000000000e+0, -4.9999999999963024e-1, 4.1666666636943683e-2,
+            -1.3888885054799695e-3, 2.4799852696610628e-5, -2.7236370439787708e-7);
+    }
 }
 /* minimax approximation to sin on [-pi/4, pi/4] with rel. err. ~= 5.5e-12 */
-template <typename T>
+template <typename T, typename Scheme = poly::estrin>
 constexpr T __sin_core (T x) noexcept {
-    T x4, x2;
-    x2 = x * x;
-    x4 = x2 * x2;
+    const T x2 = x * x;
     /* evaluate polynomial using a mix of Estrin's and Horner's scheme */
-    return ((static_cast<T>(2.7181216275479732e-6) * x2 - static_cast<T>(1.9839312269456257e-4)) * x4 +
-            (static_cast<T>(8.3333293048425631e-3) * x2 - static_cast<T>(1.6666666640797048e-1))) * x2 * x + x;
+    return poly::eval<Scheme>(x2,
+        -1.6666666640797048e-1, 8.3333293048425631e-3,
+        -1.9839312269456257e-4, 2.7181216275479732e-6) * x2 * x + x;
 }
 
 /* relative error < 7e-12 on [-50000, 50000] */
-template <typename T>
+template <typename T, typename Scheme = poly::estrin>
 constexpr T njuffa (T x) noexcept {
+    FASTMATHS_PROBE_DOMAIN(x, -50000.0f, 50000.0f);
     T q, t;
     int quadrant;
     /* Cody-Waite style argument reduction */
@@ -235,68 +265,57 @@ constexpr T njuffa (T x) noexcept {
     t = x - q * static_cast<T>(1.5707963267923333e+00);
     t = t - q * static_cast<T>(2.5633441515945189e-12);
     if (quadrant & 1) {
-        t = __cos_core<T>(t);
+        t = __cos_core<T, Scheme>(t);
     } else {
-        t = __sin_core<T>(t);
+        t = __sin_core<T, Scheme>(t);
     }
     return (quadrant & 2) ? -t : t;
 }
 
 // https://www.musicdsp.org/en/latest/Other/115-sin-cos-tan-approximation.html
-static inline float wildmagic0 (float fAngle) noexcept {
-    float fASqr = fAngle*fAngle;
-    float fResult = 7.61e-03f;
-    fResult *= fASqr;
-    fResult -= 1.6605e-01f;
-    fResult *= fASqr;
-    fResult += 1.0f;
-    fResult *= fAngle;
-    return fResult;
+template <typename T = float, typename Scheme = poly::horner>
+constexpr T wildmagic0 (T fAngle) noexcept {
+    FASTMATHS_PROBE_DOMAIN(fAngle, -1.57079633f, 1.57079633f);
+    return fAngle * poly::eval<Scheme>(fAngle * fAngle, 1.0f, -1.6605e-01f, 7.61e-03f);
 }
 //----------------------------------------------------------------------
-static inline float wildmagic1 (float fAngle) noexcept {
-    float fASqr = fAngle*fAngle;
-    float fResult = -2.39e-08f;
-    fResult *= fASqr;
-    fResult += 2.7526e-06f;
-    fResult *= fASqr;
-    fResult -= 1.98409e-04f;
-    fResult *= fASqr;
-    fResult += 8.3333315e-03f;
-    fResult *= fASqr;
-    fResult -= 1.666666664e-01f;
-    fResult *= fASqr;
-    fResult += 1.0f;
-    fResult *= fAngle;
-    return fResult;
+template <typename T = float, typename Scheme = poly::horner>
+constexpr T wildmagic1 (T fAngle) noexcept {
+    FASTMATHS_PROBE_DOMAIN(fAngle, -1.57079633f, 1.57079633f);
+    return fAngle * poly::eval<Scheme>(fAngle * fAngle,
+        1.0f, -1.666666664e-01f, 8.3333315e-03f, -1.98409e-04f, 2.7526e-06f, -2.39e-08f);
 }
 
 // in [-1,1], out [-0.25, 0.25]
 // https://bmtechjournal.wordpress.com/2020/05/27/super-fast-quadratic-sinusoid-approximation/
-static inline float bluemangoo_original(float x)
+constexpr float bluemangoo_original(float x) noexcept
 {
-    return -x * fabsf(x) + x;
+    FASTMATHS_PROBE_DOMAIN(x, -1.0f, 1.0f);
+    return -x * simd::abs(x) + x;
 }
 // in [-pi,pi], out [-1,1]
-static inline float bluemangoo(float x)
+constexpr float bluemangoo(float x) noexcept
 {
+    FASTMATHS_PROBE_DOMAIN(x, -3.14159265f, 3.14159265f);
     float x2 = x * float(M_1_PI);
-    float y = -x2 * fabsf(x2) + x2;
+    float y = -x2 * simd::abs(x2) + x2;
     return 4 * y;
 }
 
 // [0, 2] corresponding to [0, pi]
 // https://github.com/LancePutnam/Gamma/blob/0ab245147c8bbebe1e96eb301e52ebb47c8c1c60/Gamma/scl.h#L963
-static float lanceputnam_gamma_original(float x)
+constexpr float lanceputnam_gamma_original(float x) noexcept
 {
+    FASTMATHS_PROBE_DOMAIN(x, 0.0f, 2.0f);
     float y = x * (2.0f - x);
 	return y * (0.775f + 0.225f * y);
 }
 // More forgiving inputs
 // [-pi, pi]
-static float lanceputnam_gamma(float x)
+constexpr float lanceputnam_gamma(float x) noexcept
 {
-    float ax = fabsf(x * float(M_2_PI));
+    FASTMATHS_PROBE_DOMAIN(x, -3.14159265f, 3.14159265f);
+    float ax = simd::abs(x * float(M_2_PI));
     float y = ax * (2.0f - ax);
 	y = y * (0.775f + 0.225f * y);
     return x < 0 ? -y : y;
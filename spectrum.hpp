@@ -0,0 +1,43 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+#include "log10.hpp"
+#include "simd.hpp"
+
+// Spectrum analyser stages over interleaved complex FFT bins, re im re im..
+// 20 log10(|z|) is 10 log10(re^2 + im^2), so the dB of a bin never needs the
+// sqrt of its magnitude.
+
+namespace fast {
+namespace spectrum {
+
+// db[i] = max(10 log10(re^2 + im^2), floor_db), in one pass.
+// Log10 is any log10 approximation, eg. log10::log2_mineiro. Kernels that
+// take simd::f32, like [](auto x) { return log10::table(x); }, run a vector
+// at a time, others a bin at a time and are left to the auto-vectoriser.
+// The power is clamped to the floor before the log, so silent bins never
+// reach log(0) & the bit trick kernels stay in their domain.
+template <auto Log10 = log10::log2_mineiro>
+inline void power_db(const float* complex, float* db, std::size_t n, float floor_db = -140.0f) noexcept {
+    const float floor_power = std::pow(10.0f, floor_db * 0.1f);
+    auto bin = [=](auto re, auto im) {
+        using T = decltype(re);
+        const T power = simd::max(re * re + im * im, T(floor_power));
+        return simd::max(T(10.0f) * Log10(power), T(floor_db));
+    };
+
+    std::size_t i = 0;
+    if constexpr (std::is_invocable_r_v<simd::f32, decltype(Log10), simd::f32>) {
+        for (; i + simd::f32::size <= n; i += simd::f32::size) {
+            simd::f32 re, im;
+            simd::load_deinterleave(complex + 2 * i, re, im);
+            bin(re, im).store(db + i);
+        }
+    }
+    for (; i < n; i++)
+        db[i] = bin(complex[2 * i], complex[2 * i + 1]);
+}
+
+} // namespace spectrum
+} // namespace fast
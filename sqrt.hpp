@@ -1,48 +1,144 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include "batch.hpp"
+#include "rcp.hpp"
+#include "simd.hpp"
+#include "instrument.hpp"
+
 namespace fast {
 namespace sqrt {
 
-static inline float stl(float x) noexcept { return std::sqrt(x); }
+static inline float stl(float x) noexcept { FASTMATHS_PROBE_DOMAIN(x, 0.0f, 0x1.fffffep127f); return std::sqrt(x); }
 
 // https://stackoverflow.com/a/18662665
-static inline float bigtailwolf(float x) noexcept {
-    unsigned int i = *(unsigned int*) &x;
+constexpr float bigtailwolf(float x) noexcept {
+    FASTMATHS_PROBE_DOMAIN(x, 0.0f, 0x1.fffffep127f);
+    unsigned int i = std::bit_cast<unsigned int>(x);
 
     // adjust bias
     i  += 127 << 23;
     // approximation of square root
     i >>= 1;
 
-    return *(float*) &i;
+    return std::bit_cast<float>(i);
 }
 
 // much slower than stl
 // https://stackoverflow.com/a/43176496
-static inline float nimig18(float x) noexcept {
-    union {float f; uint32_t i; } X, Y;
+constexpr float nimig18(float x) noexcept {
+    FASTMATHS_PROBE_DOMAIN(x, 0x1p-126f, 0x1.fffffep127f);
     float ScOff;
     uint32_t e;
 
-    X.f = x;
-    e = X.i >> 23;           // f.SFPbits.e;
+    const uint32_t Xi = std::bit_cast<uint32_t>(x);
+    e = Xi >> 23;           // f.SFPbits.e;
 
     // if(x <= 0) return(0.0f);
 
     ScOff = ((e & 1) != 0) ? 1.0f : 0x1.6a09e6p0;  // NOTE: If exp=EVEN, b/c (exp-127) a (EVEN - ODD) := ODD; but a (ODD - ODD) := EVEN!!
 
     e = ((e + 127) >> 1);                            // NOTE: If exp=ODD,  b/c (exp-127) then flr((exp-127)/2)
-    X.i = (X.i & ((1uL << 23) - 1)) | (0x7F << 23);  // Mask mantissa, force exponent to zero.
-    Y.i = (((uint32_t) e) << 23);
+    const float X = std::bit_cast<float>((Xi & ((1u << 23) - 1)) | (0x7F << 23));  // Mask mantissa, force exponent to zero.
+    float Y = std::bit_cast<float>(((uint32_t) e) << 23);
 
     // Error grows with square root of the exponent. Unfortunately no work around like inverse square root... :(
-    // Y.f *= ScOff * (0x9.5f61ap-4 + X.f*(0x6.a09e68p-4));        // Error = +-1.78e-2 * 2^(flr(log2(x)/2))
-    // Y.f *= ScOff * (0x7.2181d8p-4 + X.f*(0xa.05406p-4 + X.f*(-0x1.23a14cp-4)));      // Error = +-7.64e-5 * 2^(flr(log2(x)/2))
-    // Y.f *= ScOff * (0x5.f10e7p-4 + X.f*(0xc.8f2p-4 +X.f*(-0x2.e41a4cp-4 + X.f*(0x6.441e6p-8))));     // Error =  8.21e-5 * 2^(flr(log2(x)/2))
-    // Y.f *= ScOff * (0x5.32eb88p-4 + X.f*(0xe.abbf5p-4 + X.f*(-0x5.18ee2p-4 + X.f*(0x1.655efp-4 + X.f*(-0x2.b11518p-8)))));   // Error = +-9.92e-6 * 2^(flr(log2(x)/2))
-    // Y.f *= ScOff * (0x4.adde5p-4 + X.f*(0x1.08448cp0 + X.f*(-0x7.ae1248p-4 + X.f*(0x3.2cf7a8p-4 + X.f*(-0xc.5c1e2p-8 + X.f*(0x1.4b6dp-8))))));   // Error = +-1.38e-6 * 2^(flr(log2(x)/2))
-    // Y.f *= ScOff * (0x4.4a17fp-4 + X.f*(0x1.22d44p0 + X.f*(-0xa.972e8p-4 + X.f*(0x5.dd53fp-4 + X.f*(-0x2.273c08p-4 + X.f*(0x7.466cb8p-8 + X.f*(-0xa.ac00ep-12)))))));    // Error = +-2.9e-7 * 2^(flr(log2(x)/2))
-    Y.f *= ScOff * (0x3.fbb3e8p-4 + X.f*(0x1.3b2a3cp0 + X.f*(-0xd.cbb39p-4 + X.f*(0x9.9444ep-4 + X.f*(-0x4.b5ea38p-4 + X.f*(0x1.802f9ep-4 + X.f*(-0x4.6f0adp-8 + X.f*(0x5.c24a28p-12 ))))))));   // Error = +-2.7e-6 * 2^(flr(log2(x)/2))
-
-    return Y.f;
+    // Y *= ScOff * (0x9.5f61ap-4 + X*(0x6.a09e68p-4));        // Error = +-1.78e-2 * 2^(flr(log2(x)/2))
+    // Y *= ScOff * (0x7.2181d8p-4 + X*(0xa.05406p-4 + X*(-0x1.23a14cp-4)));      // Error = +-7.64e-5 * 2^(flr(log2(x)/2))
+    // Y *= ScOff * (0x5.f10e7p-4 + X*(0xc.8f2p-4 +X*(-0x2.e41a4cp-4 + X*(0x6.441e6p-8))));     // Error =  8.21e-5 * 2^(flr(log2(x)/2))
+    // Y *= ScOff * (0x5.32eb88p-4 + X*(0xe.abbf5p-4 + X*(-0x5.18ee2p-4 + X*(0x1.655efp-4 + X*(-0x2.b11518p-8)))));   // Error = +-9.92e-6 * 2^(flr(log2(x)/2))
+    // Y *= ScOff * (0x4.adde5p-4 + X*(0x1.08448cp0 + X*(-0x7.ae1248p-4 + X*(0x3.2cf7a8p-4 + X*(-0xc.5c1e2p-8 + X*(0x1.4b6dp-8))))));   // Error = +-1.38e-6 * 2^(flr(log2(x)/2))
+    // Y *= ScOff * (0x4.4a17fp-4 + X*(0x1.22d44p0 + X*(-0xa.972e8p-4 + X*(0x5.dd53fp-4 + X*(-0x2.273c08p-4 + X*(0x7.466cb8p-8 + X*(-0xa.ac00ep-12)))))));    // Error = +-2.9e-7 * 2^(flr(log2(x)/2))
+    Y *= ScOff * (0x3.fbb3e8p-4 + X*(0x1.3b2a3cp0 + X*(-0xd.cbb39p-4 + X*(0x9.9444ep-4 + X*(-0x4.b5ea38p-4 + X*(0x1.802f9ep-4 + X*(-0x4.6f0adp-8 + X*(0x5.c24a28p-12 ))))))));   // Error = +-2.7e-6 * 2^(flr(log2(x)/2))
+
+    return Y;
+}
+
+// 1/sqrt(x) & sqrt(x) from simd::rsqrt_estimate & Newton-Raphson steps, the
+// same scheme as rcp.hpp: rsqrt14 (AVX-512) 14 bits, rsqrtps (SSE/AVX) 11
+// bits & quake's magic constant 4 bits, doubling with each step.
+// T can be float or simd::f32. Only for normal x, 2^-126 <= x <= FLT_MAX: SSE
+// & AVX estimate denormals as inf, & the magic constant is wrong for them.
+// https://en.wikipedia.org/wiki/Fast_inverse_square_root#Newton's_method
+template <int Steps = 1, typename T>
+constexpr T rsqrt_newton(T x) noexcept {
+    static_assert(Steps >= 0, "Steps is the number of Newton-Raphson refinements");
+    T y = simd::rsqrt_estimate(x);
+    for (int i = 0; i < Steps; i++)
+        y = y * (T(1.5f) - T(0.5f) * x * y * y);
+    return y;
+}
+
+// the original, magic constant & one step. Portable, within 0.18%
+// https://en.wikipedia.org/wiki/Fast_inverse_square_root
+constexpr float quake(float x) noexcept { FASTMATHS_PROBE_DOMAIN(x, 0x1p-126f, 0x1.fffffep127f); return rsqrt_newton<1>(x); }
+
+// 1/sqrt(x) to at least Bits correct bits, for normal x > 0
+template <int Bits = 22, typename T>
+constexpr T rsqrt(T x) noexcept {
+    static_assert(Bits >= 1 && Bits <= 24, "a float has 24 bits");
+    FASTMATHS_PROBE_DOMAIN(x, 0x1p-126f, 0x1.fffffep127f);
+    return rsqrt_newton<rcp::steps_for<T>(Bits)>(x);
+}
+
+// sqrt(x) as x / sqrt(x), to about Bits bits, for every x >= 0. rsqrt only
+// takes normal x, so denormals are scaled up by 2^24 & their roots down by
+// 2^12, & inf goes through as FLT_MAX, whose rsqrt times inf is inf. The
+// hardware estimate of 0 is inf, so 0 is picked out to give 0, as do negative
+// x & NaN rather than NaN
+template <int Bits = 22, typename T>
+constexpr T approx(T x) noexcept {
+    FASTMATHS_PROBE_DOMAIN(x, 0.0f, std::numeric_limits<float>::infinity());
+    const auto denormal = x < T(std::numeric_limits<float>::min());
+    const T y = x * simd::select(denormal, T(0x1p24f), T(1.0f));
+    const T r = y * rsqrt<Bits>(simd::min(y, T(std::numeric_limits<float>::max())));
+    return simd::select(x > T(0.0f), r * simd::select(denormal, T(0x1p-12f), T(1.0f)), T(0.0f));
+}
+
+// sqrt(re^2 + im^2) without hypot's care for overflow, so only for
+// |re|, |im| < 1e19
+template <int Bits = 22, typename T>
+constexpr T hypot(T re, T im) noexcept {
+    return approx<Bits>(re * re + im * im);
+}
+
+/** BLOCKS */
+// in & out may be the same buffer
+
+template <int Bits = 22>
+inline void rsqrt_block(const float* in, float* out, std::size_t n) noexcept {
+    batch::transform(in, out, n, [](auto x) { return rsqrt<Bits>(x); });
+}
+
+template <int Bits = 22>
+inline void rsqrt_block(buffer::padded_span<const float> in, buffer::padded_span<float> out) noexcept {
+    batch::transform(in, out, [](auto x) { return rsqrt<Bits>(x); });
+}
+
+template <int Bits = 22>
+inline void approx_block(const float* in, float* out, std::size_t n) noexcept {
+    batch::transform(in, out, n, [](auto x) { return approx<Bits>(x); });
+}
+
+template <int Bits = 22>
+inline void approx_block(buffer::padded_span<const float> in, buffer::padded_span<float> out) noexcept {
+    batch::transform(in, out, [](auto x) { return approx<Bits>(x); });
+}
+
+// |z| of n interleaved complex numbers, re im re im.., into n floats.
+// complex may not be the same buffer as out
+template <int Bits = 22>
+inline void magnitude(const float* complex, float* out, std::size_t n) noexcept {
+    std::size_t i = 0;
+    for (; i + simd::f32::size <= n; i += simd::f32::size) {
+        simd::f32 re, im;
+        simd::load_deinterleave(complex + 2 * i, re, im);
+        hypot<Bits>(re, im).store(out + i);
+    }
+    for (; i < n; i++)
+        out[i] = hypot<Bits>(complex[2 * i], complex[2 * i + 1]);
 }
 
 } // namespace sqrt
@@ -1,44 +1,52 @@
+#pragma once
+#include <cmath>
+#include "instrument.hpp"
+#include "poly.hpp"
+#include "rcp.hpp"
+
 namespace fast {
 namespace tan {
 
-static inline float stl(float x) noexcept { return std::tanf(x); }
+static inline float stl(float x) noexcept { FASTMATHS_PROBE(x); return std::tan(x); }
+
+// The kernels below that end in a divide keep their coefficients in a __
+// function taking the division, see rcp::exact & rcp::divider, which the
+// float versions & their _rcp variants share
 
 // https://github.com/juce-framework/JUCE/blob/master/modules/juce_dsp/maths/juce_FastMathApproximations.h
-static inline float pade (float x) noexcept {
-    auto x2 = x * x;
-    auto numerator = x * (-135135 + x2 * (17325 + x2 * (-378 + x2)));
-    auto denominator = -135135 + x2 * (62370 + x2 * (-3150 + 28 * x2));
-    return numerator / denominator;
+template <typename Div, typename T>
+constexpr T __pade (T x) noexcept {
+    T x2 = x * x;
+    T numerator = x * (-135135 + x2 * (17325 + x2 * (-378 + x2)));
+    T denominator = -135135 + x2 * (62370 + x2 * (-3150 + 28 * x2));
+    return Div::div(numerator, denominator);
+}
+
+constexpr float pade (float x) noexcept {
+    FASTMATHS_PROBE_DOMAIN(x, -1.57079633f, 1.57079633f);
+    return __pade<rcp::exact>(x);
+}
+
+// pade with the divide swapped for a reciprocal good to Bits bits, see rcp.hpp.
+// T can also be simd::f32
+template <typename T = float, int Bits = 22>
+constexpr T pade_rcp (T x) noexcept {
+    FASTMATHS_PROBE_DOMAIN(x, -1.57079633f, 1.57079633f);
+    return __pade<rcp::divider<Bits>>(x);
 }
 
 // https://www.musicdsp.org/en/latest/Other/115-sin-cos-tan-approximation.html
-static inline float wildmagic0 (float fAngle) noexcept {
-    float fASqr = fAngle * fAngle;
-    float fResult = 2.033e-01f;
-    fResult *= fASqr;
-    fResult += 3.1755e-01f;
-    fResult *= fASqr;
-    fResult += 1.0f;
-    fResult *= fAngle;
-    return fResult;
-}
-static inline float wildmagic1 (float fAngle) noexcept {
-    float fASqr = fAngle * fAngle;
-    float fResult = 9.5168091e-03f;
-    fResult *= fASqr;
-    fResult += 2.900525e-03f;
-    fResult *= fASqr;
-    fResult += 2.45650893e-02f;
-    fResult *= fASqr;
-    fResult += 5.33740603e-02f;
-    fResult *= fASqr;
-    fResult += 1.333923995e-01f;
-    fResult *= fASqr;
-    fResult += 3.333314036e-01f;
-    fResult *= fASqr;
-    fResult += 1.0f;
-    fResult *= fAngle;
-    return fResult;
+template <typename T = float, typename Scheme = poly::horner>
+constexpr T wildmagic0 (T fAngle) noexcept {
+    FASTMATHS_PROBE_DOMAIN(fAngle, -0.785398163f, 0.785398163f);
+    return fAngle * poly::eval<Scheme>(fAngle * fAngle, 1.0f, 3.1755e-01f, 2.033e-01f);
+}
+template <typename T = float, typename Scheme = poly::horner>
+constexpr T wildmagic1 (T fAngle) noexcept {
+    FASTMATHS_PROBE_DOMAIN(fAngle, -0.785398163f, 0.785398163f);
+    return fAngle * poly::eval<Scheme>(fAngle * fAngle,
+        1.0f, 3.333314036e-01f, 1.333923995e-01f, 5.33740603e-02f,
+        2.45650893e-02f, 2.900525e-03f, 9.5168091e-03f);
 }
 
 // https://observablehq.com/@jrus/fasttan
@@ -46,26 +54,59 @@ static inline float wildmagic1 (float fAngle) noexcept {
 // Regular tan functions will cycle after halfpi (1.57), this cycles
 // after 1.0
 // This is ideal for calculating tan(πfc/fs)
-static inline float jrus_alt(float x) noexcept {
+template <typename Div, typename T>
+constexpr T __jrus_alt(T x) noexcept {
     // 3 add, 3 mult, 1 div
-    float y = 1 - x * x;
-    return x * (-0.0187108f * y + 0.31583526f + 1.27365776f / y);
+    T y = 1.0f - x * x;
+    return x * (-0.0187108f * y + 0.31583526f + Div::div(T(1.27365776f), y));
 }
 
-static inline float jrus_alt_denorm(float x) noexcept {
-    x *= 0.6366197723675814f;
-    float y = 1 - x * x;
-    return x * (-0.0187108f * y + 0.31583526f + 1.27365776f / y);
+constexpr float jrus_alt(float x) noexcept {
+    FASTMATHS_PROBE_DOMAIN(x, -1.0f, 1.0f);
+    return __jrus_alt<rcp::exact>(x);
 }
 
+constexpr float jrus_alt_denorm(float x) noexcept {
+    FASTMATHS_PROBE_DOMAIN(x, -1.57079633f, 1.57079633f);
+    return __jrus_alt<rcp::exact>(x * 0.6366197723675814f);
+}
+
+// the jrus functions with 1 / y from a reciprocal good to Bits bits, see
+// rcp.hpp. T can also be simd::f32
+template <typename T = float, int Bits = 22>
+constexpr T jrus_alt_rcp(T x) noexcept {
+    FASTMATHS_PROBE_DOMAIN(x, -1.0f, 1.0f);
+    return __jrus_alt<rcp::divider<Bits>>(x);
+}
+
+template <typename T = float, int Bits = 22>
+constexpr T jrus_alt_denorm_rcp(T x) noexcept {
+    FASTMATHS_PROBE_DOMAIN(x, -1.57079633f, 1.57079633f);
+    return __jrus_alt<rcp::divider<Bits>>(x * 0.6366197723675814f);
+}
+
+// x already in [-1, 1]
+template <typename Div, typename T>
+constexpr T __jrus_denorm(T x) noexcept {
+    T y = 1.0f - x * x;
+    return x * (((-0.000221184f * y + 0.0024971104f) * y - 0.02301937096f) * y + 0.3182994604f + Div::div(T(1.2732402998f), y));
+}
 
-static inline float jrus_denorm(float x) noexcept {
+constexpr float jrus_denorm(float x) noexcept {
+    FASTMATHS_PROBE_DOMAIN(x, -1.57079633f, 1.57079633f);
     x *= 0.6366197723675814;
-    float y = (1 - x*x);
-    return x * (((-0.000221184f * y + 0.0024971104f) * y - 0.02301937096f) * y + 0.3182994604f + 1.2732402998f / y);
+    return __jrus_denorm<rcp::exact>(x);
 }
 
-static inline float jrus_full_denorm(float x) noexcept {
+template <typename T = float, int Bits = 22>
+constexpr T jrus_denorm_rcp(T x) noexcept {
+    FASTMATHS_PROBE_DOMAIN(x, -1.57079633f, 1.57079633f);
+    return __jrus_denorm<rcp::divider<Bits>>(x * 0.6366197723675814f);
+}
+
+// scalar only, the range reduction relies on float rounding
+template <typename Div>
+constexpr float __jrus_full_denorm(float x) noexcept {
     x *= 0.6366197723675814f;
 
     // 2**54 = 18014398509481984
@@ -73,28 +114,65 @@ static inline float jrus_full_denorm(float x) noexcept {
     x -= (x - S) + S;  // reduce range to -1...1
     float y = (1 - x * x);
     return x * (((-0.00023552f * y + 0.002530368f) * y - 0.023045536f) * y
-      + 0.3183073636f + 1.2732395912f / y);
+      + 0.3183073636f + Div::div(1.2732395912f, y));
+}
+
+constexpr float jrus_full_denorm(float x) noexcept {
+    FASTMATHS_PROBE(x);
+    return __jrus_full_denorm<rcp::exact>(x);
+}
+
+template <int Bits = 22>
+constexpr float jrus_full_denorm_rcp(float x) noexcept {
+    FASTMATHS_PROBE(x);
+    return __jrus_full_denorm<rcp::divider<Bits>>(x);
 }
 
 // license = Public domain
 // https://andrewkay.name/blog/post/efficiently-approximating-tan-x/
-static inline float kay (float x) noexcept {
+template <typename Div, typename T>
+constexpr T __kay (T x) noexcept {
     // 3 mult, 2 sub, 1 div
-    static const float pisqby4 = 2.4674011002723397f;
-    static const float oneminus8bypisq = 0.1894305308612978f;
-    float xsq = x*x;
-    return x * (pisqby4 - oneminus8bypisq * xsq) / (pisqby4 - xsq);
+    constexpr float pisqby4 = 2.4674011002723397f;
+    constexpr float oneminus8bypisq = 0.1894305308612978f;
+    T xsq = x*x;
+    return Div::div(x * (pisqby4 - oneminus8bypisq * xsq), pisqby4 - xsq);
+}
+
+constexpr float kay (float x) noexcept {
+    FASTMATHS_PROBE_DOMAIN(x, -1.57079633f, 1.57079633f);
+    return __kay<rcp::exact>(x);
 }
 
 // approximation of tan with lower relative error
 // https://andrewkay.name/blog/post/efficiently-approximating-tan-x/
-static inline float kay_precise (float x) noexcept {
+template <typename Div, typename T>
+constexpr T __kay_precise (T x) noexcept {
     // 3 mult, 2 sub, 1 div
-    static const float pisqby4 = 2.4674011002723397f;
-    static const float adjpisqby4 = 2.471688400562703f;
-    static const float adj1minus8bypisq = 0.189759681063053f;
-    float xsq = x * x;
-    return x * (adjpisqby4 - adj1minus8bypisq * xsq) / (pisqby4 - xsq);
+    constexpr float pisqby4 = 2.4674011002723397f;
+    constexpr float adjpisqby4 = 2.471688400562703f;
+    constexpr float adj1minus8bypisq = 0.189759681063053f;
+    T xsq = x * x;
+    return Div::div(x * (adjpisqby4 - adj1minus8bypisq * xsq), pisqby4 - xsq);
+}
+
+constexpr float kay_precise (float x) noexcept {
+    FASTMATHS_PROBE_DOMAIN(x, -1.57079633f, 1.57079633f);
+    return __kay_precise<rcp::exact>(x);
+}
+
+// kay & kay_precise with the divide swapped for a reciprocal good to Bits
+// bits, see rcp.hpp. T can also be simd::f32
+template <typename T = float, int Bits = 22>
+constexpr T kay_rcp (T x) noexcept {
+    FASTMATHS_PROBE_DOMAIN(x, -1.57079633f, 1.57079633f);
+    return __kay<rcp::divider<Bits>>(x);
+}
+
+template <typename T = float, int Bits = 22>
+constexpr T kay_precise_rcp (T x) noexcept {
+    FASTMATHS_PROBE_DOMAIN(x, -1.57079633f, 1.57079633f);
+    return __kay_precise<rcp::divider<Bits>>(x);
 }
 
 } // namespace tan
@@ -1,22 +1,32 @@
+#pragma once
 #include "exp.hpp"
+#include "instrument.hpp"
+#include "rcp.hpp"
 
 namespace fast {
 namespace tanh {
 
 template<typename T>
-constexpr T stl(T x) noexcept { return std::tanh(x); }
+constexpr T stl(T x) noexcept { FASTMATHS_PROBE(x); return std::tanh(x); }
 
 // https://github.com/juce-framework/JUCE/blob/master/modules/juce_dsp/maths/juce_FastMathApproximations.h
-template <typename T>
+template <typename T, typename Div = rcp::exact>
 constexpr T pade (T x) noexcept {
-    auto x2 = x * x;
-    auto numerator = x * (135135 + x2 * (17325 + x2 * (378 + x2)));
-    auto denominator = 135135 + x2 * (62370 + x2 * (3150 + 28 * x2));
-    return numerator / denominator;
+    FASTMATHS_PROBE_DOMAIN(x, -5.0f, 5.0f);
+    T x2 = x * x;
+    T numerator = x * (135135 + x2 * (17325 + x2 * (378 + x2)));
+    T denominator = 135135 + x2 * (62370 + x2 * (3150 + 28 * x2));
+    return Div::div(numerator, denominator);
 }
 
+// pade with the divide swapped for a reciprocal good to Bits bits, see rcp.hpp.
+// T can also be simd::f32
+template <typename T = float, int Bits = 22>
+constexpr T pade_rcp (T x) noexcept { return pade<T, rcp::divider<Bits>>(x); }
+
 // https://math.stackexchange.com/a/3485944
-static float c3(float v) noexcept {
+constexpr float c3(float v) noexcept {
+    FASTMATHS_PROBE(v);
     const float c1 = 0.03138777F;
     const float c2 = 0.276281267F;
     const float c_log2f = 1.442695022F;
@@ -27,7 +37,7 @@ static float c3(float v) noexcept {
     float v1 = c_log2f + c2 * xx;
     float v2 = x + xx * c1 * x;
     float v3 = (v2 + v1);
-    *((int*)&v3) += intPart << 24;
+    v3 = std::bit_cast<float>(std::bit_cast<int>(v3) + (intPart << 24));
     float v4 = v2 - v1;
     return (v3 + v4) / (v3 - v4);
 }
@@ -42,13 +52,13 @@ static float c3(float v) noexcept {
 //     return 1 - (2 * (1 / (1 + std::exp(x * 2))));
 // }
 
-static inline float exp_ekmett_ub (float p) noexcept { return -1 + 2 / (1 + exp::ekmett_ub(-2 * p)); }
-static inline float exp_ekmett_lb (float p) noexcept { return -1 + 2 / (1 + exp::ekmett_lb(-2 * p)); }
-static inline float exp_schraudolph (float p) noexcept { return -1 + 2 / (1 + exp::schraudolph(-2 * p)); }
+constexpr float exp_ekmett_ub (float p) noexcept { FASTMATHS_PROBE(p); return -1 + 2 / (1 + exp::ekmett_ub(-2 * p)); }
+constexpr float exp_ekmett_lb (float p) noexcept { FASTMATHS_PROBE(p); return -1 + 2 / (1 + exp::ekmett_lb(-2 * p)); }
+constexpr float exp_schraudolph (float p) noexcept { FASTMATHS_PROBE(p); return -1 + 2 / (1 + exp::schraudolph(-2 * p)); }
 
 // https://github.com/romeric/fastapprox/blob/master/fastapprox/src/fasthyperbolic.h
-static inline float exp_mineiro   (float p) noexcept { return -1 + 2 / (1 + exp::mineiro  (-2 * p)); }
-static inline float exp_mineiro_faster (float p) noexcept { return -1 + 2 / (1 + exp::mineiro_faster(-2 * p)); }
+constexpr float exp_mineiro   (float p) noexcept { FASTMATHS_PROBE(p); return -1 + 2 / (1 + exp::mineiro  (-2 * p)); }
+constexpr float exp_mineiro_faster (float p) noexcept { FASTMATHS_PROBE(p); return -1 + 2 / (1 + exp::mineiro_faster(-2 * p)); }
 
 
 
@@ -0,0 +1,173 @@
+#pragma once
+#include "activation.hpp"
+#include "exp.hpp"
+#include "exp2.hpp"
+#include "exp10.hpp"
+#include "log.hpp"
+#include "log2.hpp"
+#include "log10.hpp"
+#include "pow.hpp"
+#include "rcp.hpp"
+#include "sin.hpp"
+#include "sqrt.hpp"
+#include "tanh.hpp"
+
+// Accuracy tiers, for code that wants "a cheap exp2" rather than one
+// author's. Each family maps the tiers to one of its kernels at compile time
+//   fast::tiered::exp2<fast::tier::coarse>(x)
+//   fast::tiered::sin(x)                       FASTMATHS_TIER, medium if unset
+// so a product changes accuracy in one place rather than at every call:
+//   FASTMATHS_TIER        the tier of calls that don't name one
+//   FASTMATHS_FORCE_TIER  the tier of every call, whatever it names. For A/B
+//                         performance runs of a whole build, also settable as
+//                         cmake -DFASTMATHS_FORCE_TIER=coarse
+// Both name a tier without its namespace, eg. -DFASTMATHS_TIER=precise
+// Every kernel takes float or simd::f32, so
+// batch::transform(in, out, n, [](auto x) { return tiered::exp(x); });
+// works too. Both are within the bounds below, though not always bit for bit
+// the same: rcp & sqrt start from the hardware estimate, which only the
+// vectors have, & FMA contraction may round the tables differently.
+// Worst errors, relative for exp, rcp & sqrt, absolute for the rest:
+//                coarse   medium   precise
+//   exp          5.8e-2   2.1e-5   1.7e-7   within float's range
+//   exp2         5.8e-2   1.4e-5   1.7e-7
+//   exp10        5.8e-2   2.1e-5   1.7e-7
+//   log2         5.7e-2   9.6e-5   8.6e-7   positive normal x
+//   log          4.0e-2   6.6e-5   6.3e-7
+//   log10        1.7e-2   2.9e-5   7.1e-7
+//   sin          1.6e-4   1.7e-7   1.7e-7   [-pi, pi], no range reduction
+//   cos          1.6e-4   1.6e-7   1.6e-7
+//   tanh         1.5e-5   1.5e-5   1.8e-7   coarse & medium in [-4, 4], 9.6e-5
+//                                           past it. precise 3.6e-7 relative
+//   rcp          2.6e-3   6.6e-6   8.9e-8   rcp::approx at 8, 16 & 22 bits,
+//                                           normal |x| < 2^125
+//   sqrt, rsqrt  1.8e-3   4.7e-6   1.8e-7   sqrt::approx & rsqrt, the same
+// Past float's range the exps saturate near FLT_MIN & FLT_MAX, not 0 or inf,
+// & NaN stays NaN.
+// coarse is the bit tricks or short polynomials, medium & precise small &
+// large tables or polynomials. Where a family has nothing between, two tiers
+// share a kernel.
+
+namespace fast {
+namespace tier {
+
+struct coarse { static constexpr int level = 0; };
+struct medium { static constexpr int level = 1; };
+struct precise { static constexpr int level = 2; };
+
+#if !defined(FASTMATHS_TIER)
+#define FASTMATHS_TIER medium
+#endif
+
+// the tier of calls that don't name one
+using fallback = FASTMATHS_TIER;
+
+// the tier a call runs at
+#if defined(FASTMATHS_FORCE_TIER)
+template <typename Tier>
+inline constexpr int level = FASTMATHS_FORCE_TIER::level;
+#else
+template <typename Tier>
+inline constexpr int level = Tier::level;
+#endif
+
+} // namespace tier
+
+namespace tiered {
+
+// coarse is Schraudolph's bit trick, 2^y for y in [-125, 128], whose int
+// overflows past it. So y is clamped, to saturate like the tables do, & NaN,
+// which the clamp takes to -125, selected back in
+template <typename T>
+constexpr T __exp2_lb(T y) noexcept {
+    const T r = pow::const_base<2.0f>::fast_lb(simd::min(simd::max(y, T(-125.0f)), T(128.0f)));
+    return simd::select(y != y, y, r);
+}
+
+template <typename Tier = tier::fallback, typename T>
+constexpr T exp2(T x) noexcept {
+    if constexpr (tier::level<Tier> == 0) return __exp2_lb(x);
+    else if constexpr (tier::level<Tier> == 1) return fast::exp2::table<3, 2>(x);
+    else return fast::exp2::table<5, 3>(x);
+}
+
+template <typename Tier = tier::fallback, typename T>
+constexpr T exp(T x) noexcept {
+    if constexpr (tier::level<Tier> == 0) return __exp2_lb(x * T(1.44269504f));
+    else if constexpr (tier::level<Tier> == 1) return fast::exp::table<3, 2>(x);
+    else return fast::exp::table<5, 3>(x);
+}
+
+template <typename Tier = tier::fallback, typename T>
+constexpr T exp10(T x) noexcept {
+    if constexpr (tier::level<Tier> == 0) return __exp2_lb(x * T(3.32192809f));
+    else if constexpr (tier::level<Tier> == 1) return fast::exp10::table<3, 2>(x);
+    else return fast::exp10::table<5, 3>(x);
+}
+
+template <typename Tier = tier::fallback, typename T>
+constexpr T log2(T x) noexcept {
+    if constexpr (tier::level<Tier> == 0) return fast::log2::mineiro_faster(x);
+    else if constexpr (tier::level<Tier> == 1) return fast::log2::table<3, 2>(x);
+    else return fast::log2::table<4, 4>(x);
+}
+
+template <typename Tier = tier::fallback, typename T>
+constexpr T log(T x) noexcept {
+    if constexpr (tier::level<Tier> == 0) return fast::log2::mineiro_faster(x) * T(0.693147181f);
+    else if constexpr (tier::level<Tier> == 1) return fast::log::table<3, 2>(x);
+    else return fast::log::table<4, 4>(x);
+}
+
+template <typename Tier = tier::fallback, typename T>
+constexpr T log10(T x) noexcept {
+    if constexpr (tier::level<Tier> == 0) return fast::log2::mineiro_faster(x) * T(0.301029996f);
+    else if constexpr (tier::level<Tier> == 1) return fast::log10::table<3, 2>(x);
+    else return fast::log10::table<4, 4>(x);
+}
+
+// The wildmagic polynomials are only good in [-pi/2, pi/2]. sin(x) is
+// sin(pi - x) & cos(x) is sin(pi/2 - |x|), which folds [-pi, pi] into that.
+// Folded, the degree 11 one beats the pade approximants on speed & accuracy
+template <typename T>
+constexpr T __fold_sin(T x) noexcept {
+    const T pi(3.14159265f), halfpi(1.57079633f);
+    x = simd::select(x > halfpi, pi - x, x);
+    return simd::select(x < -halfpi, -pi - x, x);
+}
+
+template <typename Tier = tier::fallback, typename T>
+constexpr T sin(T x) noexcept {
+    if constexpr (tier::level<Tier> == 0) return fast::sin::wildmagic0(__fold_sin(x));
+    else return fast::sin::wildmagic1(__fold_sin(x));
+}
+
+template <typename Tier = tier::fallback, typename T>
+constexpr T cos(T x) noexcept {
+    if constexpr (tier::level<Tier> == 0) return fast::sin::wildmagic0(T(1.57079633f) - simd::abs(x));
+    else return fast::sin::wildmagic1(T(1.57079633f) - simd::abs(x));
+}
+
+// pade grows past 1 beyond about 4.97, so coarse & medium clamp there. For
+// precise, tanh(x) = 2 sigmoid(2x) - 1, which saturates properly but cancels
+// towards 0, where pade is good to 2e-7 relative, so it takes |x| < 0.5
+template <typename Tier = tier::fallback, typename T>
+constexpr T tanh(T x) noexcept {
+    if constexpr (tier::level<Tier> <= 1) return fast::tanh::pade(simd::min(simd::max(x, T(-4.97f)), T(4.97f)));
+    else return simd::select(simd::abs(x) < T(0.5f), fast::tanh::pade(x), T(2.0f) * sigmoid::table(x + x) - T(1.0f));
+}
+
+template <typename Tier>
+inline constexpr int __bits = tier::level<Tier> == 0 ? 8 : tier::level<Tier> == 1 ? 16 : 22;
+
+template <typename Tier = tier::fallback, typename T>
+constexpr T rcp(T x) noexcept { return fast::rcp::approx<__bits<Tier>>(x); }
+
+template <typename Tier = tier::fallback, typename T>
+constexpr T sqrt(T x) noexcept { return fast::sqrt::approx<__bits<Tier>>(x); }
+
+template <typename Tier = tier::fallback, typename T>
+constexpr T rsqrt(T x) noexcept { return fast::sqrt::rsqrt<__bits<Tier>>(x); }
+
+} // namespace tiered
+} // namespace fast
@@ -0,0 +1,156 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "buffer.hpp"
+#include "simd.hpp"
+#include "sin.hpp"
+#include "tier.hpp"
+
+// Band limited wavetable oscillators, for waveforms other than the sine.
+// A wavetable::mipmap holds a waveform as one table per octave, each with
+// half the harmonics of the one before, from 512 down to the fundamental. A
+// voice plays the table with the most harmonics that stay below Nyquist at
+// its frequency, so it never aliases, & loses at most the top octave of them.
+// The tables are summed from the waveform's harmonics once, through a single
+// period of tiered::sin, so no FFT.
+//   const wavetable::mipmap saw(wavetable::saw());
+//   wavetable::voice v(saw);
+//   v.set(220.0f / 48000.0f, 0.5f);
+//   v.process(out, n); // out[t] += the voice
+// Frequencies are in cycles per sample, ie. Hz / sample rate, from 0 to 0.5.
+// A block is rendered a simd::f32 of samples at a time, the 4 neighbours of
+// each gathered from the table & interpolated by sin::__hermiteInterpolate.
+
+namespace fast {
+namespace wavetable {
+
+// samples per table, harmonics in the fullest & tables
+inline constexpr std::size_t size = 2048;
+inline constexpr std::size_t top = size / 4;
+inline constexpr int levels = 10;
+static_assert(top >> (levels - 1) == 1, "the last table is the fundamental alone");
+
+// The sine series of the classic shapes, a harmonic per float from the
+// fundamental, peaking at about 1
+inline std::vector<float> saw(std::size_t n = top) {
+    std::vector<float> h(n);
+    for (std::size_t k = 1; k <= n; k++)
+        h[k - 1] = (k % 2 ? 0.636619772f : -0.636619772f) / float(k);
+    return h;
+}
+
+inline std::vector<float> square(std::size_t n = top) {
+    std::vector<float> h(n);
+    for (std::size_t k = 1; k <= n; k += 2)
+        h[k - 1] = 1.27323954f / float(k);
+    return h;
+}
+
+inline std::vector<float> triangle(std::size_t n = top) {
+    std::vector<float> h(n);
+    for (std::size_t k = 1; k <= n; k += 2)
+        h[k - 1] = (k % 4 == 1 ? 0.810569469f : -0.810569469f) / float(k * k);
+    return h;
+}
+
+class mipmap {
+public:
+    // harmonics[k - 1] is the amplitude of sin(k x). Those past top are left out
+    explicit mipmap(const std::vector<float>& harmonics) : tables_(levels * stride) {
+        std::vector<float> sine(size);
+        for (std::size_t j = 0; j < size; j++) {
+            const float x = 6.28318531f * (float(j) / float(size));
+            sine[j] = tiered::sin<tier::precise>(j < size / 2 ? x : x - 6.28318531f);
+        }
+        // from the fundamental alone up, each table adding the next octave
+        std::vector<float> sum(size, 0.0f);
+        std::size_t k = 1;
+        for (int l = levels - 1; l >= 0; l--) {
+            for (; k <= std::min(harmonics_in(l), harmonics.size()); k++)
+                for (std::size_t j = 0; j < size; j++)
+                    sum[j] += harmonics[k - 1] * sine[(k * j) % size];
+            float* t = tables_.data() + l * stride + 1;
+            std::copy(sum.begin(), sum.end(), t);
+            t[-1] = sum[size - 1];
+            t[size] = sum[0];
+            t[size + 1] = sum[1];
+            t[size + 2] = sum[2];
+        }
+    }
+
+    static constexpr std::size_t harmonics_in(int level) noexcept { return top >> level; }
+
+    // the fullest table whose harmonics all stay below 0.5 at frequency
+    static constexpr int level(float frequency) noexcept {
+        int l = 0;
+        while (l + 1 < levels && float(harmonics_in(l)) * frequency > 0.5f)
+            l++;
+        return l;
+    }
+
+    // sample 0 of a level's table, which may be read from -1 to size + 2
+    const float* table(int level) const noexcept { return tables_.data() + level * stride + 1; }
+
+private:
+    static constexpr std::size_t stride = size + 4;
+    buffer::aligned tables_;
+};
+
+class voice {
+public:
+    explicit voice(const mipmap& waveform) noexcept : waveform_(&waveform) {}
+
+    void set(float frequency, float amplitude = 1.0f) noexcept {
+        increment_ = frequency;
+        amplitude_ = amplitude;
+        level_ = mipmap::level(frequency);
+    }
+
+    void reset(float phase = 0.0f) noexcept { phase_ = phase - simd::floor(phase); }
+
+    // out[t] += the voice at sample t
+    void process(float* out, std::size_t n) noexcept {
+        constexpr std::size_t W = simd::f32::size;
+        const float* t = waveform_->table(level_);
+        auto at = [t](auto phase) {
+            using T = decltype(phase);
+            using I = simd::int_t<T>;
+            const T x = phase * T(float(size));
+            const I i = simd::to_i32(x); // phase isn't negative, so this is its floor
+            return sin::__hermiteInterpolate(simd::gather(t - 1, i), simd::gather(t, i), simd::gather(t + 1, i),
+                                             simd::gather(t + 2, i), x - simd::to_f32(i));
+        };
+
+        std::size_t i = 0;
+        if (n >= W) {
+            float ramp[W];
+            for (std::size_t k = 0; k < W; k++)
+                ramp[k] = float(k);
+            const simd::f32 a(amplitude_), step(increment_ * float(W));
+            simd::f32 p = simd::f32(phase_) + simd::f32(increment_) * simd::f32::load(ramp);
+            p = p - simd::floor(p);
+            for (; i + W <= n; i += W) {
+                simd::fma(a, at(p), simd::f32::load(out + i)).store(out + i);
+                p = p + step;
+                p = p - simd::floor(p);
+            }
+            p.store(ramp);
+            phase_ = ramp[0];
+        }
+        for (; i < n; i++) {
+            out[i] += amplitude_ * at(phase_);
+            phase_ += increment_;
+            phase_ -= simd::floor(phase_);
+        }
+    }
+
+private:
+    const mipmap* waveform_;
+    float phase_ = 0.0f, increment_ = 0.0f, amplitude_ = 0.0f;
+    int level_ = 0;
+};
+
+} // namespace wavetable
+} // namespace fast